@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+// Time normalize_approx against the exact normalize, one point at a time,
+// on a point3d array and on a point_cloud.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "minimath/fast_normalize.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "BenchUtils.h"
+
+using namespace minimath;
+
+namespace
+{
+
+typedef std::vector<point3d<float> > Points;
+typedef point_cloud<float> Cloud;
+
+const unsigned int nPoints = 100000;
+const unsigned int nCalls = 200;
+
+// normalize each point into a separate array
+struct single_exact
+{
+  explicit single_exact(const Points& p) : p(p), out(p.size()) {}
+  double operator()()
+  {
+    for (std::size_t i = 0; i < p.size(); ++i) out[i] = normalize(p[i]);
+    return out[0][0];
+  }
+  const Points& p;
+  Points out;
+};
+
+struct single_approx
+{
+  explicit single_approx(const Points& p) : p(p), out(p.size()) {}
+  double operator()()
+  {
+    for (std::size_t i = 0; i < p.size(); ++i) out[i] = normalize_approx(p[i]);
+    return out[0][0];
+  }
+  const Points& p;
+  Points out;
+};
+
+// normalize in place; after the first call the points have unit length,
+// which does not change the cost
+struct array_exact
+{
+  explicit array_exact(const Points& p) : p(p) {}
+  double operator()()
+  {
+    for (std::size_t i = 0; i < p.size(); ++i) p[i] = normalize(p[i]);
+    return p[0][0];
+  }
+  Points p;
+};
+
+struct array_approx
+{
+  explicit array_approx(const Points& p) : p(p) {}
+  double operator()() { normalize_approx(&p[0], p.size()); return p[0][0]; }
+  Points p;
+};
+
+struct cloud_exact
+{
+  explicit cloud_exact(const Points& p) : c(p.begin(), p.end()) {}
+  double operator()() { normalize(c); return c.x_data()[0]; }
+  Cloud c;
+};
+
+struct cloud_approx
+{
+  explicit cloud_approx(const Points& p) : c(p.begin(), p.end()) {}
+  double operator()() { normalize_approx(c); return c.x_data()[0]; }
+  Cloud c;
+};
+
+// largest coordinate error of approx against the exact normalization of p
+double error(const Points& p, const Points& approx)
+{
+  double err = 0.;
+  for (std::size_t i = 0; i < p.size(); ++i)
+  {
+    const double len = std::sqrt(double(p[i].x())*p[i].x() + double(p[i].y())*p[i].y() +
+                                 double(p[i].z())*p[i].z());
+    for (unsigned int k = 0; k < 3; ++k) err = std::max(err, std::fabs(approx[i][k] - p[i][k]/len));
+  }
+  return err;
+}
+
+template <typename F>
+double time(const Points& p, double& sink)
+{
+  F f(p);
+  return BenchUtils::time_ns(f, nCalls, sink);
+}
+
+} // anonymous namespace
+
+int main()
+{
+  std::srand(42);
+  Points points;
+  for (unsigned int i = 0; i < nPoints; ++i)
+  {
+    points.push_back(point3d<float>(static_cast<float>(std::rand()%2000 - 1000)/64,
+                                    static_cast<float>(std::rand()%2000 - 1000)/64,
+                                    static_cast<float>(std::rand()%2000 - 1000)/64));
+  }
+
+  // errors of one call on the original points
+  single_exact singleExact(points);
+  single_approx singleApprox(points);
+  array_exact arrayExact(points);
+  array_approx arrayApprox(points);
+  cloud_approx cloudApprox(points);
+  double sink = singleExact() + singleApprox() + arrayExact() + arrayApprox() + cloudApprox();
+  Points cloudOut(nPoints);
+  std::copy(cloudApprox.c.begin(), cloudApprox.c.end(), cloudOut.begin());
+
+  std::printf("%u float points, time per call and speed-up over the exact normalize:\n", nPoints);
+  std::printf("one point at a time\n");
+  const double singleNs = time<single_exact>(points, sink);
+  BenchUtils::report("normalize", singleNs, singleNs, error(points, singleExact.out));
+  BenchUtils::report("normalize_approx", time<single_approx>(points, sink), singleNs,
+                     error(points, singleApprox.out));
+
+  std::printf("point3d array, in place\n");
+  const double arrayNs = time<array_exact>(points, sink);
+  BenchUtils::report("normalize", arrayNs, arrayNs, error(points, arrayExact.p));
+  BenchUtils::report("normalize_approx", time<array_approx>(points, sink), arrayNs,
+                     error(points, arrayApprox.p));
+
+  std::printf("point_cloud, in place\n");
+  const double cloudNs = time<cloud_exact>(points, sink);
+  BenchUtils::report("normalize", cloudNs, cloudNs);
+  BenchUtils::report("normalize_approx", time<cloud_approx>(points, sink), cloudNs,
+                     error(points, cloudOut));
+
+  std::printf("(checksum %g)\n", sink);
+  return 0;
+}
@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+// Time the mixed precision solvers of matrix_solve.hpp against the double
+// precision ones, for the small systems the library is used with.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "minimath/matrix_solve.hpp"
+#include "BenchUtils.h"
+
+using namespace minimath;
+
+namespace
+{
+
+const unsigned int nSystems = 64;
+const unsigned int nCalls = 200000;
+
+enum method { lu_double, lu_float, lu_mixed, cholesky_double, cholesky_mixed };
+
+template <typename M>
+void fillRandom(M& m)
+{
+  for (unsigned int i = 0; i < m.size(); ++i) m[i] = std::rand()%10 - 5 + 1e-3/(i + 1);
+}
+
+// a set of well conditioned general and symmetric positive definite systems
+template <unsigned int N>
+struct systems
+{
+  systems()
+  {
+    for (unsigned int i = 0; i < nSystems; ++i)
+    {
+      fillRandom(A[i]);
+      A[i] += matrix<double,N>(identity_matrix())*20.;
+      matrix<double,N> M;
+      fillRandom(M);
+      S[i] = M.transpose()*M + matrix<double,N>(identity_matrix())*0.1;
+      fillRandom(b[i]);
+    }
+  }
+  matrix<double,N> A[nSystems];
+  matrix<double,N> S[nSystems];
+  matrix<double,N,1> b[nSystems];
+};
+
+template <unsigned int N, method Method>
+struct solver
+{
+  explicit solver(const systems<N>& s) : m_s(s), m_i(0) {}
+
+  double operator()()
+  {
+    const matrix<double,N,1> x = solve_one(m_i);
+    m_i = (m_i + 1)%nSystems;
+    return x[0];
+  }
+
+  matrix<double,N,1> solve_one(unsigned int i) const
+  {
+    bool success = false;
+    switch (Method)
+    {
+      case lu_double: return solve(m_s.A[i], m_s.b[i], success);
+      case lu_float: return solve_mixed<float>(m_s.A[i], m_s.b[i], success, 0);
+      case lu_mixed: return solve_mixed<float>(m_s.A[i], m_s.b[i], success);
+      case cholesky_double: return solve_spd(m_s.S[i], m_s.b[i], success);
+      case cholesky_mixed: return solve_spd_mixed<float>(m_s.S[i], m_s.b[i], success);
+    }
+    return matrix<double,N,1>();
+  }
+
+  const systems<N>& m_s;
+  unsigned int m_i;
+};
+
+// largest difference to the double precision solution, relative to its size
+template <unsigned int N, method Method, method Reference>
+double error(const systems<N>& s)
+{
+  const solver<N,Method> test(s);
+  const solver<N,Reference> reference(s);
+  double err = 0.;
+  for (unsigned int i = 0; i < nSystems; ++i)
+  {
+    const matrix<double,N,1> x = test.solve_one(i);
+    const matrix<double,N,1> xRef = reference.solve_one(i);
+    double diff = 0., size = 0.;
+    for (unsigned int k = 0; k < N; ++k)
+    {
+      diff = std::max(diff, std::fabs(x[k] - xRef[k]));
+      size = std::max(size, std::fabs(xRef[k]));
+    }
+    err = std::max(err, diff/size);
+  }
+  return err;
+}
+
+template <unsigned int N, method Method, method Reference>
+void run(const char* name, const systems<N>& s, double baseline, double& sink)
+{
+  solver<N,Method> f(s);
+  const double ns = BenchUtils::time_ns(f, nCalls, sink);
+  BenchUtils::report(name, ns, baseline, error<N,Method,Reference>(s));
+}
+
+template <unsigned int N>
+void runAll(double& sink)
+{
+  const systems<N> s;
+  std::printf("%ux%u systems, time per solve and speed-up over double:\n", N, N);
+  solver<N,lu_double> lu(s);
+  const double luNs = BenchUtils::time_ns(lu, nCalls, sink);
+  BenchUtils::report("LU double", luNs, luNs, 0.);
+  run<N,lu_float,lu_double>("LU float, no refinement", s, luNs, sink);
+  run<N,lu_mixed,lu_double>("LU float, 2 refinements", s, luNs, sink);
+  solver<N,cholesky_double> chol(s);
+  const double cholNs = BenchUtils::time_ns(chol, nCalls, sink);
+  BenchUtils::report("Cholesky double", cholNs, cholNs, 0.);
+  run<N,cholesky_mixed,cholesky_double>("Cholesky float, 2 refinements", s, cholNs, sink);
+}
+
+} // anonymous namespace
+
+int main()
+{
+  std::srand(42);
+  double sink = 0.;
+  runAll<3>(sink);
+  runAll<4>(sink);
+  runAll<6>(sink);
+  std::printf("(checksum %g)\n", sink);
+  return 0;
+}
@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+// Time the same point kernels on the three point layouts: an array of
+// point3d (AoS), a point_cloud (SoA) and a tiled_point_cloud (AoSoA).
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_batch_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "minimath/point_statistics.hpp"
+#include "minimath/point_view.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/tiled_point_cloud.hpp"
+#include "minimath/transform3d.hpp"
+#include "BenchUtils.h"
+
+using namespace minimath;
+
+namespace
+{
+
+typedef std::vector<point3d<float> > Points;
+typedef point_cloud<float> Cloud;
+typedef tiled_point_cloud<float, 8> Tiles;
+
+const unsigned int nPoints = 100000;
+const unsigned int nCalls = 200;
+
+// in place transformation by a small rotation, which keeps the points bounded
+struct transformer
+{
+  transformer()
+  :
+  m(to_matrix(transform3d<float>(rotation3d<float>(rotation3dz<float>(1.e-3f)),
+                                 translation3d<float>())))
+  {}
+  matrix<float,3,4> m;
+};
+
+struct transform_aos : transformer
+{
+  explicit transform_aos(Points& p) : p(p) {}
+  double operator()() { transform(m, point_span<float>(&p[0][0], p.size())); return p[0][0]; }
+  Points& p;
+};
+
+struct transform_soa : transformer
+{
+  explicit transform_soa(Cloud& c) : c(c) {}
+  double operator()()
+  {
+    transform(m, planar_points(c.x_data(), c.y_data(), c.z_data(), c.size()));
+    return c.x_data()[0];
+  }
+  Cloud& c;
+};
+
+struct transform_aosoa : transformer
+{
+  explicit transform_aosoa(Tiles& t) : t(t) {}
+  double operator()() { transform(m, t); return t.tiles()[0].x[0]; }
+  Tiles& t;
+};
+
+// squared distances of all points to a query point
+template <typename P>
+struct distances
+{
+  explicit distances(const P& p) : p(p), q(0.5f, -1.f, 2.f), out(nPoints) {}
+  double operator()() { dist2(p, q, &out[0]); return out[nPoints/2]; }
+  const P& p;
+  const point3d<float> q;
+  std::vector<float> out;
+};
+
+template <>
+double distances<Points>::operator()()
+{
+  dist2(&p[0], p.size(), q, &out[0]);
+  return out[nPoints/2];
+}
+
+// centroid of all points
+template <typename P>
+struct centroids
+{
+  explicit centroids(const P& p) : p(p) {}
+  double operator()() { return centroid(p.begin(), p.end()).x(); }
+  const P& p;
+};
+
+template <>
+double centroids<Tiles>::operator()()
+{
+  return centroid(p).x();
+}
+
+template <typename F, typename P>
+double time(P& p, double& sink)
+{
+  F f(p);
+  return BenchUtils::time_ns(f, nCalls, sink);
+}
+
+} // anonymous namespace
+
+int main()
+{
+  std::srand(42);
+  Points points;
+  for (unsigned int i = 0; i < nPoints; ++i)
+  {
+    points.push_back(point3d<float>(static_cast<float>(std::rand()%2000 - 1000)/64,
+                                    static_cast<float>(std::rand()%2000 - 1000)/64,
+                                    static_cast<float>(std::rand()%2000 - 1000)/64));
+  }
+  Cloud cloud(points.begin(), points.end());
+  Tiles tiles(points.begin(), points.end());
+
+  double sink = 0.;
+  std::printf("%u float points, time per call and speed-up over AoS:\n", nPoints);
+  std::printf("transform in place\n");
+  const double transformAoS = time<transform_aos>(points, sink);
+  BenchUtils::report("AoS point3d array", transformAoS, transformAoS);
+  BenchUtils::report("SoA point_cloud", time<transform_soa>(cloud, sink), transformAoS);
+  BenchUtils::report("AoSoA tiled_point_cloud<8>", time<transform_aosoa>(tiles, sink), transformAoS);
+
+  std::printf("dist2 to a point\n");
+  const double distAoS = time<distances<Points> >(points, sink);
+  BenchUtils::report("AoS point3d array", distAoS, distAoS);
+  BenchUtils::report("SoA point_cloud", time<distances<Cloud> >(cloud, sink), distAoS);
+  BenchUtils::report("AoSoA tiled_point_cloud<8>", time<distances<Tiles> >(tiles, sink), distAoS);
+
+  std::printf("centroid\n");
+  const double centroidAoS = time<centroids<Points> >(points, sink);
+  BenchUtils::report("AoS point3d array", centroidAoS, centroidAoS);
+  BenchUtils::report("SoA point_cloud", time<centroids<Cloud> >(cloud, sink), centroidAoS);
+  BenchUtils::report("AoSoA tiled_point_cloud<8>", time<centroids<Tiles> >(tiles, sink), centroidAoS);
+
+  std::printf("(checksum %g)\n", sink);
+  return 0;
+}
@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#ifndef BENCH_BENCHUTILS_H_
+#define BENCH_BENCHUTILS_H_
+
+#include <cstdio>
+#include <ctime>
+
+namespace BenchUtils
+{
+
+// CPU time of one call of f() in nanoseconds, best of nRuns runs of nCalls calls.
+// f() returns a value that is accumulated into sink, so that the work is kept.
+template <typename F>
+double time_ns(F& f, unsigned int nCalls, double& sink, unsigned int nRuns = 5)
+{
+  double best = 0.;
+  for (unsigned int r = 0; r < nRuns; ++r)
+  {
+    const std::clock_t start = std::clock();
+    for (unsigned int i = 0; i < nCalls; ++i) sink += f();
+    const double ns = 1.e9*double(std::clock() - start)/CLOCKS_PER_SEC/nCalls;
+    if (r == 0 || ns < best) best = ns;
+  }
+  return best;
+}
+
+// print one row of a timing table, with the speed-up over baseline_ns and,
+// if it is not negative, the error of the result
+inline void report(const char* name, double ns, double baseline_ns, double error = -1.)
+{
+  std::printf("  %-28s %10.1f ns %7.2fx", name, ns, baseline_ns/ns);
+  if (error >= 0.) std::printf("   error %8.1e", error);
+  std::printf("\n");
+}
+
+} // namespace BenchUtils
+
+#endif
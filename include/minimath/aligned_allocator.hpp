@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_ALIGNED_ALLOCATOR_H_
+#define MINIMATH_ALIGNED_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+//
+// Standard allocator returning storage aligned to Align bytes, for use
+// with standard containers holding data for SIMD kernels.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// Allocate n bytes aligned to align, a power of two. The offset to the
+// block returned by malloc is stored just before the aligned address.
+inline void* aligned_malloc(std::size_t n, std::size_t align)
+{
+  const std::size_t extra = align - 1 + sizeof(void*);
+  void* raw = std::malloc(n + extra);
+  if (raw == 0) return 0;
+  const std::size_t address = reinterpret_cast<std::size_t>(raw) + extra;
+  void** aligned = reinterpret_cast<void**>(address & ~(align - 1));
+  aligned[-1] = raw;
+  return aligned;
+}
+
+inline void aligned_free(void* p)
+{
+  if (p) std::free(static_cast<void**>(p)[-1]);
+}
+
+} // namespace detail
+
+/// Default alignment: one cache line, enough for any SIMD register.
+const std::size_t default_alignment = 64;
+
+template <typename T, std::size_t Align = default_alignment>
+class aligned_allocator {
+
+ public:
+
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind { typedef aligned_allocator<U, Align> other; };
+
+  aligned_allocator() {}
+  template <typename U>
+  aligned_allocator(const aligned_allocator<U, Align>&) {}
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, const void* = 0)
+  {
+    if (n > max_size()) throw std::bad_alloc();
+    void* p = detail::aligned_malloc(n*sizeof(T), Align);
+    if (p == 0) throw std::bad_alloc();
+    return static_cast<pointer>(p);
+  }
+
+  void deallocate(pointer p, size_type) { detail::aligned_free(p); }
+
+  size_type max_size() const { return (size_type(-1) - Align)/sizeof(T); }
+
+  void construct(pointer p, const T& value) { new (static_cast<void*>(p)) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  bool operator==(const aligned_allocator&) const { return true; }
+  bool operator!=(const aligned_allocator&) const { return false; }
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_ALIGNED_ALLOCATOR_H_
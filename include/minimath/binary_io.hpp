@@ -0,0 +1,341 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_BINARY_IO_H_
+#define MINIMATH_BINARY_IO_H_
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <tr1/cstdint>
+#include "minimath/matrix.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/translation3d.hpp"
+#include "minimath/transform3d.hpp"
+
+//
+// Binary format for contiguous arrays of matrix, rotation3d, translation3d
+// and transform3d.
+//
+// A file is a 32 byte binary_header followed by the records, stored exactly
+// as they are laid out in memory: row-major scalars, no padding. A reader
+// can map a file (see mapped_file.hpp) and use the records in place through
+// a binary_view, without parsing or copying.
+//
+// The header records the byte order of the writer. Files written on a
+// machine of the other byte order must be converted with swap_byte_order
+// before they can be viewed.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+/// Version of the binary format written by this library.
+const std::tr1::uint16_t binary_format_version = 1;
+
+/// Kind of record stored in a binary file.
+enum binary_record_kind
+{
+  binary_matrix = 1,
+  binary_rotation3d = 2,
+  binary_translation3d = 3,
+  binary_transform3d = 4
+};
+
+/// Scalar type of the records stored in a binary file.
+enum binary_scalar_kind
+{
+  binary_float32 = 1,
+  binary_float64 = 2
+};
+
+/// Reason why a buffer cannot be viewed as an array of records.
+enum binary_status
+{
+  binary_ok = 0,
+  binary_truncated,     // buffer smaller than header plus records
+  binary_bad_magic,     // not a minimath binary file
+  binary_bad_version,   // written by a newer version of the format
+  binary_byte_order,    // written on a machine of the other byte order
+  binary_type_mismatch, // records of a different type
+  binary_misaligned     // records not aligned for in place use
+};
+
+///
+/// File header. Every field has a fixed size and offset, and the header size
+/// is a multiple of 8 so that the records that follow are suitably aligned.
+///
+struct binary_header
+{
+  char magic[4];                 // "MMLB"
+  std::tr1::uint32_t byte_order; // 0x01020304 in the byte order of the writer
+  std::tr1::uint16_t version;
+  std::tr1::uint8_t record_kind;
+  std::tr1::uint8_t scalar_kind;
+  std::tr1::uint16_t rows;
+  std::tr1::uint16_t cols;
+  std::tr1::uint32_t record_size; // bytes per record
+  std::tr1::uint32_t reserved;
+  std::tr1::uint64_t count;       // number of records
+};
+
+namespace detail
+{
+
+const std::tr1::uint32_t binary_byte_order_mark = 0x01020304u;
+
+// fails to compile if the condition is false
+template <bool B> struct binary_static_check;
+template <> struct binary_static_check<true> {};
+
+template <typename T> struct binary_scalar_traits;
+
+template <> struct binary_scalar_traits<float>
+{
+  static const binary_scalar_kind kind = binary_float32;
+};
+
+template <> struct binary_scalar_traits<double>
+{
+  static const binary_scalar_kind kind = binary_float64;
+};
+
+// common part of the record traits: checks that a record is exactly
+// R*C scalars with no padding
+template <typename Record, typename T, binary_record_kind K,
+          unsigned int R, unsigned int C>
+struct binary_record_traits_base : binary_static_check<sizeof(Record) == R*C*sizeof(T)>
+{
+  typedef T scalar_type;
+  static const binary_record_kind kind = K;
+  static const binary_scalar_kind scalar_kind = binary_scalar_traits<T>::kind;
+  static const unsigned int rows = R;
+  static const unsigned int cols = C;
+};
+
+inline void swap_bytes(char* p, std::size_t n)
+{
+  std::reverse(p, p + n);
+}
+
+template <typename U>
+void swap_field(U& field)
+{
+  swap_bytes(reinterpret_cast<char*>(&field), sizeof(U));
+}
+
+} // namespace detail
+
+/// Binary layout of the record types. Specialised for the supported types.
+template <typename Record>
+struct binary_record_traits;
+
+template <typename T, unsigned int R, unsigned int C>
+struct binary_record_traits<matrix<T,R,C> >
+: detail::binary_record_traits_base<matrix<T,R,C>, T, binary_matrix, R, C> {};
+
+template <typename T>
+struct binary_record_traits<rotation3d<T> >
+: detail::binary_record_traits_base<rotation3d<T>, T, binary_rotation3d, 3, 3> {};
+
+template <typename T>
+struct binary_record_traits<translation3d<T> >
+: detail::binary_record_traits_base<translation3d<T>, T, binary_translation3d, 3, 1> {};
+
+template <typename T>
+struct binary_record_traits<transform3d<T> >
+: detail::binary_record_traits_base<transform3d<T>, T, binary_transform3d, 3, 4> {};
+
+/// Header describing n records of type Record, in native byte order.
+template <typename Record>
+binary_header make_binary_header(std::size_t n)
+{
+  typedef binary_record_traits<Record> traits;
+  binary_header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, "MMLB", 4);
+  header.byte_order = detail::binary_byte_order_mark;
+  header.version = binary_format_version;
+  header.record_kind = static_cast<std::tr1::uint8_t>(traits::kind);
+  header.scalar_kind = static_cast<std::tr1::uint8_t>(traits::scalar_kind);
+  header.rows = static_cast<std::tr1::uint16_t>(traits::rows);
+  header.cols = static_cast<std::tr1::uint16_t>(traits::cols);
+  header.record_size = static_cast<std::tr1::uint32_t>(sizeof(Record));
+  header.count = n;
+  return header;
+}
+
+/// Number of bytes needed to store n records of type Record.
+template <typename Record>
+std::size_t binary_size(std::size_t n)
+{
+  return sizeof(binary_header) + n*sizeof(Record);
+}
+
+///
+/// Write header and n records to a buffer of at least binary_size<Record>(n)
+/// bytes. Return a pointer one past the last byte written.
+///
+template <typename Record>
+char* write_binary(const Record* records, std::size_t n, char* buffer)
+{
+  const binary_header header = make_binary_header<Record>(n);
+  std::memcpy(buffer, &header, sizeof(header));
+  buffer += sizeof(header);
+  if (n != 0) std::memcpy(buffer, records, n*sizeof(Record));
+  return buffer + n*sizeof(Record);
+}
+
+///
+/// Write header and n records to a binary stream.
+/// Return false if the stream fails.
+///
+template <typename Record>
+bool write_binary(std::ostream& out, const Record* records, std::size_t n)
+{
+  const binary_header header = make_binary_header<Record>(n);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (n != 0)
+  {
+    out.write(reinterpret_cast<const char*>(records),
+              static_cast<std::streamsize>(n*sizeof(Record)));
+  }
+  return bool(out);
+}
+
+///
+/// Check that size bytes at data hold an array of Record that can be used
+/// in place.
+///
+template <typename Record>
+binary_status check_binary(const void* data, std::size_t size)
+{
+  typedef binary_record_traits<Record> traits;
+  if (size < sizeof(binary_header)) return binary_truncated;
+  binary_header header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, "MMLB", 4) != 0) return binary_bad_magic;
+  if (header.byte_order != detail::binary_byte_order_mark)
+  {
+    return binary_byte_order;
+  }
+  if (header.version > binary_format_version) return binary_bad_version;
+  if (header.record_kind != traits::kind ||
+      header.scalar_kind != traits::scalar_kind ||
+      header.rows != traits::rows ||
+      header.cols != traits::cols ||
+      header.record_size != sizeof(Record))
+  {
+    return binary_type_mismatch;
+  }
+  if (header.count > (size - sizeof(binary_header))/sizeof(Record))
+  {
+    return binary_truncated;
+  }
+  const std::size_t address = reinterpret_cast<std::size_t>(data);
+  if (address % sizeof(typename traits::scalar_type) != 0)
+  {
+    return binary_misaligned;
+  }
+  return binary_ok;
+}
+
+///
+/// Convert a binary file written on a machine of the other byte order to
+/// native byte order, in place. Files already in native order are left
+/// untouched. Return false if data does not hold a valid header or the
+/// records do not fit in size bytes.
+///
+inline bool swap_byte_order(void* data, std::size_t size)
+{
+  if (size < sizeof(binary_header)) return false;
+  char* bytes = static_cast<char*>(data);
+  binary_header header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, "MMLB", 4) != 0) return false;
+  if (header.byte_order == detail::binary_byte_order_mark) return true;
+  detail::swap_field(header.byte_order);
+  if (header.byte_order != detail::binary_byte_order_mark) return false;
+  detail::swap_field(header.version);
+  detail::swap_field(header.rows);
+  detail::swap_field(header.cols);
+  detail::swap_field(header.record_size);
+  detail::swap_field(header.reserved);
+  detail::swap_field(header.count);
+
+  std::size_t scalarSize = 0;
+  if (header.scalar_kind == binary_float32) scalarSize = 4;
+  if (header.scalar_kind == binary_float64) scalarSize = 8;
+  if (scalarSize == 0 || header.record_size % scalarSize != 0) return false;
+  if (header.record_size != 0 &&
+      header.count > (size - sizeof(binary_header))/header.record_size)
+  {
+    return false;
+  }
+  const std::size_t nScalars = static_cast<std::size_t>(header.count)*header.record_size/scalarSize;
+  char* p = bytes + sizeof(binary_header);
+  for (std::size_t i = 0; i < nScalars; ++i, p += scalarSize)
+  {
+    detail::swap_bytes(p, scalarSize);
+  }
+  std::memcpy(bytes, &header, sizeof(header));
+  return true;
+}
+
+///
+/// Read-only, zero-copy view of an array of records held in a buffer, for
+/// example a memory mapped file. The buffer must outlive the view.
+///
+template <typename Record>
+class binary_view {
+
+ public:
+
+  typedef Record value_type;
+  typedef const Record* const_iterator;
+
+  binary_view() : m_records(0), m_size(0), m_status(binary_truncated) {}
+
+  ///
+  /// View size bytes at data. success is set to false, and the view is
+  /// left empty, if check_binary fails.
+  ///
+  binary_view(const void* data, std::size_t size, bool& success)
+  :
+  m_records(0), m_size(0), m_status(check_binary<Record>(data, size))
+  {
+    success = (m_status == binary_ok);
+    if (!success) return;
+    binary_header header;
+    std::memcpy(&header, data, sizeof(header));
+    m_records = reinterpret_cast<const Record*>(static_cast<const char*>(data) + sizeof(binary_header));
+    m_size = static_cast<std::size_t>(header.count);
+  }
+
+  std::size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  const Record& operator[](std::size_t i) const { return m_records[i]; }
+
+  const_iterator begin() const { return m_records; }
+  const_iterator end() const { return m_records + m_size; }
+
+  /// Outcome of the check performed on construction.
+  binary_status status() const { return m_status; }
+
+ private:
+  const Record* m_records;
+  std::size_t m_size;
+  binary_status m_status;
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_BINARY_IO_H_
@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_BLOCKSPARSEMATRIX_H_
+#define MINIMATH_BLOCKSPARSEMATRIX_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include "minimath/matrix.hpp"
+
+//
+// Block compressed sparse row (BSR) matrix, with dense BxB blocks of type
+// minimath::matrix<T,B,B>. Intended for large, sparse normal equations
+// made up of 3x3 or 6x6 blocks.
+//
+// Dimensions are given in blocks. Vectors multiplied by the matrix are
+// plain contiguous arrays of block_cols()*B scalars.
+//
+// The matrix-vector product is multi-threaded with OpenMP when the code is
+// compiled with OpenMP support, and serial otherwise. Each thread writes a
+// disjoint set of block rows, so the result does not depend on the number
+// of threads.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+/// A block and its (block) row and column, used for assembly.
+template <typename T, unsigned int B>
+struct block_triplet
+{
+  block_triplet() : row(0), col(0), block() {}
+  block_triplet(unsigned int r, unsigned int c, const matrix<T,B,B>& b)
+  :
+  row(r), col(c), block(b) {}
+
+  unsigned int row;
+  unsigned int col;
+  matrix<T,B,B> block;
+};
+
+template <typename T, unsigned int B>
+class block_sparse_matrix {
+
+ public:
+
+  typedef T value_type;
+  typedef matrix<T,B,B> block_type;
+  typedef block_triplet<T,B> triplet_type;
+
+  enum { BLOCK_SIZE = B };
+
+  block_sparse_matrix() : m_blockRows(0), m_blockCols(0), m_rowPtr(1, 0u) {}
+
+  /// Empty matrix of blockRows x blockCols blocks
+  block_sparse_matrix(unsigned int blockRows, unsigned int blockCols)
+  :
+  m_blockRows(blockRows), m_blockCols(blockCols), m_rowPtr(blockRows+1, 0u)
+  {
+  }
+
+  /// Assemble from a sequence of block_triplet. See assign().
+  template <typename IT>
+  block_sparse_matrix(unsigned int blockRows, unsigned int blockCols,
+                      IT first, IT last)
+  :
+  m_blockRows(0), m_blockCols(0)
+  {
+    assign(blockRows, blockCols, first, last);
+  }
+
+  /// As above, setting success to the result of assign().
+  template <typename IT>
+  block_sparse_matrix(unsigned int blockRows, unsigned int blockCols,
+                      IT first, IT last, bool& success)
+  :
+  m_blockRows(0), m_blockCols(0)
+  {
+    success = assign(blockRows, blockCols, first, last);
+  }
+
+  ///
+  /// Assemble from a sequence of block_triplet.
+  /// Triplets may come in any order. Blocks with the same row and column
+  /// are summed, as is usual when assembling normal equations.
+  /// Return false, leaving an empty 0x0 matrix, if a triplet lies outside
+  /// blockRows x blockCols.
+  ///
+  template <typename IT>
+  bool assign(unsigned int blockRows, unsigned int blockCols,
+              IT first, IT last)
+  {
+    const std::vector<triplet_type> triplets(first, last);
+    m_blockRows = 0;
+    m_blockCols = 0;
+    m_rowPtr.assign(1, 0u);
+    m_colIdx.clear();
+    m_blocks.clear();
+    for (std::size_t i = 0; i < triplets.size(); ++i)
+    {
+      if (triplets[i].row >= blockRows || triplets[i].col >= blockCols) return false;
+    }
+    m_blockRows = blockRows;
+    m_blockCols = blockCols;
+
+    // counting sort of the triplets by row
+    std::vector<std::size_t> rowStart(blockRows + 1, 0);
+    for (std::size_t i = 0; i < triplets.size(); ++i)
+    {
+      ++rowStart[triplets[i].row + 1];
+    }
+    for (unsigned int r = 0; r < blockRows; ++r)
+    {
+      rowStart[r+1] += rowStart[r];
+    }
+    std::vector<std::size_t> order(triplets.size());
+    std::vector<std::size_t> next(rowStart.begin(), rowStart.end()-1);
+    for (std::size_t i = 0; i < triplets.size(); ++i)
+    {
+      order[next[triplets[i].row]++] = i;
+    }
+
+    // sort each row by column and merge duplicates
+    m_rowPtr.reserve(blockRows + 1);
+    m_colIdx.reserve(triplets.size());
+    m_blocks.reserve(triplets.size());
+    column_less less(triplets);
+    for (unsigned int r = 0; r < blockRows; ++r)
+    {
+      std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(rowStart[r]),
+                       order.begin() + static_cast<std::ptrdiff_t>(rowStart[r+1]),
+                       less);
+      const std::size_t rowBegin = m_blocks.size();
+      for (std::size_t k = rowStart[r]; k < rowStart[r+1]; ++k)
+      {
+        const triplet_type& t = triplets[order[k]];
+        if (m_blocks.size() > rowBegin && m_colIdx.back() == t.col)
+        {
+          m_blocks.back() += t.block;
+        } else {
+          m_colIdx.push_back(t.col);
+          m_blocks.push_back(t.block);
+        }
+      }
+      m_rowPtr.push_back(static_cast<unsigned int>(m_blocks.size()));
+    }
+    return true;
+  }
+
+  /// number of block rows
+  unsigned int block_rows() const { return m_blockRows; }
+  /// number of block columns
+  unsigned int block_cols() const { return m_blockCols; }
+  /// number of scalar rows
+  unsigned int rows() const { return m_blockRows*B; }
+  /// number of scalar columns
+  unsigned int cols() const { return m_blockCols*B; }
+  /// number of stored blocks
+  unsigned int nonzero_blocks() const
+  {
+    return static_cast<unsigned int>(m_blocks.size());
+  }
+
+  /// Pointer to block (i,j), or null if the block is not stored.
+  const block_type* find(unsigned int i, unsigned int j) const
+  {
+    const std::vector<unsigned int>::const_iterator first =
+      m_colIdx.begin() + m_rowPtr[i];
+    const std::vector<unsigned int>::const_iterator last =
+      m_colIdx.begin() + m_rowPtr[i+1];
+    const std::vector<unsigned int>::const_iterator it =
+      std::lower_bound(first, last, j);
+    if (it == last || *it != j) return 0;
+    return &m_blocks[static_cast<std::size_t>(it - m_colIdx.begin())];
+  }
+
+  block_type* find(unsigned int i, unsigned int j)
+  {
+    const block_sparse_matrix& self = *this;
+    return const_cast<block_type*>(self.find(i, j));
+  }
+
+  // raw BSR arrays
+  const std::vector<unsigned int>& row_offsets() const { return m_rowPtr; }
+  const std::vector<unsigned int>& column_indices() const { return m_colIdx; }
+  const std::vector<block_type>& blocks() const { return m_blocks; }
+  std::vector<block_type>& blocks() { return m_blocks; }
+
+  ///
+  /// Matrix-vector product y = A*x.
+  /// x must hold cols() elements and y rows() elements. x and y must
+  /// not overlap.
+  ///
+  void multiply(const T* x, T* y) const
+  {
+    const long nRows = static_cast<long>(m_blockRows);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long ir = 0; ir < nRows; ++ir)
+    {
+      const unsigned int r = static_cast<unsigned int>(ir);
+      T acc[B];
+      std::fill(acc, acc + B, T());
+      for (unsigned int k = m_rowPtr[r]; k < m_rowPtr[r+1]; ++k)
+      {
+        const block_type& blk = m_blocks[k];
+        const T* xj = x + m_colIdx[k]*B;
+        for (unsigned int i = 0; i < B; ++i)
+        {
+          for (unsigned int j = 0; j < B; ++j)
+          {
+            acc[i] += blk(i,j) * xj[j];
+          }
+        }
+      }
+      std::copy(acc, acc + B, y + r*B);
+    }
+  }
+
+  ///
+  /// Matrix-vector product y = A*x. y is resized to rows(). Return false,
+  /// leaving y unchanged, if x does not hold cols() elements.
+  ///
+  bool multiply(const std::vector<T>& x, std::vector<T>& y) const
+  {
+    if (x.size() != cols()) return false;
+    y.resize(rows());
+    if (!y.empty()) multiply(x.empty() ? 0 : &x[0], &y[0]);
+    return true;
+  }
+
+ private:
+
+  // orders triplet indices by column
+  struct column_less
+  {
+    explicit column_less(const std::vector<triplet_type>& t) : triplets(t) {}
+    bool operator()(std::size_t lhs, std::size_t rhs) const
+    {
+      return triplets[lhs].col < triplets[rhs].col;
+    }
+    const std::vector<triplet_type>& triplets;
+  };
+
+  unsigned int m_blockRows;
+  unsigned int m_blockCols;
+  std::vector<unsigned int> m_rowPtr;
+  std::vector<unsigned int> m_colIdx;
+  std::vector<block_type> m_blocks;
+
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_BLOCKSPARSEMATRIX_H_
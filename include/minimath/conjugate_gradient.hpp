@@ -0,0 +1,326 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_CONJUGATEGRADIENT_H_
+#define MINIMATH_CONJUGATEGRADIENT_H_
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_inversion.hpp"
+#include "minimath/matrix_solve.hpp"
+#include "minimath/block_sparse_matrix.hpp"
+
+//
+// Preconditioned conjugate gradient solver for large, sparse, symmetric
+// positive definite systems stored as block_sparse_matrix, with a
+// block-Jacobi preconditioner.
+//
+// All vectors are allocated before the first iteration, either by the
+// caller through a pcg_workspace or once per solve.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// invert a diagonal block in place. 1x1, 2x2 and 3x3 blocks use
+// matrix_invertor, larger blocks an LU solve against the identity.
+template <typename T, unsigned int B>
+struct block_inverse
+{
+  bool operator()(matrix<T,B,B>& m) const
+  {
+    bool success = false;
+    m = solve(m, matrix<T,B,B>(identity_matrix()), success);
+    return success;
+  }
+};
+
+template <typename T>
+struct invertor_block_inverse
+{
+  template <typename M>
+  bool operator()(M& m) const
+  {
+    bool success = false;
+    m.invert(success);
+    return success;
+  }
+};
+
+template <typename T>
+struct block_inverse<T,1> : invertor_block_inverse<T> {};
+template <typename T>
+struct block_inverse<T,2> : invertor_block_inverse<T> {};
+template <typename T>
+struct block_inverse<T,3> : invertor_block_inverse<T> {};
+
+template <typename T>
+T dot(const T* a, const T* b, std::size_t n)
+{
+  const long size = static_cast<long>(n);
+  T sum = T();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+:sum)
+#endif
+  for (long i = 0; i < size; ++i)
+  {
+    sum += a[i]*b[i];
+  }
+  return sum;
+}
+
+// y += alpha*x
+template <typename T>
+void axpy(T alpha, const T* x, T* y, std::size_t n)
+{
+  const long size = static_cast<long>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long i = 0; i < size; ++i)
+  {
+    y[i] += alpha*x[i];
+  }
+}
+
+// y = x + beta*y
+template <typename T>
+void xpby(const T* x, T beta, T* y, std::size_t n)
+{
+  const long size = static_cast<long>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long i = 0; i < size; ++i)
+  {
+    y[i] = x[i] + beta*y[i];
+  }
+}
+
+} // namespace detail
+
+///
+/// Block-Jacobi preconditioner: the inverses of the diagonal blocks of a
+/// block_sparse_matrix.
+///
+template <typename T, unsigned int B>
+class block_jacobi_preconditioner {
+
+ public:
+
+  typedef matrix<T,B,B> block_type;
+
+  block_jacobi_preconditioner() {}
+
+  explicit block_jacobi_preconditioner(const block_sparse_matrix<T,B>& A)
+  {
+    compute(A);
+  }
+
+  ///
+  /// Invert the diagonal blocks of A.
+  /// Return false if a diagonal block is missing or singular.
+  ///
+  bool compute(const block_sparse_matrix<T,B>& A)
+  {
+    m_inv.resize(A.block_rows());
+    bool success = true;
+    for (unsigned int i = 0; i < A.block_rows(); ++i)
+    {
+      const block_type* d = A.find(i, i);
+      if (d == 0)
+      {
+        m_inv[i] = identity_matrix();
+        success = false;
+        continue;
+      }
+      m_inv[i] = *d;
+      if (!detail::block_inverse<T,B>()(m_inv[i]))
+      {
+        m_inv[i] = identity_matrix();
+        success = false;
+      }
+    }
+    return success;
+  }
+
+  /// z = M^-1 * r
+  void apply(const T* r, T* z) const
+  {
+    const long n = static_cast<long>(m_inv.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long ib = 0; ib < n; ++ib)
+    {
+      const std::size_t b = static_cast<std::size_t>(ib);
+      const block_type& inv = m_inv[b];
+      const T* rb = r + b*B;
+      T* zb = z + b*B;
+      for (unsigned int i = 0; i < B; ++i)
+      {
+        T acc = T();
+        for (unsigned int j = 0; j < B; ++j)
+        {
+          acc += inv(i,j) * rb[j];
+        }
+        zb[i] = acc;
+      }
+    }
+  }
+
+  const std::vector<block_type>& blocks() const { return m_inv; }
+
+ private:
+  std::vector<block_type> m_inv;
+};
+
+/// Outcome of a conjugate gradient solve.
+template <typename T>
+struct pcg_result
+{
+  pcg_result() : converged(false), input_error(false), iterations(0), residual_norm() {}
+  bool converged;
+  ///
+  /// The solve was not attempted: b does not match A, or a diagonal block
+  /// of A is missing or singular, so that A is not positive definite.
+  ///
+  bool input_error;
+  unsigned int iterations;
+  /// 2-norm of the final residual, relative to the 2-norm of b.
+  T residual_norm;
+};
+
+/// Work vectors for pcg_solve, so that repeated solves do not allocate.
+template <typename T>
+struct pcg_workspace
+{
+  void resize(std::size_t n)
+  {
+    r.resize(n);
+    z.resize(n);
+    p.resize(n);
+    q.resize(n);
+  }
+  std::vector<T> r, z, p, q;
+};
+
+///
+/// Solve A*x = b by preconditioned conjugate gradients.
+/// A must be symmetric positive definite.
+///
+/// @param A             : square block sparse matrix
+/// @param b             : right hand side, A.rows() elements
+/// @param x             : initial guess on entry, solution on exit
+/// @param M             : block-Jacobi preconditioner for A
+/// @param tolerance     : convergence threshold for |r|/|b|
+/// @param maxIterations : maximum number of iterations
+/// @param work          : work vectors, resized if necessary
+///
+template <typename T, unsigned int B>
+pcg_result<T> pcg_solve(const block_sparse_matrix<T,B>& A,
+                        const T* b,
+                        T* x,
+                        const block_jacobi_preconditioner<T,B>& M,
+                        T tolerance,
+                        unsigned int maxIterations,
+                        pcg_workspace<T>& work)
+{
+  using std::sqrt;
+  pcg_result<T> result;
+  const std::size_t n = A.rows();
+  if (n == 0)
+  {
+    result.converged = true;
+    return result;
+  }
+  work.resize(n);
+  T* r = &work.r[0];
+  T* z = &work.z[0];
+  T* p = &work.p[0];
+  T* q = &work.q[0];
+
+  T bnorm = sqrt(detail::dot(b, b, n));
+  if (!(bnorm > T())) bnorm = T(1);
+
+  // r = b - A*x
+  A.multiply(x, r);
+  for (std::size_t i = 0; i < n; ++i) r[i] = b[i] - r[i];
+  result.residual_norm = sqrt(detail::dot(r, r, n))/bnorm;
+  if (result.residual_norm <= tolerance)
+  {
+    result.converged = true;
+    return result;
+  }
+
+  M.apply(r, z);
+  std::copy(z, z + n, p);
+  T rz = detail::dot(r, z, n);
+
+  while (result.iterations < maxIterations)
+  {
+    ++result.iterations;
+    A.multiply(p, q);
+    const T pq = detail::dot(p, q, n);
+    if (!(pq > T())) break; // A is not positive definite
+    const T alpha = rz/pq;
+    detail::axpy(alpha, p, x, n);
+    detail::axpy(-alpha, q, r, n);
+    result.residual_norm = sqrt(detail::dot(r, r, n))/bnorm;
+    if (result.residual_norm <= tolerance)
+    {
+      result.converged = true;
+      break;
+    }
+    M.apply(r, z);
+    const T rzNew = detail::dot(r, z, n);
+    detail::xpby(z, rzNew/rz, p, n);
+    rz = rzNew;
+  }
+  return result;
+}
+
+///
+/// Solve A*x = b by block-Jacobi preconditioned conjugate gradients.
+/// x holds the initial guess on entry and is resized to A.cols() if needed.
+/// If b does not hold A.rows() elements, or the preconditioner cannot be
+/// computed, input_error is set and x is left as it is.
+///
+template <typename T, unsigned int B>
+pcg_result<T> pcg_solve(const block_sparse_matrix<T,B>& A,
+                        const std::vector<T>& b,
+                        std::vector<T>& x,
+                        T tolerance,
+                        unsigned int maxIterations)
+{
+  pcg_result<T> result;
+  block_jacobi_preconditioner<T,B> M;
+  if (b.size() != A.rows() || !M.compute(A))
+  {
+    result.input_error = true;
+    return result;
+  }
+  x.resize(A.cols());
+  if (x.empty())
+  {
+    result.converged = true;
+    return result;
+  }
+  pcg_workspace<T> work;
+  return pcg_solve(A, &b[0], &x[0], M, tolerance, maxIterations, work);
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_CONJUGATEGRADIENT_H_
@@ -0,0 +1,380 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_DYNAMIC_KD_TREE_H_
+#define MINIMATH_DYNAMIC_KD_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <tr1/unordered_map>
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/kd_tree.hpp"
+
+//
+// Spatial index of XYZ points supporting insertion and removal, for
+// streams of points where rebuilding a static kd_tree every time would
+// dominate.
+//
+// The points live in a forest of static kd_trees (the logarithmic method
+// of Bentley and Saxe): tree j holds at most B*2^j points, where B is the
+// size of a small buffer of recent insertions that is scanned linearly.
+// When the buffer fills, it is merged with trees 0, 1, ... up to the
+// first empty slot, and a single tree is built there. Each point is thus
+// rebuilt O(log n) times, and a query visits O(log n) trees, all sharing
+// one nearest neighbour heap so that the first trees narrow the search
+// of the rest.
+//
+// Removed points are marked and skipped by queries, and dropped when
+// their tree is next rebuilt. Once they outnumber the live points the
+// whole forest is rebuilt.
+//
+// Points are identified by the id returned by insert. Ids are consecutive
+// and never reused. Points are stored in slots, found from their id
+// through a hash map, and the slot of a dropped point is reused by a later
+// insertion, so memory is bounded by the peak number of live points, not
+// by the number of insertions.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// Maps the build positions of one tree of the forest to point ids, and
+// skips removed points
+struct forest_ids
+{
+  forest_ids(const std::size_t* slots, const unsigned char* removed, const std::size_t* ids)
+  :
+  m_slots(slots), m_removed(removed), m_ids(ids) {}
+
+  bool operator()(std::size_t index, std::size_t& id) const
+  {
+    const std::size_t slot = m_slots[index];
+    id = m_ids[slot];
+    return !m_removed[slot];
+  }
+
+ private:
+  const std::size_t* m_slots;
+  const unsigned char* m_removed;
+  const std::size_t* m_ids;
+};
+
+} // namespace detail
+
+template <typename T, unsigned int L = 16>
+class dynamic_kd_tree {
+
+ public:
+
+  typedef T value_type;
+  typedef point3d<T> point_type;
+  typedef kd_neighbour<T> neighbour;
+  typedef std::size_t size_type;
+
+  /// Number of insertions buffered before they are moved to a tree.
+  static const size_type buffer_size = 8*L;
+
+  dynamic_kd_tree() : m_next_id(0), m_live(0), m_dead(0) {}
+
+  /// Number of points inserted and not removed.
+  size_type size() const { return m_live; }
+  bool empty() const { return m_live == 0; }
+
+  /// Insert a point and return its id.
+  template <typename P>
+  size_type insert(const P& p)
+  {
+    const size_type id = m_next_id++;
+    const point_type point(p.x(), p.y(), p.z());
+    size_type slot = m_points.size();
+    if (m_free.empty())
+    {
+      m_points.push_back(point);
+      m_removed.push_back(0);
+      m_ids.push_back(id);
+    }
+    else
+    {
+      slot = m_free.back();
+      m_free.pop_back();
+      m_points[slot] = point;
+      m_removed[slot] = 0;
+      m_ids[slot] = id;
+    }
+    m_slots[id] = slot;
+    m_buffer.push_back(slot);
+    ++m_live;
+    if (m_buffer.size() == buffer_size) flush();
+    return id;
+  }
+
+  /// Insert the points of [first, last), with consecutive ids.
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first) insert(*first);
+  }
+
+  ///
+  /// Remove the point with the given id. Return false if there is no such
+  /// point or it has already been removed.
+  ///
+  bool remove(size_type id)
+  {
+    const typename slot_map::iterator found = m_slots.find(id);
+    if (found == m_slots.end()) return false;
+    const size_type slot = found->second;
+    m_slots.erase(found);
+    m_removed[slot] = 1;
+    --m_live;
+    std::vector<size_type>::iterator it = std::find(m_buffer.begin(), m_buffer.end(), slot);
+    if (it != m_buffer.end())
+    {
+      m_buffer.erase(it);
+      m_free.push_back(slot);
+    }
+    else if (++m_dead > m_live)
+    {
+      rebuild();
+    }
+    return true;
+  }
+
+  /// Whether id is the id of a point inserted and not removed.
+  bool contains(size_type id) const { return m_slots.find(id) != m_slots.end(); }
+
+  /// The point with the given id, which must be contained.
+  const point_type& point(size_type id) const { return m_points[m_slots.find(id)->second]; }
+
+  ///
+  /// Number of point slots held: live points, removed points still in a
+  /// tree, and free slots. At most about twice the peak number of live
+  /// points.
+  ///
+  size_type capacity() const { return m_points.size(); }
+
+  /// Number of static trees holding points.
+  size_type trees() const
+  {
+    size_type n = 0;
+    for (size_type j = 0; j < m_levels.size(); ++j) n += m_levels[j].slots.empty() ? 0 : 1;
+    return n;
+  }
+
+  ///
+  /// The k nearest points to q, in increasing order of distance, written
+  /// to out, which must have room for k results. The neighbour indices are
+  /// point ids. Return the number of results, min(k, size()).
+  ///
+  template <typename P>
+  size_type nearest(const P& q, size_type k, neighbour* out) const
+  {
+    if (k == 0) return 0;
+    const point_type p(q.x(), q.y(), q.z());
+    size_type count = 0;
+    for (size_type i = 0; i < m_buffer.size(); ++i)
+    {
+      const size_type slot = m_buffer[i];
+      detail::push_neighbour(out, count, k, neighbour(m_ids[slot], dist2(m_points[slot], p)));
+    }
+    for (size_type j = m_levels.size(); j-- > 0; )
+    {
+      m_levels[j].tree.merge_nearest(p, k, out, count, ids(j));
+    }
+    std::sort_heap(out, out + count);
+    return count;
+  }
+
+  ///
+  /// Append to out the points within distance r of q, in no particular
+  /// order. Return the number of points appended.
+  ///
+  template <typename P>
+  size_type radius(const P& q, T r, std::vector<neighbour>& out) const
+  {
+    const size_type n = out.size();
+    const point_type p(q.x(), q.y(), q.z());
+    const T r2 = r*r;
+    for (size_type i = 0; i < m_buffer.size(); ++i)
+    {
+      const size_type slot = m_buffer[i];
+      const T d2 = dist2(m_points[slot], p);
+      if (!(r2 < d2)) out.push_back(neighbour(m_ids[slot], d2));
+    }
+    for (size_type j = 0; j < m_levels.size(); ++j)
+    {
+      m_levels[j].tree.radius(p, r, out, ids(j));
+    }
+    return out.size() - n;
+  }
+
+  ///
+  /// Append to out the ids of the points in the axis aligned box
+  /// [min, max], in no particular order. Return the number of points
+  /// appended.
+  ///
+  template <typename P>
+  size_type box(const P& min, const P& max, std::vector<size_type>& out) const
+  {
+    const size_type n = out.size();
+    for (size_type i = 0; i < m_buffer.size(); ++i)
+    {
+      const point_type& p = m_points[m_buffer[i]];
+      if (!(p.x() < min.x()) && !(max.x() < p.x()) &&
+          !(p.y() < min.y()) && !(max.y() < p.y()) &&
+          !(p.z() < min.z()) && !(max.z() < p.z()))
+      {
+        out.push_back(m_ids[m_buffer[i]]);
+      }
+    }
+    for (size_type j = 0; j < m_levels.size(); ++j)
+    {
+      m_levels[j].tree.box(min, max, out, ids(j));
+    }
+    return out.size() - n;
+  }
+
+  ///
+  /// k nearest neighbours of each query point of [first, last), processed
+  /// in parallel. The results of query i go to out[i*k] and following,
+  /// and their number to counts[i].
+  ///
+  template <typename RandomAccessIterator>
+  void nearest(RandomAccessIterator first, RandomAccessIterator last, size_type k,
+               neighbour* out, size_type* counts) const
+  {
+    const long size = static_cast<long>(last - first);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      const size_type j = static_cast<size_type>(i);
+      counts[j] = nearest(first[i], k, out + j*k);
+    }
+  }
+
+  ///
+  /// Points within distance r of each query point of [first, last),
+  /// processed in parallel. out is resized to the number of queries and
+  /// out[i] holds the results of query i.
+  ///
+  template <typename RandomAccessIterator>
+  void radius(RandomAccessIterator first, RandomAccessIterator last, T r,
+              std::vector<std::vector<neighbour> >& out) const
+  {
+    const long size = static_cast<long>(last - first);
+    out.resize(static_cast<size_type>(size));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      std::vector<neighbour>& result = out[static_cast<size_type>(i)];
+      result.clear();
+      radius(first[i], r, result);
+    }
+  }
+
+ private:
+
+  typedef std::tr1::unordered_map<size_type, size_type> slot_map;
+
+  struct level
+  {
+    kd_tree<T,L> tree;
+    std::vector<size_type> slots; // slot of each point, by build position
+  };
+
+  detail::forest_ids ids(size_type j) const
+  {
+    const std::vector<size_type>& v = m_levels[j].slots;
+    return detail::forest_ids(v.empty() ? 0 : &v[0], &m_removed[0], &m_ids[0]);
+  }
+
+  // Append the live points of level j to slots, free the slots of its
+  // removed points, and empty the level
+  void take(size_type j, std::vector<size_type>& slots)
+  {
+    level& lev = m_levels[j];
+    for (size_type i = 0; i < lev.slots.size(); ++i)
+    {
+      const size_type slot = lev.slots[i];
+      if (m_removed[slot])
+      {
+        m_free.push_back(slot);
+        --m_dead;
+      }
+      else
+      {
+        slots.push_back(slot);
+      }
+    }
+    lev.slots.clear();
+    lev.tree = kd_tree<T,L>();
+  }
+
+  void build(size_type j, std::vector<size_type>& slots)
+  {
+    if (m_levels.size() <= j) m_levels.resize(j + 1);
+    level& lev = m_levels[j];
+    std::vector<point_type> points;
+    points.reserve(slots.size());
+    for (size_type i = 0; i < slots.size(); ++i) points.push_back(m_points[slots[i]]);
+    lev.tree.build(points.begin(), points.end());
+    lev.slots.swap(slots);
+  }
+
+  // Move the buffer to the first empty level, merging the levels before it
+  void flush()
+  {
+    std::vector<size_type> slots;
+    slots.swap(m_buffer);
+    size_type j = 0;
+    for (; j < m_levels.size() && !m_levels[j].slots.empty(); ++j) take(j, slots);
+    build(j, slots);
+  }
+
+  // Rebuild the forest as a single tree without removed points
+  void rebuild()
+  {
+    std::vector<size_type> slots;
+    slots.swap(m_buffer);
+    for (size_type j = 0; j < m_levels.size(); ++j) take(j, slots);
+    m_levels.clear();
+    if (slots.size() < buffer_size)
+    {
+      m_buffer.swap(slots);
+      return;
+    }
+    size_type j = 0;
+    while ((buffer_size << j) < slots.size()) ++j;
+    build(j, slots);
+  }
+
+  std::vector<point_type> m_points;     // points, by slot
+  std::vector<unsigned char> m_removed; // removal marks, by slot
+  std::vector<size_type> m_ids;         // point ids, by slot
+  std::vector<size_type> m_free;        // slots of dropped points
+  slot_map m_slots;                     // slot of each live point, by id
+  std::vector<size_type> m_buffer;      // slots of points not yet in a tree
+  std::vector<level> m_levels;
+  size_type m_next_id;
+  size_type m_live;
+  size_type m_dead;                     // removed points still in trees
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_DYNAMIC_KD_TREE_H_
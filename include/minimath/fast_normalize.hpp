@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_FAST_NORMALIZE_H_
+#define MINIMATH_FAST_NORMALIZE_H_
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include "minimath/type_traits.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/point3d_batch_ops.hpp"
+#include "minimath/point_cloud.hpp"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+//
+// Approximate normalization, for callers such as ray casters that need
+// many unit directions and can trade a little accuracy for speed.
+//
+// For float, the inverse length comes from the hardware reciprocal square
+// root estimate refined with one Newton-Raphson step,
+//
+//   y' = y*(1.5 - 0.5*x*y*y)
+//
+// which brings the relative error of the result below 1e-6, against
+// roughly 4e-4 for the raw estimate. The batch versions do four points
+// per SSE instruction. Other scalar types, and builds without SSE, use
+// the exact 1/sqrt.
+//
+// Points with mag2 below std::numeric_limits<T>::min(), zero included,
+// are left unchanged.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// 1/sqrt(x), or 1 when x is too small to be normalized
+template <typename T>
+T approx_rsqrt(T x)
+{
+  using std::sqrt;
+  return x < std::numeric_limits<T>::min() ? T(1) : T(1)/sqrt(x);
+}
+
+#if defined(__SSE__)
+
+// rsqrt estimate plus one Newton step. Lanes with x below FLT_MIN give 1.
+inline __m128 sse_approx_rsqrt(__m128 x)
+{
+  const __m128 y = _mm_rsqrt_ps(x);
+  const __m128 xyy = _mm_mul_ps(_mm_mul_ps(x, y), y);
+  const __m128 r = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), y),
+                              _mm_sub_ps(_mm_set1_ps(3.f), xyy));
+  const __m128 ok = _mm_cmpge_ps(x, _mm_set1_ps(std::numeric_limits<float>::min()));
+  return _mm_or_ps(_mm_and_ps(ok, r), _mm_andnot_ps(ok, _mm_set1_ps(1.f)));
+}
+
+inline float approx_rsqrt(float x)
+{
+  return _mm_cvtss_f32(sse_approx_rsqrt(_mm_set_ss(x)));
+}
+
+#endif
+
+} // namespace detail
+
+/// Return the approximately normalized point.
+template <typename P>
+typename enable_if<is_point3d<P>::value, P>::type
+normalize_approx(const P& p)
+{
+  P n = p;
+  n *= detail::approx_rsqrt(mag2(p));
+  return n;
+}
+
+/// Approximately normalize every point of [first, last) in place.
+template <typename ForwardIterator>
+void normalize_approx(ForwardIterator first, ForwardIterator last)
+{
+  typedef typename std::iterator_traits<ForwardIterator>::value_type value_type;
+  for (; first != last; ++first)
+  {
+    *first = normalize_approx(value_type(*first));
+  }
+}
+
+/// Approximately normalize p[i], i in [0, n), in place.
+template <typename T>
+void normalize_approx(point3d<T>* p, std::size_t n)
+{
+  normalize_approx(p, p + n);
+}
+
+/// Approximately normalize every point of a cloud in place.
+template <typename T>
+void normalize_approx(point_cloud<T>& cloud)
+{
+  T* x = cloud.x_data();
+  T* y = cloud.y_data();
+  T* z = cloud.z_data();
+  const std::size_t n = cloud.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T s = detail::approx_rsqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+    x[i] *= s;
+    y[i] *= s;
+    z[i] *= s;
+  }
+}
+
+#if defined(__SSE2__)
+
+/// Approximately normalize p[i], i in [0, n), in place.
+inline void normalize_approx(point3d<float>* p, std::size_t n)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 x, y, z;
+    detail::load_points4(p + i, x, y, z);
+    const __m128 s = detail::sse_approx_rsqrt(detail::sse_mag2(x, y, z));
+    // scale the packed x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 in place
+    float* f = &p[i][0];
+    _mm_storeu_ps(f,     _mm_mul_ps(_mm_loadu_ps(f),     _mm_shuffle_ps(s, s, _MM_SHUFFLE(1,0,0,0))));
+    _mm_storeu_ps(f + 4, _mm_mul_ps(_mm_loadu_ps(f + 4), _mm_shuffle_ps(s, s, _MM_SHUFFLE(2,2,1,1))));
+    _mm_storeu_ps(f + 8, _mm_mul_ps(_mm_loadu_ps(f + 8), _mm_shuffle_ps(s, s, _MM_SHUFFLE(3,3,3,2))));
+  }
+  normalize_approx(p + i, p + n);
+}
+
+/// Approximately normalize every point of a cloud in place.
+inline void normalize_approx(point_cloud<float>& cloud)
+{
+  float* x = cloud.x_data();
+  float* y = cloud.y_data();
+  float* z = cloud.z_data();
+  const std::size_t n = cloud.size();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 px = _mm_loadu_ps(x + i);
+    const __m128 py = _mm_loadu_ps(y + i);
+    const __m128 pz = _mm_loadu_ps(z + i);
+    const __m128 s = detail::sse_approx_rsqrt(detail::sse_mag2(px, py, pz));
+    _mm_storeu_ps(x + i, _mm_mul_ps(px, s));
+    _mm_storeu_ps(y + i, _mm_mul_ps(py, s));
+    _mm_storeu_ps(z + i, _mm_mul_ps(pz, s));
+  }
+  for (; i < n; ++i)
+  {
+    const float s = detail::approx_rsqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+    x[i] *= s;
+    y[i] *= s;
+    z[i] *= s;
+  }
+}
+
+#endif
+
+} // namespace minimath
+
+#endif // MINIMATH_FAST_NORMALIZE_H_
@@ -0,0 +1,401 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_FIXEDPOINT_H_
+#define MINIMATH_FIXEDPOINT_H_
+
+#include <limits>
+#include <ostream>
+#include <tr1/cstdint>
+#include "minimath/type_traits.hpp"
+#include "minimath/numeric_utils.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/point3d.hpp"
+
+//
+// Q-format fixed point number, for use as the value type of matrix,
+// point3d and transform3d on hardware without floating point support.
+//
+// fixed_point<Int, F> stores a value v as the integer round(v * 2^F).
+// All arithmetic is integer only and saturates at the limits of Int
+// instead of wrapping. Products and quotients are computed in an integer
+// twice as wide as Int, and rounded to nearest.
+//
+// Conversions from and to floating point are provided for setting up
+// values and for output, and are not used by any of the arithmetic.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+template <typename Int> struct wider_int;
+template <> struct wider_int<std::tr1::int8_t> { typedef std::tr1::int16_t type; };
+template <> struct wider_int<std::tr1::int16_t> { typedef std::tr1::int32_t type; };
+template <> struct wider_int<std::tr1::int32_t> { typedef std::tr1::int64_t type; };
+
+} // namespace detail
+
+template <typename Int, unsigned int F>
+class fixed_point {
+
+ public:
+
+  typedef Int raw_type;
+  typedef typename detail::wider_int<Int>::type wide_type;
+
+  enum { FRACTIONAL_BITS = F };
+
+  fixed_point() : m_raw() {}
+
+  // integers convert implicitly, as for built-in number types
+  fixed_point(int value) : m_raw(saturate_int(value)) {}
+
+  fixed_point(unsigned int value)
+  :
+  m_raw(saturate_double(static_cast<double>(value) * static_cast<double>(one())))
+  {
+  }
+
+  explicit fixed_point(double value)
+  :
+  m_raw(saturate_double(value * static_cast<double>(one())))
+  {
+  }
+
+  /// construct from a raw Q-format integer
+  static fixed_point from_raw(raw_type raw)
+  {
+    fixed_point f;
+    f.m_raw = raw;
+    return f;
+  }
+
+  raw_type raw() const { return m_raw; }
+
+  double to_double() const
+  {
+    return static_cast<double>(m_raw)/static_cast<double>(one());
+  }
+
+  float to_float() const { return static_cast<float>(to_double()); }
+
+  fixed_point operator-() const
+  {
+    return from_raw(saturate(-wide_type(m_raw)));
+  }
+
+  fixed_point& operator+=(const fixed_point& rhs)
+  {
+    m_raw = saturate(wide_type(m_raw) + wide_type(rhs.m_raw));
+    return *this;
+  }
+
+  fixed_point& operator-=(const fixed_point& rhs)
+  {
+    m_raw = saturate(wide_type(m_raw) - wide_type(rhs.m_raw));
+    return *this;
+  }
+
+  fixed_point& operator*=(const fixed_point& rhs)
+  {
+    m_raw = saturate(round_shift(wide_type(m_raw) * wide_type(rhs.m_raw)));
+    return *this;
+  }
+
+  fixed_point& operator/=(const fixed_point& rhs)
+  {
+    if (rhs.m_raw == 0)
+    {
+      m_raw = m_raw < 0 ? std::numeric_limits<raw_type>::min()
+                        : std::numeric_limits<raw_type>::max();
+      return *this;
+    }
+    // divide magnitudes, rounding to nearest, away from zero on ties
+    const bool negative = (m_raw < 0) != (rhs.m_raw < 0);
+    wide_type num = wide_type(m_raw) * one();
+    wide_type den = wide_type(rhs.m_raw);
+    if (num < 0) num = -num;
+    if (den < 0) den = -den;
+    const wide_type q = (num + den/2) / den;
+    m_raw = saturate(negative ? -q : q);
+    return *this;
+  }
+
+  // Binary operators are friends so that integers on either side
+  // convert implicitly, e.g. 2*f or f < 0.
+
+  friend fixed_point operator+(fixed_point lhs, const fixed_point& rhs)
+  {
+    return lhs += rhs;
+  }
+
+  friend fixed_point operator-(fixed_point lhs, const fixed_point& rhs)
+  {
+    return lhs -= rhs;
+  }
+
+  friend fixed_point operator*(fixed_point lhs, const fixed_point& rhs)
+  {
+    return lhs *= rhs;
+  }
+
+  friend fixed_point operator/(fixed_point lhs, const fixed_point& rhs)
+  {
+    return lhs /= rhs;
+  }
+
+  friend bool operator==(const fixed_point& lhs, const fixed_point& rhs)
+  {
+    return lhs.m_raw == rhs.m_raw;
+  }
+  friend bool operator!=(const fixed_point& lhs, const fixed_point& rhs)
+  {
+    return lhs.m_raw != rhs.m_raw;
+  }
+  friend bool operator<(const fixed_point& lhs, const fixed_point& rhs)
+  {
+    return lhs.m_raw < rhs.m_raw;
+  }
+  friend bool operator>(const fixed_point& lhs, const fixed_point& rhs)
+  {
+    return lhs.m_raw > rhs.m_raw;
+  }
+  friend bool operator<=(const fixed_point& lhs, const fixed_point& rhs)
+  {
+    return lhs.m_raw <= rhs.m_raw;
+  }
+  friend bool operator>=(const fixed_point& lhs, const fixed_point& rhs)
+  {
+    return lhs.m_raw >= rhs.m_raw;
+  }
+
+  /// 2^F, the raw representation of 1
+  static wide_type one() { return wide_type(1) << F; }
+
+  /// shift a product of two raw values back to F fractional bits,
+  /// rounding to nearest
+  static wide_type round_shift(wide_type product)
+  {
+    const wide_type half = wide_type(1) << (F - 1);
+    return product >= 0 ? (product + half) / one()
+                        : -((-product + half) / one());
+  }
+
+  /// clamp a wide value to the range of raw_type
+  static raw_type saturate(wide_type value)
+  {
+    const wide_type hi = wide_type(std::numeric_limits<raw_type>::max());
+    const wide_type lo = wide_type(std::numeric_limits<raw_type>::min());
+    if (value > hi) return std::numeric_limits<raw_type>::max();
+    if (value < lo) return std::numeric_limits<raw_type>::min();
+    return static_cast<raw_type>(value);
+  }
+
+ private:
+
+  // clamped to the integer part range first, so the shift cannot overflow
+  static raw_type saturate_int(int value)
+  {
+    const long hi = static_cast<long>(std::numeric_limits<raw_type>::max()/one());
+    const long lo = static_cast<long>(std::numeric_limits<raw_type>::min()/one());
+    if (value > hi) return std::numeric_limits<raw_type>::max();
+    if (value < lo) return std::numeric_limits<raw_type>::min();
+    return saturate(wide_type(value) * one());
+  }
+
+  static raw_type saturate_double(double value)
+  {
+    const double hi = static_cast<double>(std::numeric_limits<raw_type>::max());
+    const double lo = static_cast<double>(std::numeric_limits<raw_type>::min());
+    if (value >= hi) return std::numeric_limits<raw_type>::max();
+    if (value <= lo) return std::numeric_limits<raw_type>::min();
+    return static_cast<raw_type>(value < 0 ? value - 0.5 : value + 0.5);
+  }
+
+  raw_type m_raw;
+};
+
+template <typename Int, unsigned int F>
+fixed_point<Int,F> abs(const fixed_point<Int,F>& f)
+{
+  return f.raw() < 0 ? -f : f;
+}
+
+///
+/// Square root, by integer bisection on the raw value. Exact to within
+/// one unit in the last place. Returns 0 for negative arguments.
+///
+template <typename Int, unsigned int F>
+fixed_point<Int,F> sqrt(const fixed_point<Int,F>& f)
+{
+  typedef typename fixed_point<Int,F>::wide_type wide_type;
+  if (f.raw() <= 0) return fixed_point<Int,F>();
+  // sqrt(raw * 2^F) is the raw result
+  const wide_type target = wide_type(f.raw()) * fixed_point<Int,F>::one();
+  wide_type lo = 0;
+  wide_type hi = wide_type(std::numeric_limits<Int>::max());
+  while (lo < hi)
+  {
+    const wide_type mid = lo + (hi - lo + 1)/2;
+    if (mid <= target/mid) lo = mid; else hi = mid - 1;
+  }
+  return fixed_point<Int,F>::from_raw(static_cast<Int>(lo));
+}
+
+template <typename Int, unsigned int F>
+std::ostream& operator<<(std::ostream& out, const fixed_point<Int,F>& f)
+{
+  return out << f.to_double();
+}
+
+template <typename Int, unsigned int F>
+struct is_numeric<fixed_point<Int,F> > : integral_constant<bool, true> {};
+
+/// Q16.16: 32 bit, 16 fractional bits
+typedef fixed_point<std::tr1::int32_t, 16> q16_16;
+/// Q8.24: 32 bit, 24 fractional bits, for unit vectors and rotations
+typedef fixed_point<std::tr1::int32_t, 24> q8_24;
+/// Q8.8: 16 bit, 8 fractional bits
+typedef fixed_point<std::tr1::int16_t, 8> q8_8;
+
+// ============================================================================
+// Integer kernels. Dot products are accumulated in the wide type and
+// rounded once, rather than once per product. The accumulator itself does
+// not saturate, which leaves ample headroom for the sums of three or four
+// products used here unless the operands are close to the limits of Int.
+
+namespace detail
+{
+
+template <typename Int, unsigned int F>
+struct fixed_accumulator
+{
+  typedef fixed_point<Int,F> value_type;
+  typedef typename value_type::wide_type wide_type;
+
+  fixed_accumulator() : sum() {}
+
+  void add(const value_type& a, const value_type& b)
+  {
+    sum += wide_type(a.raw()) * wide_type(b.raw());
+  }
+
+  void add(const value_type& a)
+  {
+    sum += wide_type(a.raw()) * value_type::one();
+  }
+
+  value_type result() const
+  {
+    return value_type::from_raw(value_type::saturate(value_type::round_shift(sum)));
+  }
+
+  wide_type sum;
+};
+
+} // namespace detail
+
+/// matrix product with wide accumulation
+template <typename Int, unsigned int F,
+          unsigned int N1, unsigned int N2, unsigned int N3>
+matrix<fixed_point<Int,F>,N1,N3> operator*(const matrix<fixed_point<Int,F>,N1,N2>& lhs,
+                                           const matrix<fixed_point<Int,F>,N2,N3>& rhs)
+{
+  matrix<fixed_point<Int,F>,N1,N3> tmp;
+  for (unsigned int row = 0; row < N1; ++row) {
+    for (unsigned int col = 0; col < N3; ++col) {
+      detail::fixed_accumulator<Int,F> acc;
+      for (unsigned int i = 0; i < N2; ++i) {
+        acc.add(lhs(row,i), rhs(i,col));
+      }
+      tmp(row,col) = acc.result();
+    }
+  }
+  return tmp;
+}
+
+/// rotation of a fixed point 3D point
+template <typename Int, unsigned int F>
+point3d<fixed_point<Int,F> > operator*(const matrix<fixed_point<Int,F>,3>& rot,
+                                       const point3d<fixed_point<Int,F> >& point)
+{
+  fixed_point<Int,F> elements[3];
+  for (unsigned int row = 0; row < 3; ++row) {
+    detail::fixed_accumulator<Int,F> acc;
+    for (unsigned int i = 0; i < 3; ++i) {
+      acc.add(rot(row,i), point[i]);
+    }
+    elements[row] = acc.result();
+  }
+  return point3d<fixed_point<Int,F> >(elements[0], elements[1], elements[2]);
+}
+
+/// rotation and translation of a fixed point 3D point.
+/// The 4th column represents the translation.
+template <typename Int, unsigned int F>
+point3d<fixed_point<Int,F> > operator*(const matrix<fixed_point<Int,F>,3,4>& rot,
+                                       const point3d<fixed_point<Int,F> >& point)
+{
+  fixed_point<Int,F> elements[3];
+  for (unsigned int row = 0; row < 3; ++row) {
+    detail::fixed_accumulator<Int,F> acc;
+    for (unsigned int i = 0; i < 3; ++i) {
+      acc.add(rot(row,i), point[i]);
+    }
+    acc.add(rot(row,3));
+    elements[row] = acc.result();
+  }
+  return point3d<fixed_point<Int,F> >(elements[0], elements[1], elements[2]);
+}
+
+/// comparison within tolerance, nEpsilons in units of the last place
+template <typename Int, unsigned int F>
+bool equal(const fixed_point<Int,F>& lhs,
+           const fixed_point<Int,F>& rhs,
+           unsigned int nEpsilons = 0)
+{
+  typedef typename fixed_point<Int,F>::wide_type wide_type;
+  const wide_type diff = wide_type(lhs.raw()) - wide_type(rhs.raw());
+  return (diff < 0 ? -diff : diff) <= wide_type(nEpsilons);
+}
+
+} // namespace minimath
+
+namespace std
+{
+
+template <typename Int, unsigned int F>
+class numeric_limits<minimath::fixed_point<Int,F> > {
+  typedef minimath::fixed_point<Int,F> fixed_type;
+ public:
+  static const bool is_specialized = true;
+  static const bool is_signed = true;
+  static const bool is_integer = false;
+  static const bool is_exact = true;
+  static const bool is_bounded = true;
+  static const bool is_modulo = false;
+  static const bool has_infinity = false;
+  static const bool has_quiet_NaN = false;
+  static const int radix = 2;
+  static const int digits = numeric_limits<Int>::digits;
+  /// smallest positive value, one unit in the last place
+  static fixed_type min() { return fixed_type::from_raw(Int(1)); }
+  static fixed_type max() { return fixed_type::from_raw(numeric_limits<Int>::max()); }
+  static fixed_type lowest() { return fixed_type::from_raw(numeric_limits<Int>::min()); }
+  /// one unit in the last place
+  static fixed_type epsilon() { return fixed_type::from_raw(Int(1)); }
+  static fixed_type round_error() { return fixed_type::from_raw(Int(1)); }
+};
+
+} // namespace std
+
+#endif // MINIMATH_FIXEDPOINT_H_
@@ -111,7 +111,9 @@ point3d<T> operator*(const matrix<T,3>& rot,
     }
     elements[row] = element; // dot prod of LHS row, RHS col
   }
-  return point3d<T> (elements[0], elements[1], elements[2]);
+  return point3d<T> (static_cast<T>(elements[0]),
+                     static_cast<T>(elements[1]),
+                     static_cast<T>(elements[2]));
 
 } 
 
@@ -143,7 +145,9 @@ point3d<T> operator*(const matrix<T,3,4>& rot,
     }
     elements[row] = element + rot(row,3); // dot prod of LHS row, RHS col
   }
-  return point3d<T> (elements[0], elements[1], elements[2]);
+  return point3d<T> (static_cast<T>(elements[0]),
+                     static_cast<T>(elements[1]),
+                     static_cast<T>(elements[2]));
 
 } 
 
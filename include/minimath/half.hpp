@@ -0,0 +1,364 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_HALF_H_
+#define MINIMATH_HALF_H_
+
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <tr1/cstdint>
+#include "minimath/type_traits.hpp"
+#include "minimath/point3d.hpp"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+//
+// 16 bit floating point storage types: IEEE 754 binary16 (half) and
+// bfloat16. They can be used as the value type of matrix, point3d and
+// transform3d to halve the size of large tables of cold data.
+//
+// These are storage types. Arithmetic converts to float, and results are
+// rounded back to 16 bits, to nearest even, only when stored.
+//
+// For bulk conversion of arrays use to_float and from_float, which use the
+// F16C instructions when compiled with F16C support (e.g. -mf16c).
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+inline std::tr1::uint32_t float_bits(float f)
+{
+  std::tr1::uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+inline float bits_float(std::tr1::uint32_t u)
+{
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// float to binary16, round to nearest even
+inline std::tr1::uint16_t float_to_half_bits(float f)
+{
+  typedef std::tr1::uint32_t uint32;
+  const uint32 x = float_bits(f);
+  const uint32 sign = (x >> 16) & 0x8000u;
+  uint32 mant = x & 0x007fffffu;
+  const int exp = static_cast<int>((x >> 23) & 0xffu);
+
+  if (exp == 0xff) // inf or NaN, keep NaNs quiet
+  {
+    return static_cast<std::tr1::uint16_t>(sign | 0x7c00u | (mant ? 0x200u | (mant >> 13) : 0u));
+  }
+  const int e = exp - 127 + 15;
+  if (e >= 0x1f) // overflow to inf
+  {
+    return static_cast<std::tr1::uint16_t>(sign | 0x7c00u);
+  }
+  if (e <= 0) // subnormal or zero
+  {
+    if (e < -10) return static_cast<std::tr1::uint16_t>(sign);
+    mant |= 0x00800000u;
+    const unsigned int shift = static_cast<unsigned int>(14 - e);
+    uint32 h = mant >> shift;
+    const uint32 rem = mant & ((1u << shift) - 1u);
+    const uint32 halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (h & 1u))) ++h;
+    return static_cast<std::tr1::uint16_t>(sign | h);
+  }
+  uint32 h = sign | (static_cast<uint32>(e) << 10) | (mant >> 13);
+  const uint32 rem = mant & 0x1fffu;
+  // a carry out of the mantissa correctly bumps the exponent
+  if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) ++h;
+  return static_cast<std::tr1::uint16_t>(h);
+}
+
+inline float half_bits_to_float(std::tr1::uint16_t h)
+{
+  typedef std::tr1::uint32_t uint32;
+  const uint32 sign = static_cast<uint32>(h & 0x8000u) << 16;
+  const uint32 exp = (h >> 10) & 0x1fu;
+  uint32 mant = h & 0x3ffu;
+  if (exp == 0)
+  {
+    if (mant == 0) return bits_float(sign);
+    // subnormal: normalise
+    int e = -14;
+    while (!(mant & 0x400u))
+    {
+      mant <<= 1;
+      --e;
+    }
+    mant &= 0x3ffu;
+    return bits_float(sign | (static_cast<uint32>(e + 127) << 23) | (mant << 13));
+  }
+  if (exp == 0x1f)
+  {
+    return bits_float(sign | 0x7f800000u | (mant << 13));
+  }
+  return bits_float(sign | ((exp - 15 + 127) << 23) | (mant << 13));
+}
+
+// float to bfloat16, round to nearest even
+inline std::tr1::uint16_t float_to_bfloat16_bits(float f)
+{
+  const std::tr1::uint32_t x = float_bits(f);
+  if ((x & 0x7f800000u) == 0x7f800000u && (x & 0x007fffffu))
+  {
+    return static_cast<std::tr1::uint16_t>((x >> 16) | 0x40u); // quiet NaN
+  }
+  const std::tr1::uint32_t rounding = 0x7fffu + ((x >> 16) & 1u);
+  return static_cast<std::tr1::uint16_t>((x + rounding) >> 16);
+}
+
+inline float bfloat16_bits_to_float(std::tr1::uint16_t b)
+{
+  return bits_float(static_cast<std::tr1::uint32_t>(b) << 16);
+}
+
+// Common interface of the 16 bit types. Derived supplies the conversions.
+template <typename Derived>
+class float16_base {
+
+ public:
+
+  typedef std::tr1::uint16_t bits_type;
+
+  operator float() const { return Derived::to_float(m_bits); }
+
+  Derived& operator+=(float rhs) { return assign(float(*this) + rhs); }
+  Derived& operator-=(float rhs) { return assign(float(*this) - rhs); }
+  Derived& operator*=(float rhs) { return assign(float(*this) * rhs); }
+  Derived& operator/=(float rhs) { return assign(float(*this) / rhs); }
+
+  bits_type bits() const { return m_bits; }
+
+ protected:
+
+  float16_base() : m_bits(0) {}
+  explicit float16_base(bits_type bits) : m_bits(bits) {}
+
+ private:
+
+  Derived& assign(float value)
+  {
+    m_bits = Derived::from_float(value);
+    return static_cast<Derived&>(*this);
+  }
+
+  bits_type m_bits;
+};
+
+} // namespace detail
+
+/// IEEE 754 binary16: 1 sign, 5 exponent and 10 mantissa bits.
+class half : public detail::float16_base<half> {
+
+ public:
+
+  half() {}
+  half(float value) : detail::float16_base<half>(from_float(value)) {}
+  explicit half(double value)
+  :
+  detail::float16_base<half>(from_float(static_cast<float>(value))) {}
+  explicit half(int value)
+  :
+  detail::float16_base<half>(from_float(static_cast<float>(value))) {}
+
+  explicit half(unsigned int value)
+  :
+  detail::float16_base<half>(from_float(static_cast<float>(value))) {}
+
+  static half from_bits(bits_type bits) { return half(bits, 0); }
+
+  static bits_type from_float(float value)
+  {
+    return detail::float_to_half_bits(value);
+  }
+  static float to_float(bits_type bits)
+  {
+    return detail::half_bits_to_float(bits);
+  }
+
+ private:
+  half(bits_type bits, int) : detail::float16_base<half>(bits) {}
+};
+
+/// bfloat16: 1 sign, 8 exponent and 7 mantissa bits. Same range as float.
+class bfloat16 : public detail::float16_base<bfloat16> {
+
+ public:
+
+  bfloat16() {}
+  bfloat16(float value) : detail::float16_base<bfloat16>(from_float(value)) {}
+  explicit bfloat16(double value)
+  :
+  detail::float16_base<bfloat16>(from_float(static_cast<float>(value))) {}
+  explicit bfloat16(int value)
+  :
+  detail::float16_base<bfloat16>(from_float(static_cast<float>(value))) {}
+
+  explicit bfloat16(unsigned int value)
+  :
+  detail::float16_base<bfloat16>(from_float(static_cast<float>(value))) {}
+
+  static bfloat16 from_bits(bits_type bits) { return bfloat16(bits, 0); }
+
+  static bits_type from_float(float value)
+  {
+    return detail::float_to_bfloat16_bits(value);
+  }
+  static float to_float(bits_type bits)
+  {
+    return detail::bfloat16_bits_to_float(bits);
+  }
+
+ private:
+  bfloat16(bits_type bits, int) : detail::float16_base<bfloat16>(bits) {}
+};
+
+inline half abs(half h) { return half::from_bits(static_cast<half::bits_type>(h.bits() & 0x7fffu)); }
+inline bfloat16 abs(bfloat16 b) { return bfloat16::from_bits(static_cast<bfloat16::bits_type>(b.bits() & 0x7fffu)); }
+
+inline half sqrt(half h) { return half(std::sqrt(float(h))); }
+inline bfloat16 sqrt(bfloat16 b) { return bfloat16(std::sqrt(float(b))); }
+
+inline std::ostream& operator<<(std::ostream& out, half h) { return out << float(h); }
+inline std::ostream& operator<<(std::ostream& out, bfloat16 b) { return out << float(b); }
+
+template <>
+struct is_numeric<half> : integral_constant<bool, true> {};
+template <>
+struct is_numeric<bfloat16> : integral_constant<bool, true> {};
+
+// ============================================================================
+// bulk conversions
+
+/// Convert n half values to float
+inline void to_float(const half* in, std::size_t n, float* out)
+{
+  std::size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8)
+  {
+    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; ++i) out[i] = float(in[i]);
+}
+
+/// Convert n float values to half, rounding to nearest even
+inline void from_float(const float* in, std::size_t n, half* out)
+{
+  std::size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8)
+  {
+    const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+  }
+#endif
+  for (; i < n; ++i) out[i] = half(in[i]);
+}
+
+/// Convert n bfloat16 values to float
+inline void to_float(const bfloat16* in, std::size_t n, float* out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = detail::bfloat16_bits_to_float(in[i].bits());
+  }
+}
+
+/// Convert n float values to bfloat16, rounding to nearest even
+inline void from_float(const float* in, std::size_t n, bfloat16* out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = bfloat16::from_bits(detail::float_to_bfloat16_bits(in[i]));
+  }
+}
+
+/// Convert n 16 bit points to float points
+template <typename F16>
+void to_float(const point3d<F16>* in, std::size_t n, point3d<float>* out)
+{
+  if (n == 0) return;
+  to_float(&in[0][0], 3*n, &out[0][0]);
+}
+
+/// Convert n float points to 16 bit points
+template <typename F16>
+void from_float(const point3d<float>* in, std::size_t n, point3d<F16>* out)
+{
+  if (n == 0) return;
+  from_float(&in[0][0], 3*n, &out[0][0]);
+}
+
+} // namespace minimath
+
+namespace std
+{
+
+template <>
+class numeric_limits<minimath::half> {
+ public:
+  static const bool is_specialized = true;
+  static const bool is_signed = true;
+  static const bool is_integer = false;
+  static const bool is_exact = false;
+  static const bool has_infinity = true;
+  static const bool has_quiet_NaN = true;
+  static const int radix = 2;
+  static const int digits = 11;
+  static minimath::half min() { return minimath::half::from_bits(0x0400u); }
+  static minimath::half max() { return minimath::half::from_bits(0x7bffu); }
+  static minimath::half lowest() { return minimath::half::from_bits(0xfbffu); }
+  static minimath::half epsilon() { return minimath::half::from_bits(0x1400u); }
+  static minimath::half infinity() { return minimath::half::from_bits(0x7c00u); }
+  static minimath::half quiet_NaN() { return minimath::half::from_bits(0x7e00u); }
+  static minimath::half denorm_min() { return minimath::half::from_bits(0x0001u); }
+};
+
+template <>
+class numeric_limits<minimath::bfloat16> {
+ public:
+  static const bool is_specialized = true;
+  static const bool is_signed = true;
+  static const bool is_integer = false;
+  static const bool is_exact = false;
+  static const bool has_infinity = true;
+  static const bool has_quiet_NaN = true;
+  static const int radix = 2;
+  static const int digits = 8;
+  static minimath::bfloat16 min() { return minimath::bfloat16::from_bits(0x0080u); }
+  static minimath::bfloat16 max() { return minimath::bfloat16::from_bits(0x7f7fu); }
+  static minimath::bfloat16 lowest() { return minimath::bfloat16::from_bits(0xff7fu); }
+  static minimath::bfloat16 epsilon() { return minimath::bfloat16::from_bits(0x3c00u); }
+  static minimath::bfloat16 infinity() { return minimath::bfloat16::from_bits(0x7f80u); }
+  static minimath::bfloat16 quiet_NaN() { return minimath::bfloat16::from_bits(0x7fc0u); }
+  static minimath::bfloat16 denorm_min() { return minimath::bfloat16::from_bits(0x0001u); }
+};
+
+} // namespace std
+
+#endif // MINIMATH_HALF_H_
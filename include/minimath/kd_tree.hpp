@@ -0,0 +1,475 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_KD_TREE_H_
+#define MINIMATH_KD_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "minimath/aligned_allocator.hpp"
+#include "minimath/point3d.hpp"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+//
+// Static k-d tree over a set of XYZ points, for nearest neighbour, radius
+// and box queries.
+//
+// The tree is implicit: node i has children 2i+1 and 2i+2, every split
+// halves the number of points of its node, and all leaves are at the
+// same depth and hold at most L points. Internal nodes only store
+// a split value and dimension; the points are reordered so that each leaf
+// is a contiguous run of x, y and z arrays, scanned with SSE for float.
+//
+// The tree is built one level at a time, the nodes of a level in parallel
+// when OpenMP is enabled. The batch queries process the queries in
+// parallel. Query results refer to points by their position in the range
+// the tree was built from.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+/// Query result: position of a point in the build range and its squared
+/// distance to the query point.
+template <typename T>
+struct kd_neighbour
+{
+  std::size_t index;
+  T dist2;
+
+  kd_neighbour() : index(0), dist2() {}
+  kd_neighbour(std::size_t index, T dist2) : index(index), dist2(dist2) {}
+
+  // by distance, then by index, so that results are deterministic
+  bool operator<(const kd_neighbour& rhs) const
+  {
+    return dist2 < rhs.dist2 || (!(rhs.dist2 < dist2) && index < rhs.index);
+  }
+};
+
+namespace detail
+{
+
+// Orders build range positions by one coordinate of their points
+template <typename T>
+struct kd_coordinate_less
+{
+  kd_coordinate_less(const T* coords) : m_coords(coords) {}
+  bool operator()(std::size_t a, std::size_t b) const { return m_coords[a] < m_coords[b]; }
+ private:
+  const T* m_coords;
+};
+
+// Identity id map: reports every point by its build range position
+struct kd_identity
+{
+  bool operator()(std::size_t index, std::size_t& id) const
+  {
+    id = index;
+    return true;
+  }
+};
+
+// Offer candidate to the max-heap of the k best neighbours in heap[0, count)
+template <typename Neighbour>
+void push_neighbour(Neighbour* heap, std::size_t& count, std::size_t k,
+                    const Neighbour& candidate)
+{
+  if (count < k)
+  {
+    heap[count++] = candidate;
+    std::push_heap(heap, heap + count);
+  }
+  else if (candidate < heap[0])
+  {
+    std::pop_heap(heap, heap + count);
+    heap[count - 1] = candidate;
+    std::push_heap(heap, heap + count);
+  }
+}
+
+// out[i] = squared distance from point i of x, y, z to q, i in [0, n)
+template <typename T>
+void leaf_dist2(const T* x, const T* y, const T* z, std::size_t n,
+                const point3d<T>& q, T* out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T dx = x[i] - q.x();
+    const T dy = y[i] - q.y();
+    const T dz = z[i] - q.z();
+    out[i] = dx*dx + dy*dy + dz*dz;
+  }
+}
+
+#if defined(__SSE__)
+
+inline void leaf_dist2(const float* x, const float* y, const float* z, std::size_t n,
+                       const point3d<float>& q, float* out)
+{
+  const __m128 qx = _mm_set1_ps(q.x());
+  const __m128 qy = _mm_set1_ps(q.y());
+  const __m128 qz = _mm_set1_ps(q.z());
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), qx);
+    const __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), qy);
+    const __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), qz);
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                      _mm_mul_ps(dz, dz)));
+  }
+  for (; i < n; ++i)
+  {
+    const float dx = x[i] - q.x();
+    const float dy = y[i] - q.y();
+    const float dz = z[i] - q.z();
+    out[i] = dx*dx + dy*dy + dz*dz;
+  }
+}
+
+#endif
+
+} // namespace detail
+
+template <typename T, unsigned int L = 16>
+class kd_tree {
+
+ public:
+
+  typedef T value_type;
+  typedef point3d<T> point_type;
+  typedef kd_neighbour<T> neighbour;
+  typedef std::size_t size_type;
+
+  /// Maximum number of points in a leaf.
+  static const unsigned int leaf_size = L;
+
+  kd_tree() : m_depth(0) {}
+
+  /// Build the tree over the points of [first, last).
+  template <typename InputIterator>
+  kd_tree(InputIterator first, InputIterator last) : m_depth(0)
+  {
+    build(first, last);
+  }
+
+  /// Rebuild the tree over the points of [first, last).
+  template <typename InputIterator>
+  void build(InputIterator first, InputIterator last)
+  {
+    array_type x, y, z;
+    for (; first != last; ++first)
+    {
+      x.push_back((*first).x());
+      y.push_back((*first).y());
+      z.push_back((*first).z());
+    }
+    build(x, y, z);
+  }
+
+  size_type size() const { return m_index.size(); }
+  bool empty() const { return m_index.empty(); }
+
+  /// Number of levels of internal nodes.
+  unsigned int depth() const { return m_depth; }
+
+  ///
+  /// The k nearest points to q, in increasing order of distance, written
+  /// to out, which must have room for k results. Return the number of
+  /// results, min(k, size()).
+  ///
+  template <typename P>
+  size_type nearest(const P& q, size_type k, neighbour* out) const
+  {
+    size_type count = 0;
+    merge_nearest(q, k, out, count, detail::kd_identity());
+    std::sort_heap(out, out + count);
+    return count;
+  }
+
+  ///
+  /// Append to out the points within distance r of q, in no particular
+  /// order. Return the number of points appended.
+  ///
+  template <typename P>
+  size_type radius(const P& q, T r, std::vector<neighbour>& out) const
+  {
+    return radius(q, r, out, detail::kd_identity());
+  }
+
+  ///
+  /// Append to out the indices of the points in the axis aligned box
+  /// [min, max], in no particular order. Return the number of points
+  /// appended.
+  ///
+  template <typename P>
+  size_type box(const P& min, const P& max, std::vector<size_type>& out) const
+  {
+    return box(min, max, out, detail::kd_identity());
+  }
+
+  ///
+  /// k nearest neighbours of each query point of [first, last), processed
+  /// in parallel. The results of query i go to out[i*k] and following,
+  /// and their number to counts[i].
+  ///
+  template <typename RandomAccessIterator>
+  void nearest(RandomAccessIterator first, RandomAccessIterator last, size_type k,
+               neighbour* out, size_type* counts) const
+  {
+    const long size = static_cast<long>(last - first);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      const size_type j = static_cast<size_type>(i);
+      counts[j] = nearest(first[i], k, out + j*k);
+    }
+  }
+
+  ///
+  /// Points within distance r of each query point of [first, last),
+  /// processed in parallel. out is resized to the number of queries and
+  /// out[i] holds the results of query i.
+  ///
+  template <typename RandomAccessIterator>
+  void radius(RandomAccessIterator first, RandomAccessIterator last, T r,
+              std::vector<std::vector<neighbour> >& out) const
+  {
+    const long size = static_cast<long>(last - first);
+    out.resize(static_cast<size_type>(size));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      std::vector<neighbour>& result = out[static_cast<size_type>(i)];
+      result.clear();
+      radius(first[i], r, result);
+    }
+  }
+
+  // ==========================================================================
+  // Queries through an id map, for indices built on top of several trees.
+  // ids(i, id) is called for each candidate with its build range position
+  // i. It returns false to skip the point, or sets the id to report it
+  // with and returns true.
+
+  ///
+  /// Merge the k nearest points to q into the max-heap of neighbours
+  /// heap[0, count), as kept by std::push_heap, updating count. heap must
+  /// have room for k entries, and may already hold results of other
+  /// trees, which then narrow the search.
+  ///
+  template <typename P, typename IdMap>
+  void merge_nearest(const P& q, size_type k, neighbour* heap, size_type& count,
+                     const IdMap& ids) const
+  {
+    if (k == 0 || empty()) return;
+    nearest(0, 0, size(), point_type(q.x(), q.y(), q.z()), k, heap, count, ids);
+  }
+
+  /// radius(q, r, out) reporting the points through ids.
+  template <typename P, typename IdMap>
+  size_type radius(const P& q, T r, std::vector<neighbour>& out, const IdMap& ids) const
+  {
+    const size_type n = out.size();
+    if (!empty()) radius(0, 0, size(), point_type(q.x(), q.y(), q.z()), r*r, out, ids);
+    return out.size() - n;
+  }
+
+  /// box(min, max, out) reporting the points through ids.
+  template <typename P, typename IdMap>
+  size_type box(const P& min, const P& max, std::vector<size_type>& out,
+                const IdMap& ids) const
+  {
+    const size_type n = out.size();
+    if (!empty())
+    {
+      box(0, 0, size(), point_type(min.x(), min.y(), min.z()),
+          point_type(max.x(), max.y(), max.z()), out, ids);
+    }
+    return out.size() - n;
+  }
+
+ private:
+
+  typedef std::vector<T, aligned_allocator<T> > array_type;
+
+  size_type internal_nodes() const { return m_split.size(); }
+
+  void build(const array_type& x, const array_type& y, const array_type& z)
+  {
+    const size_type n = x.size();
+    m_depth = 0;
+    for (size_type leaf = n; leaf > L; leaf = (leaf + 1)/2) ++m_depth;
+    const size_type nInternal = (size_type(1) << m_depth) - 1;
+    m_split.assign(nInternal, T());
+    m_dim.assign(nInternal, 0);
+    m_index.resize(n);
+    for (size_type i = 0; i < n; ++i) m_index[i] = i;
+    const T* coords[3] = { n ? &x[0] : 0, n ? &y[0] : 0, n ? &z[0] : 0 };
+
+    // bounds[j] to bounds[j+1] is the range of node j of the current level
+    std::vector<size_type> bounds(2);
+    bounds[1] = n;
+    for (unsigned int level = 0; level < m_depth; ++level)
+    {
+      const size_type firstNode = (size_type(1) << level) - 1;
+      const long nNodes = static_cast<long>(bounds.size() - 1);
+      std::vector<size_type> next(2*bounds.size() - 1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (long j = 0; j < nNodes; ++j)
+      {
+        const size_type uj = static_cast<size_type>(j);
+        const size_type begin = bounds[uj];
+        const size_type end = bounds[uj + 1];
+        const size_type mid = begin + (end - begin)/2;
+        const unsigned int d = widest_dimension(coords, begin, end);
+        std::nth_element(m_index.begin() + static_cast<std::ptrdiff_t>(begin),
+                         m_index.begin() + static_cast<std::ptrdiff_t>(mid),
+                         m_index.begin() + static_cast<std::ptrdiff_t>(end),
+                         detail::kd_coordinate_less<T>(coords[d]));
+        m_split[firstNode + uj] = coords[d][m_index[mid]];
+        m_dim[firstNode + uj] = static_cast<unsigned char>(d);
+        next[2*uj] = begin;
+        next[2*uj + 1] = mid;
+      }
+      next.back() = n;
+      bounds.swap(next);
+    }
+
+    m_x.resize(n);
+    m_y.resize(n);
+    m_z.resize(n);
+    for (size_type i = 0; i < n; ++i)
+    {
+      m_x[i] = x[m_index[i]];
+      m_y[i] = y[m_index[i]];
+      m_z[i] = z[m_index[i]];
+    }
+  }
+
+  unsigned int widest_dimension(const T* const coords[3], size_type begin, size_type end) const
+  {
+    unsigned int widest = 0;
+    T widestSpread = T();
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      T lo = coords[d][m_index[begin]];
+      T hi = lo;
+      for (size_type i = begin + 1; i < end; ++i)
+      {
+        const T c = coords[d][m_index[i]];
+        if (c < lo) lo = c;
+        if (hi < c) hi = c;
+      }
+      if (widestSpread < hi - lo)
+      {
+        widestSpread = hi - lo;
+        widest = d;
+      }
+    }
+    return widest;
+  }
+
+  template <typename IdMap>
+  void nearest(size_type node, size_type begin, size_type end, const point_type& q,
+               size_type k, neighbour* heap, size_type& count, const IdMap& ids) const
+  {
+    if (node >= internal_nodes())
+    {
+      T d2[L];
+      const size_type n = end - begin;
+      detail::leaf_dist2(&m_x[begin], &m_y[begin], &m_z[begin], n, q, d2);
+      for (size_type i = 0; i < n; ++i)
+      {
+        size_type id;
+        if (ids(m_index[begin + i], id)) detail::push_neighbour(heap, count, k, neighbour(id, d2[i]));
+      }
+      return;
+    }
+    const size_type mid = begin + (end - begin)/2;
+    const T diff = q[m_dim[node]] - m_split[node];
+    if (diff < T())
+    {
+      nearest(2*node + 1, begin, mid, q, k, heap, count, ids);
+      if (count < k || !(heap[0].dist2 < diff*diff)) nearest(2*node + 2, mid, end, q, k, heap, count, ids);
+    }
+    else
+    {
+      nearest(2*node + 2, mid, end, q, k, heap, count, ids);
+      if (count < k || !(heap[0].dist2 < diff*diff)) nearest(2*node + 1, begin, mid, q, k, heap, count, ids);
+    }
+  }
+
+  template <typename IdMap>
+  void radius(size_type node, size_type begin, size_type end, const point_type& q,
+              T r2, std::vector<neighbour>& out, const IdMap& ids) const
+  {
+    if (node >= internal_nodes())
+    {
+      T d2[L];
+      const size_type n = end - begin;
+      detail::leaf_dist2(&m_x[begin], &m_y[begin], &m_z[begin], n, q, d2);
+      for (size_type i = 0; i < n; ++i)
+      {
+        size_type id;
+        if (!(r2 < d2[i]) && ids(m_index[begin + i], id)) out.push_back(neighbour(id, d2[i]));
+      }
+      return;
+    }
+    const size_type mid = begin + (end - begin)/2;
+    const T diff = q[m_dim[node]] - m_split[node];
+    if (diff < T() || !(r2 < diff*diff)) radius(2*node + 1, begin, mid, q, r2, out, ids);
+    if (!(diff < T()) || !(r2 < diff*diff)) radius(2*node + 2, mid, end, q, r2, out, ids);
+  }
+
+  template <typename IdMap>
+  void box(size_type node, size_type begin, size_type end, const point_type& min,
+           const point_type& max, std::vector<size_type>& out, const IdMap& ids) const
+  {
+    if (node >= internal_nodes())
+    {
+      for (size_type i = begin; i < end; ++i)
+      {
+        if (!(m_x[i] < min.x()) && !(max.x() < m_x[i]) &&
+            !(m_y[i] < min.y()) && !(max.y() < m_y[i]) &&
+            !(m_z[i] < min.z()) && !(max.z() < m_z[i]))
+        {
+          size_type id;
+          if (ids(m_index[i], id)) out.push_back(id);
+        }
+      }
+      return;
+    }
+    const size_type mid = begin + (end - begin)/2;
+    const unsigned int d = m_dim[node];
+    if (!(m_split[node] < min[d])) box(2*node + 1, begin, mid, min, max, out, ids);
+    if (!(max[d] < m_split[node])) box(2*node + 2, mid, end, min, max, out, ids);
+  }
+
+  unsigned int m_depth;
+  std::vector<T> m_split;
+  std::vector<unsigned char> m_dim;
+  std::vector<size_type> m_index; // build range position of each point
+  array_type m_x, m_y, m_z;       // points in leaf order
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_KD_TREE_H_
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_LIE3D_H_
+#define MINIMATH_LIE3D_H_
+
+#include <cmath>
+#include <limits>
+#include <iterator>
+#include "minimath/point3d.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/translation3d.hpp"
+#include "minimath/transform3d.hpp"
+
+//
+// Exponential and logarithm maps for 3D rotations, SO(3), and rigid
+// transformations, SE(3).
+//
+// A rotation vector omega has the direction of the rotation axis and a
+// magnitude equal to the rotation angle in radians.
+// A twist is a 6x1 matrix: elements 0-2 hold the rotation vector omega,
+// elements 3-5 the translational part v.
+//
+// All maps are closed form. For small angles the trigonometric
+// coefficients are replaced by their Taylor expansions, which avoids
+// the cancellation in (1-cos)/theta^2 and friends.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// theta^2 below which Taylor expansions are used
+template <typename T>
+inline T small_angle2()
+{
+  return std::sqrt(std::numeric_limits<T>::epsilon());
+}
+
+// Coefficients of the SO(3) and SE(3) exponentials,
+// a = sin(t)/t, b = (1-cos(t))/t^2, c = (t-sin(t))/t^3
+template <typename T>
+void exp_coefficients(T theta2, T& a, T& b, T& c)
+{
+  if (theta2 < small_angle2<T>())
+  {
+    a = T(1) - theta2/T(6)*(T(1) - theta2/T(20));
+    b = T(0.5) - theta2/T(24)*(T(1) - theta2/T(30));
+    c = T(1)/T(6) - theta2/T(120)*(T(1) - theta2/T(42));
+    return;
+  }
+  const T theta = std::sqrt(theta2);
+  const T s = std::sin(theta);
+  const T co = std::cos(theta);
+  a = s/theta;
+  b = (T(1) - co)/theta2;
+  c = (theta - s)/(theta2*theta);
+}
+
+// I + p*K + q*K^2, with K the cross product matrix of w
+template <typename T>
+matrix<T,3,3> rodrigues(const point3d<T>& w, T p, T q)
+{
+  const T x = w.x();
+  const T y = w.y();
+  const T z = w.z();
+  const T xx = x*x, yy = y*y, zz = z*z;
+  const T xy = x*y, xz = x*z, yz = y*z;
+  matrix<T,3,3> m;
+  m(0,0) = T(1) - q*(yy + zz);
+  m(1,1) = T(1) - q*(xx + zz);
+  m(2,2) = T(1) - q*(xx + yy);
+  m(0,1) = q*xy - p*z;
+  m(1,0) = q*xy + p*z;
+  m(0,2) = q*xz + p*y;
+  m(2,0) = q*xz - p*y;
+  m(1,2) = q*yz - p*x;
+  m(2,1) = q*yz + p*x;
+  return m;
+}
+
+// rotation vector of a rotation matrix, given element access via (i,j)
+template <typename T, typename R>
+point3d<T> log_rotation(const R& rot)
+{
+  const T trace = rot(0,0) + rot(1,1) + rot(2,2);
+  T cosA = (trace - T(1))/T(2);
+  if (cosA > T(1)) cosA = T(1);
+  if (cosA < T(-1)) cosA = T(-1);
+
+  // vee(R - R^T) = 2 sin(theta) * axis
+  const point3d<T> skew(rot(2,1) - rot(1,2),
+                        rot(0,2) - rot(2,0),
+                        rot(1,0) - rot(0,1));
+
+  // atan2 is well conditioned over the whole range, unlike acos near pi
+  const T sinA = std::sqrt(mag2(skew))/T(2);
+  const T theta = std::atan2(sinA, cosA);
+
+  if (cosA > T(-0.9))
+  {
+    const T theta2 = theta*theta;
+    T factor; // theta / (2 sin(theta))
+    if (theta2 < small_angle2<T>())
+    {
+      factor = T(0.5) + theta2/T(12) + T(7)*theta2*theta2/T(720);
+    } else {
+      factor = theta/(T(2)*sinA);
+    }
+    return skew*factor;
+  }
+
+  // Close to pi sin(theta) vanishes, so recover the axis from the
+  // symmetric part instead: (R + R^T)/2 - cos(theta)*I = (1-cos)*a*a^T
+  const T oneMinusCos = T(1) - cosA;
+  unsigned int i = 0;
+  if (rot(1,1) > rot(i,i)) i = 1;
+  if (rot(2,2) > rot(i,i)) i = 2;
+  T axis[3];
+  axis[i] = std::sqrt((rot(i,i) - cosA)/oneMinusCos);
+  for (unsigned int j = 0; j < 3; ++j)
+  {
+    if (j == i) continue;
+    axis[j] = (rot(i,j) + rot(j,i))/(T(2)*oneMinusCos*axis[i]);
+  }
+  point3d<T> w(axis[0], axis[1], axis[2]);
+  if (dot(w, skew) < T()) w *= T(-1);
+  w.normalize();
+  return w*theta;
+}
+
+} // namespace detail
+
+///
+/// Rotation matrix exp([omega]x) for a rotation vector omega.
+///
+template <typename T>
+rotation3d<T> exp_so3(const point3d<T>& omega)
+{
+  T a, b, c;
+  detail::exp_coefficients(mag2(omega), a, b, c);
+  return rotation3d<T>(detail::rodrigues(omega, a, b));
+}
+
+///
+/// Rotation vector omega such that exp_so3(omega) == rot.
+/// The angle |omega| is in [0, pi].
+///
+template <typename T>
+point3d<T> log_so3(const rotation3d<T>& rot)
+{
+  return detail::log_rotation<T>(rot);
+}
+
+///
+/// Rigid transformation exp(xi) for a twist xi = (omega, v).
+///
+template <typename T>
+transform3d<T> exp_se3(const matrix<T,6,1>& xi)
+{
+  const point3d<T> w(xi[0], xi[1], xi[2]);
+  const point3d<T> v(xi[3], xi[4], xi[5]);
+  T a, b, c;
+  detail::exp_coefficients(mag2(w), a, b, c);
+  // translation is V*v, with V = I + b*K + c*K^2
+  const point3d<T> wxv = cross(w, v);
+  const point3d<T> t = v + wxv*b + cross(w, wxv)*c;
+  matrix<T,3,4> m;
+  const matrix<T,3,3> rot = detail::rodrigues(w, a, b);
+  for (unsigned int r = 0; r < 3; ++r)
+  {
+    for (unsigned int col = 0; col < 3; ++col)
+    {
+      m(r,col) = rot(r,col);
+    }
+    m(r,3) = t[r];
+  }
+  return transform3d<T>(m);
+}
+
+///
+/// Twist xi = (omega, v) such that exp_se3(xi) == trans.
+///
+template <typename T>
+matrix<T,6,1> log_se3(const transform3d<T>& trans)
+{
+  const rotation3d<T> rot = trans.rotation();
+  const translation3d<T> tr = trans.translation();
+  const point3d<T> t(tr[0], tr[1], tr[2]);
+  const point3d<T> w = detail::log_rotation<T>(rot);
+
+  // v = V^-1 * t, V^-1 = I - K/2 + d*K^2, d = (1 - a/(2b))/theta^2
+  const T theta2 = mag2(w);
+  T d;
+  if (theta2 < detail::small_angle2<T>())
+  {
+    d = T(1)/T(12) + theta2/T(720) + theta2*theta2/T(30240);
+  } else {
+    T a, b, c;
+    detail::exp_coefficients(theta2, a, b, c);
+    d = (T(1) - a/(T(2)*b))/theta2;
+  }
+  const point3d<T> wxt = cross(w, t);
+  const point3d<T> v = t - wxt*T(0.5) + cross(w, wxt)*d;
+
+  matrix<T,6,1> xi;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    xi[i] = w[i];
+    xi[i+3] = v[i];
+  }
+  return xi;
+}
+
+///
+/// Apply exp_se3 to a sequence of twists.
+///
+/// @param first : input iterator to the first matrix<T,6,1> twist
+/// @param last  : input iterator one past the last twist
+/// @param out   : output iterator accepting transform3d<T>
+/// @return      : output iterator one past the last written transformation
+///
+template <typename InputIt, typename OutputIt>
+OutputIt exp_se3(InputIt first, InputIt last, OutputIt out)
+{
+  for (; first != last; ++first, ++out)
+  {
+    *out = exp_se3(*first);
+  }
+  return out;
+}
+
+///
+/// Apply log_se3 to a sequence of transformations.
+///
+template <typename InputIt, typename OutputIt>
+OutputIt log_se3(InputIt first, InputIt last, OutputIt out)
+{
+  for (; first != last; ++first, ++out)
+  {
+    *out = log_se3(*first);
+  }
+  return out;
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_LIE3D_H_
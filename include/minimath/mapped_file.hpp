@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_MAPPED_FILE_H_
+#define MINIMATH_MAPPED_FILE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//
+// Read-only memory mapping of a whole file (POSIX).
+//
+// Sequential readers of large files can ask for pages ahead of use with
+// will_need, and release the pages they are done with.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+class mapped_file {
+
+ public:
+
+  mapped_file() : m_data(0), m_size(0) {}
+
+  explicit mapped_file(const char* path) : m_data(0), m_size(0)
+  {
+    open(path);
+  }
+
+  ~mapped_file() { close(); }
+
+  ///
+  /// Map the file at path. Any previous mapping is released.
+  /// Return false if the file cannot be opened or mapped.
+  /// An empty file maps successfully with data() == 0.
+  ///
+  bool open(const char* path)
+  {
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size != 0)
+    {
+      void* p = ::mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+      if (p == MAP_FAILED)
+      {
+        ::close(fd);
+        return false;
+      }
+      m_data = static_cast<const char*>(p);
+      m_size = size;
+    }
+    ::close(fd);
+    return true;
+  }
+
+  void close()
+  {
+    if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = 0;
+    m_size = 0;
+  }
+
+  bool is_open() const { return m_data != 0; }
+
+  const char* data() const { return m_data; }
+
+  std::size_t size() const { return m_size; }
+
+  ///
+  /// Hint that bytes [offset, offset + n) will be read soon, so that the
+  /// system reads them ahead while earlier bytes are being processed.
+  ///
+  void will_need(std::size_t offset, std::size_t n) const
+  {
+#ifdef MADV_WILLNEED
+    const std::size_t page = page_size();
+    const std::size_t begin = offset/page*page;
+    const std::size_t end = std::min(m_size, offset + n);
+    if (begin < end) ::madvise(const_cast<char*>(m_data) + begin, end - begin, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)n;
+#endif
+  }
+
+  ///
+  /// Drop the pages holding bytes [offset, offset + n) from memory, except
+  /// a partial last page. They are read from the file again if accessed
+  /// later. Releasing the bytes already processed bounds the memory used
+  /// by a sequential pass over a large file.
+  ///
+  void release(std::size_t offset, std::size_t n) const
+  {
+#ifdef MADV_DONTNEED
+    const std::size_t page = page_size();
+    const std::size_t begin = offset/page*page;
+    const std::size_t end = std::min(m_size, offset + n)/page*page;
+    if (begin < end) ::madvise(const_cast<char*>(m_data) + begin, end - begin, MADV_DONTNEED);
+#else
+    (void)offset;
+    (void)n;
+#endif
+  }
+
+ private:
+
+  static std::size_t page_size()
+  {
+    return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  }
+
+  mapped_file(const mapped_file&);
+  mapped_file& operator=(const mapped_file&);
+
+  const char* m_data;
+  std::size_t m_size;
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_MAPPED_FILE_H_
@@ -181,6 +181,20 @@ class matrix {
     return matrix(*this).invert(success);
   }
 
+  // invert the matrix. Return false if inversion fails.
+  // rcond is set to the reciprocal 1-norm condition number of the
+  // original matrix, or 0 if the inversion fails.
+  matrix& invert(bool& success, T& rcond)
+  {
+    return detail::invert_with_condition<T,N1,N2>(*this, success, rcond);
+  }
+
+  // return an inverse matrix and its reciprocal condition number
+  matrix inverse(bool& success, T& rcond) const
+  {
+    return matrix(*this).invert(success, rcond);
+  }
+
   const T* data() const { return m_data; }
 
   T* data() { return m_data; }
@@ -278,7 +292,7 @@ matrix<T,N1,N2> operator-(const matrix<T,N1,N2>& lhs,
 
 // addition
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator+(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 {
   matrix<T1,N1,N2> mat = lhs;
@@ -287,7 +301,7 @@ operator+(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 }
 
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator+(const T2& scalar, const matrix<T1,N1,N2>& rhs)
 {
   matrix<T1,N1,N2> mat = rhs;
@@ -296,7 +310,7 @@ operator+(const T2& scalar, const matrix<T1,N1,N2>& rhs)
 }
 // subtraction
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator-(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 
 {
@@ -306,7 +320,7 @@ operator-(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 }
 
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator-(const T2& scalar, const matrix<T1,N1,N2>& rhs)
 {
   matrix<T1,N1,N2> mat = matrix<T1,N1,N2>(scalar) - rhs;
@@ -314,7 +328,7 @@ operator-(const T2& scalar, const matrix<T1,N1,N2>& rhs)
 }
 // multiplication
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator*(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 {
   matrix<T1,N1,N2> mat = lhs;
@@ -323,7 +337,7 @@ operator*(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 }
 
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator*(const T2& scalar, const matrix<T1,N1,N2>& rhs)
 {
   return rhs * scalar;
@@ -331,7 +345,7 @@ operator*(const T2& scalar, const matrix<T1,N1,N2>& rhs)
 
 // division: only LHS matrix makes sense
 template <typename T1, unsigned int N1, unsigned int N2, typename T2>
-typename enable_if<is_arithmetic<T2>::value, matrix<T1, N1, N2> >::type
+typename enable_if<is_numeric<T2>::value, matrix<T1, N1, N2> >::type
 operator/(const matrix<T1,N1,N2>& lhs, const T2& scalar)
 {
   matrix<T1,N1,N2> mat = lhs;
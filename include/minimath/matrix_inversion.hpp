@@ -38,7 +38,7 @@ class matrix_invertor<T, 1, 1> {
       return mat;
   }
   success = true;
-  mat(0.0) = value_type(1)/mat(0,0);
+  mat(0,0) = value_type(1)/mat(0,0);
   return mat;
   }
 };
@@ -110,6 +110,48 @@ class matrix_invertor<T, 3, 3> {
 
 };
 
+// 1-norm (maximum absolute column sum) of a matrix
+template <typename M>
+typename M::value_type norm1(const M& mat)
+{
+  using std::abs;
+  typedef typename M::value_type value_type;
+  value_type norm = value_type();
+  for (unsigned int c = 0; c < mat.cols(); ++c)
+  {
+    value_type sum = value_type();
+    for (unsigned int r = 0; r < mat.rows(); ++r)
+    {
+      sum += abs(mat(r,c));
+    }
+    if (sum > norm) norm = sum;
+  }
+  return norm;
+}
+
+//
+// Invert a matrix and estimate its reciprocal condition number,
+// rcond = 1 / (||A||_1 * ||A^-1||_1).
+// The small invertors form the inverse explicitly, so the estimate is the
+// exact 1-norm reciprocal condition number and costs two column sums.
+// rcond is 0 if the inversion fails, and approaches 0 as the matrix becomes
+// ill-conditioned.
+//
+template <typename T, unsigned int N1, unsigned int N2, typename M>
+M& invert_with_condition(M& mat, bool& success, T& rcond)
+{
+  const T anorm = norm1(mat);
+  matrix_invertor<T,N1,N2>()(mat, success);
+  if (!success)
+  {
+    rcond = T();
+    return mat;
+  }
+  const T ainvnorm = norm1(mat);
+  rcond = (anorm > T() && ainvnorm > T()) ? T(1)/anorm/ainvnorm : T();
+  return mat;
+}
+
 } // detail
 } // minimath
 
@@ -12,6 +12,7 @@
 #include <limits>
 #include <algorithm>
 #include "minimath/numeric_utils.hpp"
+#include "minimath/matrix_solve.hpp"
 
 //
 // Some matrix-matrix operations
@@ -40,7 +41,7 @@ bool equal(const matrix<T,R,C>& lhs,
 {
   typedef typename matrix<T,R,C>::value_type value_type;
   const value_type epsilon = std::numeric_limits<value_type>::epsilon();
-  CompareWithTolerance<value_type> comp(nEpsilons*epsilon); 
+  CompareWithTolerance<value_type> comp(static_cast<value_type>(nEpsilons)*epsilon); 
   return std::equal(lhs.begin(), lhs.end(), rhs.begin(), comp);
 }
 
@@ -117,11 +118,22 @@ void setColumn(minimath::matrix<T,R,C>& m,
   }
 }
 
+///
+/// Left inverse (A^T*A)^-1 * A^T of an N1xN2 matrix A, N1>=N2.
+/// The normal equations are solved by Cholesky factorisation, in full or
+/// mixed precision.
+///
 template <typename T, unsigned int N1, unsigned int N2>
-matrix<T,N2,N1> left_inverse(const matrix<T,N1,N2>& mat, bool& success)
+matrix<T,N2,N1> left_inverse(const matrix<T,N1,N2>& mat,
+                             bool& success,
+                             solve_precision precision = full_precision)
 {
   matrix<T,N2,N1> matT = mat.transpose();
-  return ((matT*mat).inverse(success)) * matT;
+  if (precision == mixed_precision)
+  {
+    return solve_spd_mixed<float>(matT*mat, matT, success);
+  }
+  return solve_spd(matT*mat, matT, success);
 }
 
 ///
@@ -132,9 +144,14 @@ matrix<T,N2,N1> left_inverse(const matrix<T,N1,N2>& mat, bool& success)
 template <typename T, unsigned int N>
 matrix<T,N> transformation(matrix<T,N> lhs, 
                            const matrix<T,N>& rhs,
-                           bool& success)
+                           bool& success,
+                           solve_precision precision = full_precision)
 {
-  return rhs*(lhs.inverse(success)); 
+  if (precision == mixed_precision)
+  {
+    return solve_right_mixed<float>(lhs, rhs, success);
+  }
+  return solve_right(lhs, rhs, success);
 }
 
 ///
@@ -145,9 +162,10 @@ matrix<T,N> transformation(matrix<T,N> lhs,
 template <typename T, unsigned int N1, unsigned int N2>
 matrix<T, N2, N1> transformation(const matrix<T, N1, N2>& ref,
                                  const matrix<T, N2, N2>& meas,
-                                 bool& success)
+                                 bool& success,
+                                 solve_precision precision = full_precision)
 {
-  return meas*minimath::left_inverse(ref, success);
+  return meas*minimath::left_inverse(ref, success, precision);
 }
 
 
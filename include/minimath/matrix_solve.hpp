@@ -0,0 +1,407 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_MATRIXSOLVE_H_
+#define MINIMATH_MATRIXSOLVE_H_
+
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include "minimath/numeric_utils.hpp"
+#include "minimath/matrix.hpp"
+
+//
+// Solution of linear systems A*X = B and X*A = B for small, statically
+// sized matrices, using LU or Cholesky factorisations and forward/back
+// substitution. No inverse is formed.
+//
+// As with matrix inversion, a system is considered singular if a pivot
+// is within one epsilon of zero. In that case success is set to false and
+// a zero matrix is returned.
+//
+// The mixed precision solvers factorise in a lower precision type, usually
+// float, and recover the accuracy of the working type by iterative
+// refinement, with residuals computed in the working type.
+//
+
+namespace minimath {
+
+namespace detail {
+
+template <typename T>
+bool is_zero_pivot(const T& pivot)
+{
+  return compare_with_tolerance(pivot, T(), std::numeric_limits<T>::epsilon());
+}
+
+///
+/// In-place LU factorisation with partial pivoting, P*A = L*U.
+/// L has a unit diagonal and is stored below the diagonal of lu,
+/// U is stored on and above the diagonal.
+/// perm[i] holds the row of A that ended up in row i.
+///
+template <typename T, unsigned int N>
+bool lu_decompose(matrix<T,N,N>& lu, unsigned int (&perm)[N])
+{
+  using std::abs;
+  for (unsigned int i = 0; i < N; ++i) perm[i] = i;
+
+  for (unsigned int k = 0; k < N; ++k)
+  {
+    unsigned int p = k;
+    T maxAbs = abs(lu(k,k));
+    for (unsigned int r = k+1; r < N; ++r)
+    {
+      const T a = abs(lu(r,k));
+      if (a > maxAbs)
+      {
+        maxAbs = a;
+        p = r;
+      }
+    }
+    if (is_zero_pivot(maxAbs)) return false;
+    if (p != k)
+    {
+      std::swap(perm[k], perm[p]);
+      std::swap_ranges(&lu(k,0), &lu(k,0)+N, &lu(p,0));
+    }
+    const T pivot = lu(k,k);
+    for (unsigned int r = k+1; r < N; ++r)
+    {
+      const T factor = lu(r,k) / pivot;
+      lu(r,k) = factor;
+      for (unsigned int c = k+1; c < N; ++c)
+      {
+        lu(r,c) -= factor * lu(k,c);
+      }
+    }
+  }
+  return true;
+}
+
+///
+/// Solve A*X = B in place, given the LU factorisation of A.
+/// On entry x holds B, on exit it holds X.
+///
+template <typename T, unsigned int N, unsigned int C>
+void lu_substitute(const matrix<T,N,N>& lu,
+                   const unsigned int (&perm)[N],
+                   matrix<T,N,C>& x)
+{
+  matrix<T,N,C> b = x;
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    std::copy(&b(perm[i],0), &b(perm[i],0)+C, &x(i,0));
+  }
+  // forward substitution with unit lower triangle
+  for (unsigned int i = 1; i < N; ++i)
+  {
+    for (unsigned int k = 0; k < i; ++k)
+    {
+      const T l = lu(i,k);
+      for (unsigned int c = 0; c < C; ++c) x(i,c) -= l * x(k,c);
+    }
+  }
+  // back substitution with upper triangle
+  for (unsigned int ii = N; ii > 0; --ii)
+  {
+    const unsigned int i = ii - 1;
+    for (unsigned int k = i+1; k < N; ++k)
+    {
+      const T u = lu(i,k);
+      for (unsigned int c = 0; c < C; ++c) x(i,c) -= u * x(k,c);
+    }
+    const T d = lu(i,i);
+    for (unsigned int c = 0; c < C; ++c) x(i,c) /= d;
+  }
+}
+
+///
+/// In-place Cholesky factorisation A = L*L^T of a symmetric positive
+/// definite matrix. Only the lower triangle of A is read. On exit the lower
+/// triangle holds L and the strict upper triangle is zero.
+///
+template <typename T, unsigned int N>
+bool cholesky_decompose(matrix<T,N,N>& l)
+{
+  using std::sqrt;
+  for (unsigned int j = 0; j < N; ++j)
+  {
+    T d = l(j,j);
+    for (unsigned int k = 0; k < j; ++k) d -= l(j,k)*l(j,k);
+    if (d < T() || is_zero_pivot(d)) return false;
+    d = sqrt(d);
+    l(j,j) = d;
+    for (unsigned int i = j+1; i < N; ++i)
+    {
+      T s = l(i,j);
+      for (unsigned int k = 0; k < j; ++k) s -= l(i,k)*l(j,k);
+      l(i,j) = s / d;
+      l(j,i) = T();
+    }
+  }
+  return true;
+}
+
+///
+/// Solve A*X = B in place, given the Cholesky factor L of A.
+/// On entry x holds B, on exit it holds X.
+///
+template <typename T, unsigned int N, unsigned int C>
+void cholesky_substitute(const matrix<T,N,N>& l, matrix<T,N,C>& x)
+{
+  // L*Y = B
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    for (unsigned int k = 0; k < i; ++k)
+    {
+      const T lik = l(i,k);
+      for (unsigned int c = 0; c < C; ++c) x(i,c) -= lik * x(k,c);
+    }
+    const T d = l(i,i);
+    for (unsigned int c = 0; c < C; ++c) x(i,c) /= d;
+  }
+  // L^T*X = Y
+  for (unsigned int ii = N; ii > 0; --ii)
+  {
+    const unsigned int i = ii - 1;
+    for (unsigned int k = i+1; k < N; ++k)
+    {
+      const T lki = l(k,i);
+      for (unsigned int c = 0; c < C; ++c) x(i,c) -= lki * x(k,c);
+    }
+    const T d = l(i,i);
+    for (unsigned int c = 0; c < C; ++c) x(i,c) /= d;
+  }
+}
+
+// element-wise conversion between matrix value types
+template <typename T1, typename T2, unsigned int R, unsigned int C>
+void convert(const matrix<T2,R,C>& from, matrix<T1,R,C>& to)
+{
+  for (unsigned int i = 0; i < to.size(); ++i)
+  {
+    to[i] = static_cast<T1>(from[i]);
+  }
+}
+
+// Iterative refinement of the solution x of A*X = B. The factorisation of
+// A, in precision TLow, is applied by the Substitute functor.
+template <typename TLow, typename T, unsigned int N, unsigned int C,
+          typename Substitute>
+void refine(const matrix<T,N,N>& A,
+            const matrix<T,N,C>& B,
+            matrix<T,N,C>& x,
+            unsigned int nSteps,
+            Substitute substitute)
+{
+  matrix<TLow,N,C> xLow;
+  convert(B, xLow);
+  substitute(xLow);
+  convert(xLow, x);
+  for (unsigned int step = 0; step < nSteps; ++step)
+  {
+    convert(B - A*x, xLow);
+    substitute(xLow);
+    matrix<T,N,C> correction;
+    convert(xLow, correction);
+    x += correction;
+  }
+}
+
+template <typename T, unsigned int N>
+struct lu_substitutor
+{
+  lu_substitutor(const matrix<T,N,N>& lu_, const unsigned int (&perm_)[N])
+  : lu(lu_), perm(perm_) {}
+  template <unsigned int C>
+  void operator()(matrix<T,N,C>& x) const { lu_substitute(lu, perm, x); }
+  const matrix<T,N,N>& lu;
+  const unsigned int (&perm)[N];
+};
+
+template <typename T, unsigned int N>
+struct cholesky_substitutor
+{
+  explicit cholesky_substitutor(const matrix<T,N,N>& l_) : l(l_) {}
+  template <unsigned int C>
+  void operator()(matrix<T,N,C>& x) const { cholesky_substitute(l, x); }
+  const matrix<T,N,N>& l;
+};
+
+} // namespace detail
+
+/// Precision used to solve the systems in left_inverse and transformation.
+enum solve_precision
+{
+  full_precision,   ///< factorise and solve in the matrix value type
+  mixed_precision   ///< factorise in float, refine in the matrix value type
+};
+
+///
+/// Solve L*X = B where L is lower triangular.
+/// Elements above the diagonal of L are ignored.
+///
+template <typename T, unsigned int N, unsigned int C>
+matrix<T,N,C> solve_lower_triangular(const matrix<T,N,N>& L,
+                                     const matrix<T,N,C>& B,
+                                     bool& success)
+{
+  matrix<T,N,C> x = B;
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    if (detail::is_zero_pivot(L(i,i)))
+    {
+      success = false;
+      return zero_matrix();
+    }
+    for (unsigned int k = 0; k < i; ++k)
+    {
+      for (unsigned int c = 0; c < C; ++c) x(i,c) -= L(i,k) * x(k,c);
+    }
+    for (unsigned int c = 0; c < C; ++c) x(i,c) /= L(i,i);
+  }
+  success = true;
+  return x;
+}
+
+///
+/// Solve U*X = B where U is upper triangular.
+/// Elements below the diagonal of U are ignored.
+///
+template <typename T, unsigned int N, unsigned int C>
+matrix<T,N,C> solve_upper_triangular(const matrix<T,N,N>& U,
+                                     const matrix<T,N,C>& B,
+                                     bool& success)
+{
+  matrix<T,N,C> x = B;
+  for (unsigned int ii = N; ii > 0; --ii)
+  {
+    const unsigned int i = ii - 1;
+    if (detail::is_zero_pivot(U(i,i)))
+    {
+      success = false;
+      return zero_matrix();
+    }
+    for (unsigned int k = i+1; k < N; ++k)
+    {
+      for (unsigned int c = 0; c < C; ++c) x(i,c) -= U(i,k) * x(k,c);
+    }
+    for (unsigned int c = 0; c < C; ++c) x(i,c) /= U(i,i);
+  }
+  success = true;
+  return x;
+}
+
+///
+/// Solve A*X = B for a general square matrix A,
+/// using LU factorisation with partial pivoting.
+///
+template <typename T, unsigned int N, unsigned int C>
+matrix<T,N,C> solve(const matrix<T,N,N>& A,
+                    const matrix<T,N,C>& B,
+                    bool& success)
+{
+  matrix<T,N,N> lu = A;
+  unsigned int perm[N];
+  success = detail::lu_decompose(lu, perm);
+  if (!success) return zero_matrix();
+  matrix<T,N,C> x = B;
+  detail::lu_substitute(lu, perm, x);
+  return x;
+}
+
+///
+/// Solve A*X = B for a symmetric positive definite matrix A,
+/// using Cholesky factorisation. Only the lower triangle of A is read.
+/// Fails if A is not positive definite.
+///
+template <typename T, unsigned int N, unsigned int C>
+matrix<T,N,C> solve_spd(const matrix<T,N,N>& A,
+                        const matrix<T,N,C>& B,
+                        bool& success)
+{
+  matrix<T,N,N> l = A;
+  success = detail::cholesky_decompose(l);
+  if (!success) return zero_matrix();
+  matrix<T,N,C> x = B;
+  detail::cholesky_substitute(l, x);
+  return x;
+}
+
+///
+/// Solve X*A = B for a general square matrix A.
+/// Equivalent to B*A^-1, without forming the inverse.
+///
+template <typename T, unsigned int N, unsigned int R>
+matrix<T,R,N> solve_right(const matrix<T,N,N>& A,
+                          const matrix<T,R,N>& B,
+                          bool& success)
+{
+  return solve(A.transpose(), B.transpose(), success).transpose();
+}
+
+///
+/// Solve A*X = B by LU factorisation in precision TLow, followed by
+/// nSteps iterative refinement steps with residuals computed in T.
+/// Fails if A is singular in precision TLow.
+///
+template <typename TLow, typename T, unsigned int N, unsigned int C>
+matrix<T,N,C> solve_mixed(const matrix<T,N,N>& A,
+                          const matrix<T,N,C>& B,
+                          bool& success,
+                          unsigned int nSteps = 2)
+{
+  matrix<TLow,N,N> lu;
+  detail::convert(A, lu);
+  unsigned int perm[N];
+  success = detail::lu_decompose(lu, perm);
+  if (!success) return zero_matrix();
+  matrix<T,N,C> x;
+  detail::refine<TLow>(A, B, x, nSteps,
+                       detail::lu_substitutor<TLow,N>(lu, perm));
+  return x;
+}
+
+///
+/// Solve A*X = B for a symmetric positive definite A by Cholesky
+/// factorisation in precision TLow, followed by nSteps iterative refinement
+/// steps with residuals computed in T.
+///
+template <typename TLow, typename T, unsigned int N, unsigned int C>
+matrix<T,N,C> solve_spd_mixed(const matrix<T,N,N>& A,
+                              const matrix<T,N,C>& B,
+                              bool& success,
+                              unsigned int nSteps = 2)
+{
+  matrix<TLow,N,N> l;
+  detail::convert(A, l);
+  success = detail::cholesky_decompose(l);
+  if (!success) return zero_matrix();
+  matrix<T,N,C> x;
+  detail::refine<TLow>(A, B, x, nSteps,
+                       detail::cholesky_substitutor<TLow,N>(l));
+  return x;
+}
+
+///
+/// Solve X*A = B by LU factorisation in precision TLow and iterative
+/// refinement in T.
+///
+template <typename TLow, typename T, unsigned int N, unsigned int R>
+matrix<T,R,N> solve_right_mixed(const matrix<T,N,N>& A,
+                                const matrix<T,R,N>& B,
+                                bool& success,
+                                unsigned int nSteps = 2)
+{
+  return solve_mixed<TLow>(A.transpose(), B.transpose(), success, nSteps).transpose();
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_MATRIXSOLVE_H_
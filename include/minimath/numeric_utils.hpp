@@ -38,14 +38,14 @@ struct CompareWithTolerance
   T tol_;
 };
 
-/// comparison within tolerance for arithmetic types
+/// comparison within tolerance for arithmetic and other numeric types
 template <typename T>
-typename enable_if<is_arithmetic<T>::value, bool>::type
+typename enable_if<is_numeric<T>::value, bool>::type
 equal(const T& lhs,
       const T& rhs,
       unsigned int nEpsilons = 0)
 {
-  T eps = std::numeric_limits<T>::epsilon() * nEpsilons;
+  T eps = std::numeric_limits<T>::epsilon() * static_cast<T>(nEpsilons);
   return compare_with_tolerance(lhs, rhs, eps);
 }
 
@@ -0,0 +1,343 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_OCTREE_H_
+#define MINIMATH_OCTREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/space_filling_curves.hpp"
+
+//
+// Linear octree over a set of XYZ points, for multi-resolution access to
+// large clouds.
+//
+// The points are quantised to a 2^21 grid over the bounding cube of the
+// cloud and sorted by Morton key, so that the points of every octree
+// cell are a contiguous range. Nodes are stored in an array in breadth
+// first order, the children of a node next to each other, and refer to
+// points and children by index. Each node holds the number of points in
+// its cell and their centroid, which stands for them at coarse levels of
+// detail.
+//
+// A cell with more than leaf_size points is split, down to 21 levels.
+// Chains of single children are bounded by the depth, so the number of
+// nodes grows linearly with the number of points.
+//
+// Keys are computed and radix sorted, and each level of nodes built and
+// summarised, in parallel when OpenMP is enabled.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+template <typename T>
+struct octree_node
+{
+  point3d<T> centroid;     // of the points in the cell
+  std::size_t first;       // first point, in Morton order
+  std::size_t count;       // number of points
+  std::size_t child;       // first child, if any
+  unsigned int cell[3];    // cell coordinates at this level
+  unsigned char children;  // number of children, 0 for a leaf
+  unsigned char level;     // 0 for the root
+};
+
+template <typename T>
+class linear_octree {
+
+ public:
+
+  typedef T value_type;
+  typedef point3d<T> point_type;
+  typedef octree_node<T> node_type;
+  typedef std::size_t size_type;
+
+  /// Number of levels below the root.
+  static const unsigned int max_depth = 21;
+
+  linear_octree() : m_edge(1) {}
+
+  /// Build an octree over the points of [first, last).
+  template <typename InputIterator>
+  linear_octree(InputIterator first, InputIterator last, size_type leaf_size = 32)
+  :
+  m_edge(1)
+  {
+    build(first, last, leaf_size);
+  }
+
+  ///
+  /// Rebuild the octree over the points of [first, last), splitting cells
+  /// of more than leaf_size points.
+  ///
+  template <typename InputIterator>
+  void build(InputIterator first, InputIterator last, size_type leaf_size = 32)
+  {
+    std::vector<point_type> points;
+    for (; first != last; ++first) points.push_back(point_type((*first).x(), (*first).y(), (*first).z()));
+    build(points, leaf_size);
+  }
+
+  size_type size() const { return m_points.size(); }
+  bool empty() const { return m_points.empty(); }
+
+  /// Number of nodes. Node 0 is the root.
+  size_type nodes() const { return m_nodes.size(); }
+  const node_type& node(size_type i) const { return m_nodes[i]; }
+
+  /// Number of levels holding nodes.
+  unsigned int levels() const { return static_cast<unsigned int>(m_levels.size()) - 1; }
+
+  /// Nodes of level l are [level_begin(l), level_begin(l + 1)).
+  size_type level_begin(unsigned int l) const { return m_levels[l]; }
+
+  /// Point i in Morton order, and its position in the build range.
+  const point_type& point(size_type i) const { return m_points[i]; }
+  size_type index(size_type i) const { return m_index[i]; }
+
+  /// Minimum corner and edge of the root cell.
+  const point_type& origin() const { return m_origin; }
+  T edge() const { return m_edge; }
+
+  /// Edge of the cell of node i.
+  T edge(size_type i) const
+  {
+    return m_edge/static_cast<T>(std::tr1::uint32_t(1) << m_nodes[i].level);
+  }
+
+  /// Centre of the cell of node i.
+  point_type cell_center(size_type i) const
+  {
+    const T e = edge(i);
+    const node_type& n = m_nodes[i];
+    return point_type(m_origin.x() + (static_cast<T>(n.cell[0]) + T(0.5))*e,
+                      m_origin.y() + (static_cast<T>(n.cell[1]) + T(0.5))*e,
+                      m_origin.z() + (static_cast<T>(n.cell[2]) + T(0.5))*e);
+  }
+
+  ///
+  /// Level of detail cut. Starting from the root, descend into the children
+  /// of the nodes for which refine(*this, i) returns true, and append to
+  /// out the nodes where the descent stops, either leaves or nodes that
+  /// need no refinement. The cells of the nodes of out partition the cloud.
+  ///
+  template <typename Refine>
+  void lod(const Refine& refine, std::vector<size_type>& out) const
+  {
+    if (m_nodes.empty()) return;
+    std::vector<size_type> stack(1, 0);
+    while (!stack.empty())
+    {
+      const size_type i = stack.back();
+      stack.pop_back();
+      const node_type& n = m_nodes[i];
+      if (n.children == 0 || !refine(*this, i))
+      {
+        out.push_back(i);
+        continue;
+      }
+      for (size_type c = n.children; c-- > 0; ) stack.push_back(n.child + c);
+    }
+  }
+
+  /// Level of detail cut with cells no larger than max_edge.
+  void lod(T max_edge, std::vector<size_type>& out) const
+  {
+    lod(size_refine(max_edge), out);
+  }
+
+  ///
+  /// Level of detail cut for a viewer at eye: cells are refined while
+  /// their edge exceeds ratio times their distance to the eye, so that
+  /// their angular size, and the screen space error, stays bounded.
+  ///
+  template <typename P>
+  void lod(const P& eye, T ratio, std::vector<size_type>& out) const
+  {
+    lod(distance_refine(point_type(eye.x(), eye.y(), eye.z()), ratio), out);
+  }
+
+ private:
+
+  struct size_refine
+  {
+    size_refine(T max_edge) : m_max(max_edge) {}
+    bool operator()(const linear_octree& tree, size_type i) const { return m_max < tree.edge(i); }
+    T m_max;
+  };
+
+  struct distance_refine
+  {
+    distance_refine(const point_type& eye, T ratio) : m_eye(eye), m_ratio2(ratio*ratio) {}
+    bool operator()(const linear_octree& tree, size_type i) const
+    {
+      const T e = tree.edge(i);
+      return m_ratio2*dist2(m_eye, tree.cell_center(i)) < e*e;
+    }
+    point_type m_eye;
+    T m_ratio2;
+  };
+
+  // octant of key at level l + 1
+  static unsigned int octant(std::tr1::uint64_t key, unsigned int l)
+  {
+    return static_cast<unsigned int>(key >> 3*(max_depth - 1 - l)) & 7u;
+  }
+
+  void build(const std::vector<point_type>& points, size_type leaf_size)
+  {
+    const size_type n = points.size();
+    m_nodes.clear();
+    m_levels.assign(1, 0);
+    m_points.resize(n);
+    m_index.resize(n);
+    if (n == 0) return;
+
+    // bounding cube
+    point_type lo, hi;
+    detail::bounds(points.begin(), n, lo, hi);
+    m_origin = lo;
+    m_edge = std::max(hi.x() - lo.x(), std::max(hi.y() - lo.y(), hi.z() - lo.z()));
+    if (!(T() < m_edge)) m_edge = T(1);
+
+    // keys
+    const T cells = static_cast<T>(std::tr1::uint32_t(1) << max_depth);
+    const T scale = cells/m_edge;
+    const std::tr1::uint32_t maxCell = (std::tr1::uint32_t(1) << max_depth) - 1;
+    std::vector<std::tr1::uint64_t> keys(n);
+    const long size = static_cast<long>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      const size_type u = static_cast<size_type>(i);
+      std::tr1::uint32_t c[3];
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        const T q = (points[u][d] - m_origin[d])*scale;
+        c[d] = q < cells ? static_cast<std::tr1::uint32_t>(q) : maxCell;
+      }
+      keys[u] = morton_encode63(c[0], c[1], c[2]);
+    }
+    radix_sort_permutation(&keys[0], n, &m_index[0]);
+    reorder(&m_index[0], n, &keys[0]);
+    for (size_type i = 0; i < n; ++i) m_points[i] = points[m_index[i]];
+
+    // nodes, one level at a time
+    node_type root = node_type();
+    root.count = n;
+    m_nodes.push_back(root);
+    for (unsigned int l = 0; ; ++l)
+    {
+      const size_type begin = m_levels[l];
+      const size_type end = m_nodes.size();
+      m_levels.push_back(end);
+      const long nNodes = static_cast<long>(end - begin);
+      // count the children of each node
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (long j = 0; j < nNodes; ++j)
+      {
+        node_type& node = m_nodes[begin + static_cast<size_type>(j)];
+        node.children = 0;
+        if (node.count <= leaf_size || l == max_depth) continue;
+        unsigned int last = 8;
+        for (size_type i = node.first; i < node.first + node.count; ++i)
+        {
+          const unsigned int o = octant(keys[i], l);
+          if (o != last) ++node.children;
+          last = o;
+        }
+      }
+      size_type next = end;
+      for (size_type j = begin; j < end; ++j)
+      {
+        m_nodes[j].child = next;
+        next += m_nodes[j].children;
+      }
+      if (next == end) break;
+      m_nodes.resize(next);
+      // fill them in
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (long j = 0; j < nNodes; ++j)
+      {
+        const node_type& node = m_nodes[begin + static_cast<size_type>(j)];
+        if (node.children == 0) continue;
+        size_type c = node.child;
+        for (size_type i = node.first; i < node.first + node.count; )
+        {
+          const unsigned int o = octant(keys[i], l);
+          size_type k = i + 1;
+          while (k < node.first + node.count && octant(keys[k], l) == o) ++k;
+          node_type& child = m_nodes[c++];
+          child = node_type();
+          child.first = i;
+          child.count = k - i;
+          child.level = static_cast<unsigned char>(l + 1);
+          std::tr1::uint32_t x, y, z;
+          morton_decode63(keys[i] >> 3*(max_depth - 1 - l), x, y, z);
+          child.cell[0] = x;
+          child.cell[1] = y;
+          child.cell[2] = z;
+          i = k;
+        }
+      }
+    }
+
+    // centroids, bottom up
+    for (size_type l = m_levels.size() - 1; l-- > 0; )
+    {
+      const size_type begin = m_levels[l];
+      const long nNodes = static_cast<long>(m_levels[l + 1] - begin);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (long j = 0; j < nNodes; ++j)
+      {
+        node_type& node = m_nodes[begin + static_cast<size_type>(j)];
+        point_type sum;
+        if (node.children == 0)
+        {
+          for (size_type i = node.first; i < node.first + node.count; ++i) sum += m_points[i];
+        }
+        else
+        {
+          for (size_type c = node.child; c < node.child + node.children; ++c)
+          {
+            point_type weighted = m_nodes[c].centroid;
+            weighted *= static_cast<T>(m_nodes[c].count);
+            sum += weighted;
+          }
+        }
+        sum /= static_cast<T>(node.count);
+        node.centroid = sum;
+      }
+    }
+  }
+
+  std::vector<node_type> m_nodes;
+  std::vector<size_type> m_levels; // first node of each level, plus the end
+  std::vector<point_type> m_points; // points in Morton order
+  std::vector<size_type> m_index;   // build range position of each point
+  point_type m_origin;
+  T m_edge;
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_OCTREE_H_
@@ -0,0 +1,349 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT3D4_H_
+#define MINIMATH_POINT3D4_H_
+
+#include <cmath>
+#include <ostream>
+#include "minimath/type_traits.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/geom3d_ops.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//
+// 3D point padded to four lanes, x, y, z and w, and aligned to its size:
+// 16 bytes for float, 32 for double. A point fills exactly one SSE (float)
+// or AVX (double) register and never straddles a cache line.
+//
+// The w lane is not part of the point: it is carried through unchanged by
+// transformations and ignored by comparisons and the functions of
+// point3d_ops.hpp. It can be used as padding or to hold an attribute.
+//
+// Containers of point3d4<double> need an allocator honouring the 32 byte
+// alignment, such as aligned_allocator.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+#if defined(__GNUC__)
+#define MINIMATH_ALIGNED(N) __attribute__((aligned(N)))
+#elif defined(_MSC_VER)
+#define MINIMATH_ALIGNED(N) __declspec(align(N))
+#else
+#define MINIMATH_ALIGNED(N)
+#endif
+
+namespace minimath {
+
+template <typename T>
+class MINIMATH_ALIGNED(4*sizeof(T)) point3d4 {
+
+ public :
+
+  typedef T scalar_type;
+  typedef T value_type;
+
+  point3d4() : data_() {}
+
+  point3d4(T x, T y, T z, T w = T())
+  {
+    data_[0] = x;
+    data_[1] = y;
+    data_[2] = z;
+    data_[3] = w;
+  }
+
+  template <typename P>
+  point3d4(const P& rhs)
+  {
+    data_[0] = rhs.x();
+    data_[1] = rhs.y();
+    data_[2] = rhs.z();
+    data_[3] = T();
+  }
+
+  T x() const { return data_[0]; }
+  T y() const { return data_[1]; }
+  T z() const { return data_[2]; }
+  T w() const { return data_[3]; }
+
+  point3d4& x(const value_type& x) { data_[0] = x; return *this; }
+  point3d4& y(const value_type& y) { data_[1] = y; return *this; }
+  point3d4& z(const value_type& z) { data_[2] = z; return *this; }
+  point3d4& w(const value_type& w) { data_[3] = w; return *this; }
+
+  // equality operator, x, y and z only
+  template <typename Point>
+  bool operator==(const Point& rhs) const {
+    return equal(*this, rhs, 1);
+  }
+
+  template <typename Point>
+  bool operator!=(const Point& rhs) const {
+    return !(*this == rhs);
+  }
+
+  // increment, generic XYZ point. w is unchanged
+  template <typename P>
+  typename enable_if<is_point3d<P>::value, point3d4&>::type
+  operator += (const P& rhs)
+  {
+    data_[0] += rhs.x();
+    data_[1] += rhs.y();
+    data_[2] += rhs.z();
+    return *this;
+  }
+
+  // decrement, generic XYZ point. w is unchanged
+  template <typename P>
+  typename enable_if<is_point3d<P>::value, point3d4&>::type
+  operator -= (const P& rhs)
+  {
+    data_[0] -= rhs.x();
+    data_[1] -= rhs.y();
+    data_[2] -= rhs.z();
+    return *this;
+  }
+
+  template <typename P>
+  typename enable_if<is_point3d<P>::value, point3d4>::type
+  operator+(const P& rhs) const {
+    return point3d4(*this) += rhs;
+  }
+
+  template <typename P>
+  typename enable_if<is_point3d<P>::value, point3d4>::type
+  operator-(const P& rhs) const {
+    return point3d4(*this) -= rhs;
+  }
+
+  template <typename Scalar>
+  point3d4& operator *= (Scalar rhs) {
+    data_[0] *= rhs;
+    data_[1] *= rhs;
+    data_[2] *= rhs;
+    return *this;
+  }
+
+  template <typename Scalar>
+  point3d4& operator /= (Scalar rhs) {
+    data_[0] /= rhs;
+    data_[1] /= rhs;
+    data_[2] /= rhs;
+    return *this;
+  }
+
+  // access to underlying data
+  T& operator[](unsigned int i) {return data_[i];}
+
+  const T& operator[](unsigned int i) const {return data_[i];}
+
+  /// The four lanes, aligned to 4*sizeof(T) bytes
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  // Square of the magnitude of a coordinate
+  value_type mag2() const
+  {
+    return data_[0]*data_[0] + data_[1]*data_[1] + data_[2]*data_[2];
+  }
+
+  // normalize coordinates and return original length.
+  // Points of zero length are left unchanged.
+  value_type normalize() {
+    using std::sqrt;
+    const value_type d = sqrt(mag2());
+    if (d > value_type()) operator/=(d);
+    return d;
+  }
+
+ private:
+  T data_[4];
+
+};
+
+template <typename T>
+std::ostream& operator << (std::ostream& out, const point3d4<T>& point)
+{
+  return out << "point3d4 XYZW( " << point.x() << ", " << point.y() << ", "
+             << point.z() << ", " << point.w() << ")";
+}
+
+// addition of a point3d, preferred over the foreign LHS overloads of
+// point3d.hpp so that w is kept
+template <typename T>
+point3d4<T> operator+(const point3d4<T>& lhs, const point3d<T>& rhs)
+{
+  point3d4<T> ret(lhs);
+  ret += rhs;
+  return ret;
+}
+
+template <typename T>
+point3d4<T> operator-(const point3d4<T>& lhs, const point3d<T>& rhs)
+{
+  point3d4<T> ret(lhs);
+  ret -= rhs;
+  return ret;
+}
+
+template <typename T>
+point3d4<T> operator*(const point3d4<T>& point,
+                      const typename point3d4<T>::scalar_type& scalar)
+{
+  point3d4<T> ret(point);
+  ret *= scalar;
+  return ret;
+}
+
+template <typename T>
+point3d4<T> operator*(const typename point3d4<T>::scalar_type& scalar,
+                      const point3d4<T>& point)
+{
+  return point*scalar;
+}
+
+template <typename T>
+point3d4<T> operator/(const point3d4<T>& point,
+                      const typename point3d4<T>::scalar_type& scalar)
+{
+  point3d4<T> ret(point);
+  ret /= scalar;
+  return ret;
+}
+
+// ============================================================================
+// Transformation of single points. The float overloads are preferred over
+// the generic ones of geom3d_ops.hpp and transform a point in a handful of
+// SSE instructions.
+
+namespace detail
+{
+
+// rows r0, r1 and r2 multiplied element-wise by a point, summed across
+template <typename T>
+inline point3d4<T> row_sums(const T* r0, const T* r1, const T* r2, T w)
+{
+  return point3d4<T>(r0[0] + r0[1] + r0[2] + r0[3],
+                     r1[0] + r1[1] + r1[2] + r1[3],
+                     r2[0] + r2[1] + r2[2] + r2[3],
+                     w);
+}
+
+} // namespace detail
+
+#if defined(__SSE2__)
+
+namespace detail
+{
+
+// (x, y, z, 1) for translation, or (x, y, z, 0) without
+inline __m128 sse_point(const point3d4<float>& p, float w)
+{
+  const __m128 xyz = _mm_and_ps(_mm_load_ps(p.data()),
+                                _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+  return _mm_or_ps(xyz, _mm_set_ps(w, 0.f, 0.f, 0.f));
+}
+
+// sum across each of the row products, result in lanes 0, 1 and 2
+inline point3d4<float> sse_row_sums(__m128 a, __m128 b, __m128 c, float w)
+{
+  __m128 d = _mm_setzero_ps();
+  _MM_TRANSPOSE4_PS(a, b, c, d);
+  point3d4<float> ret;
+  _mm_store_ps(ret.data(), _mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)));
+  ret.w(w);
+  return ret;
+}
+
+} // namespace detail
+
+/// Rotate and translate a point by a 3x4 matrix. w is unchanged.
+inline point3d4<float> operator*(const matrix<float,3,4>& m, const point3d4<float>& point)
+{
+  const __m128 p = detail::sse_point(point, 1.f);
+  return detail::sse_row_sums(_mm_mul_ps(_mm_loadu_ps(&m(0,0)), p),
+                              _mm_mul_ps(_mm_loadu_ps(&m(1,0)), p),
+                              _mm_mul_ps(_mm_loadu_ps(&m(2,0)), p),
+                              point.w());
+}
+
+/// Rotate a point by a 3x3 matrix. w is unchanged.
+inline point3d4<float> operator*(const matrix<float,3>& m, const point3d4<float>& point)
+{
+  const __m128 p = detail::sse_point(point, 0.f);
+  return detail::sse_row_sums(_mm_mul_ps(_mm_set_ps(0.f, m(0,2), m(0,1), m(0,0)), p),
+                              _mm_mul_ps(_mm_set_ps(0.f, m(1,2), m(1,1), m(1,0)), p),
+                              _mm_mul_ps(_mm_set_ps(0.f, m(2,2), m(2,1), m(2,0)), p),
+                              point.w());
+}
+
+#else
+
+/// Rotate and translate a point by a 3x4 matrix. w is unchanged.
+inline point3d4<float> operator*(const matrix<float,3,4>& m, const point3d4<float>& point)
+{
+  float r[3][4];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    for (unsigned int j = 0; j < 3; ++j) r[i][j] = m(i,j)*point[j];
+    r[i][3] = m(i,3);
+  }
+  return detail::row_sums(r[0], r[1], r[2], point.w());
+}
+
+/// Rotate a point by a 3x3 matrix. w is unchanged.
+inline point3d4<float> operator*(const matrix<float,3>& m, const point3d4<float>& point)
+{
+  float r[3][4];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    for (unsigned int j = 0; j < 3; ++j) r[i][j] = m(i,j)*point[j];
+    r[i][3] = 0.f;
+  }
+  return detail::row_sums(r[0], r[1], r[2], point.w());
+}
+
+#endif
+
+/// Rotate and translate a point by a 3x4 matrix. w is unchanged.
+inline point3d4<double> operator*(const matrix<double,3,4>& m, const point3d4<double>& point)
+{
+  double r[3][4];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    for (unsigned int j = 0; j < 3; ++j) r[i][j] = m(i,j)*point[j];
+    r[i][3] = m(i,3);
+  }
+  return detail::row_sums(r[0], r[1], r[2], point.w());
+}
+
+/// Rotate a point by a 3x3 matrix. w is unchanged.
+inline point3d4<double> operator*(const matrix<double,3>& m, const point3d4<double>& point)
+{
+  double r[3][4];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    for (unsigned int j = 0; j < 3; ++j) r[i][j] = m(i,j)*point[j];
+    r[i][3] = 0.;
+  }
+  return detail::row_sums(r[0], r[1], r[2], point.w());
+}
+
+typedef point3d4<float> point4f;
+typedef point3d4<double> point4d;
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT3D4_H_
@@ -0,0 +1,307 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT3D_BATCH_OPS_H_
+#define MINIMATH_POINT3D_BATCH_OPS_H_
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include "minimath/type_traits.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//
+// Batch versions of the functions of point3d_ops.hpp, processing whole
+// ranges of points and writing one result per point to an output range.
+//
+// - Range overloads take iterators to any XYZ points, including the
+//   point_ref proxies of point_cloud and the point views.
+// - Array overloads take a pointer to point3d and a count. The float
+//   versions of mag2, dot and dist2 load four points at a time with SSE
+//   and transpose them to x, y and z registers.
+//
+// Structure-of-arrays storage has its own kernels in point_cloud.hpp.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// Second input of the pairwise range overloads: neither a point, as in the
+// overloads taking a single point, nor a count, as in the array overloads.
+template <typename T>
+struct is_batch_iterator
+: integral_constant<bool, !is_point3d<T>::value && !std::tr1::is_integral<T>::value> {};
+
+} // namespace detail
+
+// ============================================================================
+// Range overloads
+
+/// *out++ = mag2(p) for each p in [first, last)
+template <typename InputIterator, typename OutputIterator>
+OutputIterator mag2(InputIterator first, InputIterator last, OutputIterator out)
+{
+  for (; first != last; ++first, ++out) *out = mag2(*first);
+  return out;
+}
+
+/// *out++ = dot(a, b) for each pair in [first1, last1) and [first2, ...)
+template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+typename enable_if<detail::is_batch_iterator<InputIterator2>::value, OutputIterator>::type
+dot(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputIterator out)
+{
+  for (; first1 != last1; ++first1, ++first2, ++out) *out = dot(*first1, *first2);
+  return out;
+}
+
+/// *out++ = dot(a, p) for each a in [first, last)
+template <typename InputIterator, typename P, typename OutputIterator>
+typename enable_if<is_point3d<P>::value, OutputIterator>::type
+dot(InputIterator first, InputIterator last, const P& p, OutputIterator out)
+{
+  for (; first != last; ++first, ++out) *out = dot(*first, p);
+  return out;
+}
+
+/// *out++ = dist2(a, b) for each pair in [first1, last1) and [first2, ...)
+template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+typename enable_if<detail::is_batch_iterator<InputIterator2>::value, OutputIterator>::type
+dist2(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputIterator out)
+{
+  for (; first1 != last1; ++first1, ++first2, ++out) *out = dist2(*first1, *first2);
+  return out;
+}
+
+/// *out++ = dist2(a, p) for each a in [first, last)
+template <typename InputIterator, typename P, typename OutputIterator>
+typename enable_if<is_point3d<P>::value, OutputIterator>::type
+dist2(InputIterator first, InputIterator last, const P& p, OutputIterator out)
+{
+  for (; first != last; ++first, ++out) *out = dist2(*first, p);
+  return out;
+}
+
+///
+/// *out++ = cross(a, b) for each pair in [first1, last1) and [first2, ...)
+/// The results have the value type of InputIterator1.
+///
+template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+typename enable_if<detail::is_batch_iterator<InputIterator2>::value, OutputIterator>::type
+cross(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, OutputIterator out)
+{
+  typedef typename std::iterator_traits<InputIterator1>::value_type value_type;
+  for (; first1 != last1; ++first1, ++first2, ++out)
+  {
+    *out = cross(value_type(*first1), *first2);
+  }
+  return out;
+}
+
+///
+/// Normalize every point of [first, last) in place and write the original
+/// lengths to lengths. Points of zero length are left unchanged.
+///
+template <typename ForwardIterator, typename OutputIterator>
+OutputIterator normalize(ForwardIterator first, ForwardIterator last, OutputIterator lengths)
+{
+  using std::sqrt;
+  typedef typename std::iterator_traits<ForwardIterator>::value_type value_type;
+  typedef typename value_type::value_type scalar_type;
+  for (; first != last; ++first, ++lengths)
+  {
+    value_type p(*first);
+    const scalar_type d = sqrt(mag2(p));
+    if (d > scalar_type())
+    {
+      p /= d;
+      *first = p;
+    }
+    *lengths = d;
+  }
+  return lengths;
+}
+
+// ============================================================================
+// Array overloads
+
+/// out[i] = mag2(p[i]), i in [0, n)
+template <typename T>
+void mag2(const point3d<T>* p, std::size_t n, T* out)
+{
+  mag2(p, p + n, out);
+}
+
+/// out[i] = dot(a[i], b[i]), i in [0, n)
+template <typename T>
+void dot(const point3d<T>* a, const point3d<T>* b, std::size_t n, T* out)
+{
+  dot(a, a + n, b, out);
+}
+
+/// out[i] = dist2(a[i], b[i]), i in [0, n)
+template <typename T>
+void dist2(const point3d<T>* a, const point3d<T>* b, std::size_t n, T* out)
+{
+  dist2(a, a + n, b, out);
+}
+
+/// out[i] = dist2(a[i], p), i in [0, n)
+template <typename T>
+void dist2(const point3d<T>* a, std::size_t n, const point3d<T>& p, T* out)
+{
+  dist2(a, a + n, p, out);
+}
+
+/// out[i] = cross(a[i], b[i]), i in [0, n)
+template <typename T>
+void cross(const point3d<T>* a, const point3d<T>* b, std::size_t n, point3d<T>* out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T x = a[i].y()*b[i].z() - a[i].z()*b[i].y();
+    const T y = a[i].z()*b[i].x() - a[i].x()*b[i].z();
+    const T z = a[i].x()*b[i].y() - a[i].y()*b[i].x();
+    out[i] = point3d<T>(x, y, z);
+  }
+}
+
+///
+/// Normalize p[i], i in [0, n), in place. Points of zero length are left
+/// unchanged. If lengths is not null, the original lengths are written
+/// to it.
+///
+template <typename T>
+void normalize(point3d<T>* p, std::size_t n, T* lengths = 0)
+{
+  using std::sqrt;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T d = sqrt(p[i].mag2());
+    if (d > T()) p[i] /= d;
+    if (lengths) lengths[i] = d;
+  }
+}
+
+#if defined(__SSE2__)
+
+namespace detail
+{
+
+// Load points p[0] to p[3] and transpose them to x, y and z registers.
+// Relies on point3d<float> being three packed floats.
+inline void load_points4(const point3d<float>* p, __m128& x, __m128& y, __m128& z)
+{
+  const float* f = &p[0][0];
+  const __m128 a0 = _mm_loadu_ps(f);     // x0 y0 z0 x1
+  const __m128 a1 = _mm_loadu_ps(f + 4); // y1 z1 x2 y2
+  const __m128 a2 = _mm_loadu_ps(f + 8); // z2 x3 y3 z3
+  const __m128 t = _mm_shuffle_ps(a1, a2, _MM_SHUFFLE(2,1,3,2)); // x2 y2 x3 y3
+  const __m128 u = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(1,0,2,1)); // y0 z0 y1 z1
+  x = _mm_shuffle_ps(a0, t, _MM_SHUFFLE(2,0,3,0));
+  y = _mm_shuffle_ps(u, t, _MM_SHUFFLE(3,1,2,0));
+  z = _mm_shuffle_ps(u, a2, _MM_SHUFFLE(3,0,3,1));
+}
+
+// Inverse of load_points4: store x, y and z registers as points p[0] to p[3].
+inline void store_points4(point3d<float>* p, __m128 x, __m128 y, __m128 z)
+{
+  float* f = &p[0][0];
+  const __m128 xy01 = _mm_unpacklo_ps(x, y);                      // x0 y0 x1 y1
+  const __m128 xy23 = _mm_unpackhi_ps(x, y);                      // x2 y2 x3 y3
+  const __m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1,1,0,0));   // z0 z0 x1 x1
+  const __m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1,1,1,1));   // y1 y1 z1 z1
+  const __m128 zxy = _mm_shuffle_ps(z, xy23, _MM_SHUFFLE(3,2,3,2)); // z2 z3 x3 y3
+  _mm_storeu_ps(f, _mm_shuffle_ps(xy01, zx, _MM_SHUFFLE(2,0,1,0)));
+  _mm_storeu_ps(f + 4, _mm_shuffle_ps(yz, xy23, _MM_SHUFFLE(1,0,2,0)));
+  _mm_storeu_ps(f + 8, _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(1,3,2,0)));
+}
+
+inline __m128 sse_mag2(__m128 x, __m128 y, __m128 z)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+}
+
+} // namespace detail
+
+/// out[i] = mag2(p[i]), i in [0, n)
+inline void mag2(const point3d<float>* p, std::size_t n, float* out)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 x, y, z;
+    detail::load_points4(p + i, x, y, z);
+    _mm_storeu_ps(out + i, detail::sse_mag2(x, y, z));
+  }
+  mag2(p + i, p + n, out + i);
+}
+
+/// out[i] = dot(a[i], b[i]), i in [0, n)
+inline void dot(const point3d<float>* a, const point3d<float>* b, std::size_t n, float* out)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 ax, ay, az, bx, by, bz;
+    detail::load_points4(a + i, ax, ay, az);
+    detail::load_points4(b + i, bx, by, bz);
+    const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                                _mm_mul_ps(az, bz));
+    _mm_storeu_ps(out + i, d);
+  }
+  dot(a + i, a + n, b + i, out + i);
+}
+
+/// out[i] = dist2(a[i], b[i]), i in [0, n)
+inline void dist2(const point3d<float>* a, const point3d<float>* b, std::size_t n, float* out)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 ax, ay, az, bx, by, bz;
+    detail::load_points4(a + i, ax, ay, az);
+    detail::load_points4(b + i, bx, by, bz);
+    _mm_storeu_ps(out + i, detail::sse_mag2(_mm_sub_ps(bx, ax),
+                                            _mm_sub_ps(by, ay),
+                                            _mm_sub_ps(bz, az)));
+  }
+  dist2(a + i, a + n, b + i, out + i);
+}
+
+/// out[i] = dist2(a[i], p), i in [0, n)
+inline void dist2(const point3d<float>* a, std::size_t n, const point3d<float>& p, float* out)
+{
+  const __m128 px = _mm_set1_ps(p.x());
+  const __m128 py = _mm_set1_ps(p.y());
+  const __m128 pz = _mm_set1_ps(p.z());
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 ax, ay, az;
+    detail::load_points4(a + i, ax, ay, az);
+    _mm_storeu_ps(out + i, detail::sse_mag2(_mm_sub_ps(px, ax),
+                                            _mm_sub_ps(py, ay),
+                                            _mm_sub_ps(pz, az)));
+  }
+  dist2(a + i, a + n, p, out + i);
+}
+
+#endif
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT3D_BATCH_OPS_H_
@@ -34,11 +34,12 @@ bool equal(const P1& lhs,
            const P2& rhs,
            unsigned int nEpsilons = 0)
 {
+  using std::abs;
   typedef typename P1::value_type scalar_type;
-  scalar_type eps = std::numeric_limits<scalar_type>::epsilon() * nEpsilons;
-  return (std::abs(lhs.x()-rhs.x()) <= eps &&
-          std::abs(lhs.y()-rhs.y()) <= eps &&
-          std::abs(lhs.z()-rhs.z()) <= eps );
+  scalar_type eps = std::numeric_limits<scalar_type>::epsilon() * static_cast<scalar_type>(nEpsilons);
+  return (abs(lhs.x()-rhs.x()) <= eps &&
+          abs(lhs.y()-rhs.y()) <= eps &&
+          abs(lhs.z()-rhs.z()) <= eps );
 }
 
 // Square of the magnitude of a point
@@ -76,14 +77,15 @@ normalize(const P& p)
 
 // Return the normalized point
 // For points without optimized menber function
+// A point of zero length is returned unchanged
 template <typename P>
 typename enable_if<!has_member_normalize<P>::value, P>::type
 normalize(const P& p) {
   using std::sqrt;
   typedef typename P::value_type value_type;
   value_type d = sqrt(mag2(p));
-  if (equal(d, value_type(0), 1)) return 0;
   P n = p;
+  if (equal(d, value_type(0), 1)) return n;
   n /= d;
   return n;
 }
@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT_CLOUD_H_
+#define MINIMATH_POINT_CLOUD_H_
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include "minimath/aligned_allocator.hpp"
+#include "minimath/point_ref.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+
+//
+// Structure-of-arrays container of 3D points: the x, y and z coordinates
+// are held in three separate, cache line aligned arrays, so that bulk
+// operations stream through contiguous memory and vectorise without
+// gathers.
+//
+// Elements are accessed through point_ref proxies, which satisfy
+// is_point3d and work with the generic functions of point3d_ops.hpp.
+// Bulk versions of those functions operating on whole clouds follow the
+// class.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+template <typename T>
+class point_cloud {
+
+ public:
+
+  typedef T scalar_type;
+  typedef point3d<T> value_type;
+  typedef point_ref<T> reference;
+  typedef point_ref<const T> const_reference;
+  typedef point_iterator<T> iterator;
+  typedef point_iterator<const T> const_iterator;
+  typedef std::size_t size_type;
+  typedef std::vector<T, aligned_allocator<T> > array_type;
+
+  point_cloud() {}
+
+  explicit point_cloud(size_type n) : m_x(n), m_y(n), m_z(n) {}
+
+  /// Construct from a range of XYZ points
+  template <typename Iterator>
+  point_cloud(Iterator first, Iterator last)
+  {
+    for (; first != last; ++first) push_back(*first);
+  }
+
+  size_type size() const { return m_x.size(); }
+  bool empty() const { return m_x.empty(); }
+
+  void resize(size_type n)
+  {
+    m_x.resize(n);
+    m_y.resize(n);
+    m_z.resize(n);
+  }
+
+  void reserve(size_type n)
+  {
+    m_x.reserve(n);
+    m_y.reserve(n);
+    m_z.reserve(n);
+  }
+
+  void clear()
+  {
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+  }
+
+  template <typename P>
+  void push_back(const P& p)
+  {
+    m_x.push_back(p.x());
+    m_y.push_back(p.y());
+    m_z.push_back(p.z());
+  }
+
+  reference operator[](size_type i) { return reference(&m_x[i], &m_y[i], &m_z[i]); }
+  const_reference operator[](size_type i) const { return const_reference(&m_x[i], &m_y[i], &m_z[i]); }
+
+  iterator begin() { return iterator(x_data(), y_data(), z_data()); }
+  iterator end() { return begin() + static_cast<std::ptrdiff_t>(size()); }
+  const_iterator begin() const { return const_iterator(x_data(), y_data(), z_data()); }
+  const_iterator end() const { return begin() + static_cast<std::ptrdiff_t>(size()); }
+
+  /// Coordinate arrays, each of size() elements and 64 byte aligned.
+  T* x_data() { return data(m_x); }
+  T* y_data() { return data(m_y); }
+  T* z_data() { return data(m_z); }
+  const T* x_data() const { return data(m_x); }
+  const T* y_data() const { return data(m_y); }
+  const T* z_data() const { return data(m_z); }
+
+ private:
+
+  static T* data(array_type& a) { return a.empty() ? 0 : &a[0]; }
+  static const T* data(const array_type& a) { return a.empty() ? 0 : &a[0]; }
+
+  array_type m_x, m_y, m_z;
+};
+
+// ============================================================================
+// Bulk operations. Output arrays hold one element per point and must not
+// overlap the inputs. Binary operations on two clouds require equal sizes.
+
+/// out[i] = mag2(cloud[i])
+template <typename T>
+void mag2(const point_cloud<T>& cloud, T* out)
+{
+  const T* x = cloud.x_data();
+  const T* y = cloud.y_data();
+  const T* z = cloud.z_data();
+  const std::size_t n = cloud.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = x[i]*x[i] + y[i]*y[i] + z[i]*z[i];
+  }
+}
+
+/// out[i] = dot(a[i], b[i])
+template <typename T>
+void dot(const point_cloud<T>& a, const point_cloud<T>& b, T* out)
+{
+  const T* ax = a.x_data();
+  const T* ay = a.y_data();
+  const T* az = a.z_data();
+  const T* bx = b.x_data();
+  const T* by = b.y_data();
+  const T* bz = b.z_data();
+  const std::size_t n = a.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = ax[i]*bx[i] + ay[i]*by[i] + az[i]*bz[i];
+  }
+}
+
+/// out[i] = dot(a[i], p)
+template <typename T, typename P>
+typename enable_if<is_point3d<P>::value>::type
+dot(const point_cloud<T>& a, const P& p, T* out)
+{
+  const T* ax = a.x_data();
+  const T* ay = a.y_data();
+  const T* az = a.z_data();
+  const T px = p.x();
+  const T py = p.y();
+  const T pz = p.z();
+  const std::size_t n = a.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = ax[i]*px + ay[i]*py + az[i]*pz;
+  }
+}
+
+/// out[i] = cross(a[i], b[i]). out is resized to a.size().
+template <typename T>
+void cross(const point_cloud<T>& a, const point_cloud<T>& b, point_cloud<T>& out)
+{
+  out.resize(a.size());
+  const T* ax = a.x_data();
+  const T* ay = a.y_data();
+  const T* az = a.z_data();
+  const T* bx = b.x_data();
+  const T* by = b.y_data();
+  const T* bz = b.z_data();
+  T* ox = out.x_data();
+  T* oy = out.y_data();
+  T* oz = out.z_data();
+  const std::size_t n = a.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T x = ay[i]*bz[i] - az[i]*by[i];
+    const T y = az[i]*bx[i] - ax[i]*bz[i];
+    const T z = ax[i]*by[i] - ay[i]*bx[i];
+    ox[i] = x;
+    oy[i] = y;
+    oz[i] = z;
+  }
+}
+
+/// out[i] = dist2(a[i], b[i])
+template <typename T>
+void dist2(const point_cloud<T>& a, const point_cloud<T>& b, T* out)
+{
+  const T* ax = a.x_data();
+  const T* ay = a.y_data();
+  const T* az = a.z_data();
+  const T* bx = b.x_data();
+  const T* by = b.y_data();
+  const T* bz = b.z_data();
+  const std::size_t n = a.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T dx = bx[i] - ax[i];
+    const T dy = by[i] - ay[i];
+    const T dz = bz[i] - az[i];
+    out[i] = dx*dx + dy*dy + dz*dz;
+  }
+}
+
+/// out[i] = dist2(a[i], p)
+template <typename T, typename P>
+typename enable_if<is_point3d<P>::value>::type
+dist2(const point_cloud<T>& a, const P& p, T* out)
+{
+  const T* ax = a.x_data();
+  const T* ay = a.y_data();
+  const T* az = a.z_data();
+  const T px = p.x();
+  const T py = p.y();
+  const T pz = p.z();
+  const std::size_t n = a.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T dx = px - ax[i];
+    const T dy = py - ay[i];
+    const T dz = pz - az[i];
+    out[i] = dx*dx + dy*dy + dz*dz;
+  }
+}
+
+///
+/// Normalize every point of a cloud in place. Points of zero length are
+/// left unchanged. If lengths is not null, the original lengths are
+/// written to it.
+///
+template <typename T>
+void normalize(point_cloud<T>& cloud, T* lengths = 0)
+{
+  using std::sqrt;
+  T* x = cloud.x_data();
+  T* y = cloud.y_data();
+  T* z = cloud.z_data();
+  const std::size_t n = cloud.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T d = sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+    const T s = d > T() ? T(1)/d : T(1);
+    x[i] *= s;
+    y[i] *= s;
+    z[i] *= s;
+    if (lengths) lengths[i] = d;
+  }
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT_CLOUD_H_
@@ -0,0 +1,663 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT_FILE_IO_H_
+#define MINIMATH_POINT_FILE_IO_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/binary_io.hpp" // for swap_bytes
+#include "minimath/mapped_file.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point_cloud.hpp"
+#include "minimath/text_io.hpp"
+
+//
+// Streaming readers and writers of point files: binary PLY and ASCII XYZ.
+//
+// Readers map the file and hand out its points in chunks of at most a
+// given number of points, as point3d arrays or point clouds, so that a
+// scan can be processed while the rest of it is still on disk. Before
+// converting a chunk they ask the system to read the next one ahead, and
+// after converting it they release the pages it came from, so memory use
+// stays bounded by the chunk size whatever the file size.
+//
+// The PLY reader takes the x, y and z properties of the vertex element,
+// of any PLY scalar type, in either byte order, ignoring other properties
+// and elements. Elements before the vertices must not have list
+// properties. ASCII PLY is not supported.
+//
+// An XYZ file has one point per line: x, y and z separated by white space
+// or commas, optionally followed by other columns, which are ignored.
+// Blank lines and lines starting with '#' are skipped.
+//
+// Writers append points through a buffered C stream. The PLY writer
+// declares float or double properties in the native byte order and fills
+// in the vertex count on close. The XYZ writer prints values with enough
+// digits to be read back exactly.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+/// Outcome of opening, reading or writing a point file.
+enum point_file_status
+{
+  point_file_ok = 0,
+  point_file_open_failed,  // file cannot be opened, mapped or created
+  point_file_bad_header,   // not a PLY file, or a malformed header
+  point_file_unsupported,  // ASCII PLY, list properties or no x, y and z
+  point_file_truncated,    // fewer vertices than the header declares
+  point_file_parse_error,  // XYZ line without three numbers
+  point_file_write_failed
+};
+
+namespace detail
+{
+
+enum ply_type
+{
+  ply_none,
+  ply_int8,
+  ply_uint8,
+  ply_int16,
+  ply_uint16,
+  ply_int32,
+  ply_uint32,
+  ply_float32,
+  ply_float64
+};
+
+inline ply_type ply_type_from_name(const std::string& name)
+{
+  if (name == "char" || name == "int8") return ply_int8;
+  if (name == "uchar" || name == "uint8") return ply_uint8;
+  if (name == "short" || name == "int16") return ply_int16;
+  if (name == "ushort" || name == "uint16") return ply_uint16;
+  if (name == "int" || name == "int32") return ply_int32;
+  if (name == "uint" || name == "uint32") return ply_uint32;
+  if (name == "float" || name == "float32") return ply_float32;
+  if (name == "double" || name == "float64") return ply_float64;
+  return ply_none;
+}
+
+inline std::size_t ply_type_size(ply_type type)
+{
+  switch (type)
+  {
+    case ply_int8: case ply_uint8: return 1;
+    case ply_int16: case ply_uint16: return 2;
+    case ply_int32: case ply_uint32: case ply_float32: return 4;
+    case ply_float64: return 8;
+    default: return 0;
+  }
+}
+
+template <typename T> struct ply_type_name;
+template <> struct ply_type_name<float> { static const char* get() { return "float"; } };
+template <> struct ply_type_name<double> { static const char* get() { return "double"; } };
+
+inline bool host_is_little_endian()
+{
+  const std::tr1::uint16_t one = 1;
+  return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+// out[i*out_stride] = property of type U at src + i*stride, i in [0, n)
+template <typename U, typename T>
+void ply_convert(const char* src, std::size_t stride, std::size_t n, bool swap,
+                 T* out, std::size_t out_stride)
+{
+  for (std::size_t i = 0; i < n; ++i, src += stride)
+  {
+    U u;
+    std::memcpy(&u, src, sizeof(U));
+    if (swap) swap_bytes(reinterpret_cast<char*>(&u), sizeof(U));
+    out[i*out_stride] = static_cast<T>(u);
+  }
+}
+
+template <typename T>
+void ply_convert(ply_type type, const char* src, std::size_t stride, std::size_t n, bool swap,
+                 T* out, std::size_t out_stride)
+{
+  switch (type)
+  {
+    case ply_int8: ply_convert<std::tr1::int8_t>(src, stride, n, swap, out, out_stride); break;
+    case ply_uint8: ply_convert<std::tr1::uint8_t>(src, stride, n, swap, out, out_stride); break;
+    case ply_int16: ply_convert<std::tr1::int16_t>(src, stride, n, swap, out, out_stride); break;
+    case ply_uint16: ply_convert<std::tr1::uint16_t>(src, stride, n, swap, out, out_stride); break;
+    case ply_int32: ply_convert<std::tr1::int32_t>(src, stride, n, swap, out, out_stride); break;
+    case ply_uint32: ply_convert<std::tr1::uint32_t>(src, stride, n, swap, out, out_stride); break;
+    case ply_float32: ply_convert<float>(src, stride, n, swap, out, out_stride); break;
+    case ply_float64: ply_convert<double>(src, stride, n, swap, out, out_stride); break;
+    default: break;
+  }
+}
+
+// white space separated words of [first, last)
+inline std::vector<std::string> split_words(const char* first, const char* last)
+{
+  std::vector<std::string> words;
+  while (first != last)
+  {
+    while (first != last && (*first == ' ' || *first == '\t' || *first == '\r')) ++first;
+    const char* end = first;
+    while (end != last && *end != ' ' && *end != '\t' && *end != '\r') ++end;
+    if (end != first) words.push_back(std::string(first, end));
+    first = end;
+  }
+  return words;
+}
+
+} // namespace detail
+
+// ============================================================================
+// Readers
+
+class ply_reader {
+
+ public:
+
+  ply_reader() { reset(point_file_open_failed); }
+
+  explicit ply_reader(const char* path) { open(path); }
+
+  /// Map the file at path and parse its header.
+  point_file_status open(const char* path)
+  {
+    m_file.close();
+    reset(point_file_ok);
+    if (!m_file.open(path)) return m_status = point_file_open_failed;
+    return m_status = parse_header();
+  }
+
+  void close()
+  {
+    m_file.close();
+    reset(point_file_open_failed);
+  }
+
+  /// Outcome of open, or of the last read.
+  point_file_status status() const { return m_status; }
+
+  /// Number of vertices declared by the header.
+  std::size_t size() const { return m_count; }
+
+  /// Number of vertices read so far.
+  std::size_t position() const { return m_next; }
+
+  /// True once all the vertices have been read, or after an error.
+  bool at_end() const { return m_status != point_file_ok || m_next == m_count; }
+
+  ///
+  /// Read the next vertices, at most max_points, to out. Return the number
+  /// read, 0 at the end of the file or if status() is not point_file_ok.
+  ///
+  template <typename T>
+  std::size_t read(point3d<T>* out, std::size_t max_points)
+  {
+    T* p = &out[0][0];
+    return read(p, p + 1, p + 2, 3, max_points);
+  }
+
+  /// As above, resizing out to the number of vertices read.
+  template <typename T>
+  std::size_t read(point_cloud<T>& out, std::size_t max_points)
+  {
+    out.resize(std::min(max_points, m_count - m_next));
+    const std::size_t n = read(out.x_data(), out.y_data(), out.z_data(), 1, out.size());
+    out.resize(n);
+    return n;
+  }
+
+ private:
+
+  ply_reader(const ply_reader&);
+  ply_reader& operator=(const ply_reader&);
+
+  void reset(point_file_status status)
+  {
+    m_status = status;
+    m_count = m_next = m_stride = m_data = 0;
+    m_swap = false;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      m_type[d] = detail::ply_none;
+      m_offset[d] = 0;
+    }
+  }
+
+  template <typename T>
+  std::size_t read(T* x, T* y, T* z, std::size_t out_stride, std::size_t max_points)
+  {
+    if (m_status != point_file_ok) return 0;
+    const std::size_t n = std::min(max_points, m_count - m_next);
+    const std::size_t begin = m_data + m_next*m_stride;
+    const std::size_t bytes = n*m_stride;
+    m_file.will_need(begin + bytes, bytes);
+    const char* src = m_file.data() + begin;
+    T* out[3] = { x, y, z };
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      detail::ply_convert(m_type[d], src + m_offset[d], m_stride, n, m_swap, out[d], out_stride);
+    }
+    m_file.release(begin, bytes);
+    m_next += n;
+    return n;
+  }
+
+  point_file_status parse_header()
+  {
+    const char* data = m_file.data();
+    const std::size_t size = m_file.size();
+    std::size_t pos = 0, skip = 0;
+    bool first = true, inVertex = false, seenVertex = false, skipping = false;
+    std::size_t elementCount = 0, elementSize = 0;
+    while (true)
+    {
+      const char* line = data + pos;
+      const char* eol = static_cast<const char*>(std::memchr(line, '\n', size - pos));
+      if (!eol) return point_file_bad_header;
+      pos = static_cast<std::size_t>(eol - data) + 1;
+      const std::vector<std::string> words = detail::split_words(line, eol);
+      if (first)
+      {
+        if (words.size() != 1 || words[0] != "ply") return point_file_bad_header;
+        first = false;
+        continue;
+      }
+      if (words.empty() || words[0] == "comment" || words[0] == "obj_info") continue;
+      if (words[0] == "format")
+      {
+        if (words.size() < 2) return point_file_bad_header;
+        if (words[1] == "ascii") return point_file_unsupported;
+        if (words[1] != "binary_little_endian" && words[1] != "binary_big_endian")
+        {
+          return point_file_bad_header;
+        }
+        m_swap = (words[1] == "binary_little_endian") != detail::host_is_little_endian();
+      }
+      else if (words[0] == "element" || words[0] == "end_header")
+      {
+        // close the previous element
+        if (skipping) skip += elementCount*elementSize;
+        skipping = false;
+        if (inVertex)
+        {
+          m_count = elementCount;
+          m_stride = elementSize;
+          seenVertex = true;
+        }
+        inVertex = false;
+        if (words[0] == "end_header") break;
+        if (words.size() != 3) return point_file_bad_header;
+        elementCount = static_cast<std::size_t>(std::strtoul(words[2].c_str(), 0, 10));
+        elementSize = 0;
+        inVertex = words[1] == "vertex" && !seenVertex;
+        skipping = !seenVertex && !inVertex;
+      }
+      else if (words[0] == "property")
+      {
+        if (words.size() == 5 && words[1] == "list")
+        {
+          if (inVertex || skipping) return point_file_unsupported;
+          continue;
+        }
+        if (words.size() != 3) return point_file_bad_header;
+        const detail::ply_type type = detail::ply_type_from_name(words[1]);
+        if (type == detail::ply_none) return point_file_bad_header;
+        if (inVertex)
+        {
+          const int d = words[2] == "x" ? 0 : words[2] == "y" ? 1 : words[2] == "z" ? 2 : -1;
+          if (d >= 0)
+          {
+            m_type[d] = type;
+            m_offset[d] = elementSize;
+          }
+        }
+        elementSize += detail::ply_type_size(type);
+      }
+      else
+      {
+        return point_file_bad_header;
+      }
+    }
+    if (!seenVertex) return point_file_unsupported;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      if (m_type[d] == detail::ply_none) return point_file_unsupported;
+    }
+    m_data = pos + skip;
+    if (m_count != 0 && (m_data > size || (size - m_data)/m_stride < m_count))
+    {
+      return point_file_truncated;
+    }
+    m_file.will_need(m_data, std::min(m_count*m_stride, std::size_t(1) << 20));
+    return point_file_ok;
+  }
+
+  mapped_file m_file;
+  point_file_status m_status;
+  std::size_t m_count;          // vertices
+  std::size_t m_next;           // next vertex to read
+  std::size_t m_stride;         // bytes per vertex
+  std::size_t m_data;           // offset of the first vertex
+  std::size_t m_offset[3];      // of x, y and z within a vertex
+  detail::ply_type m_type[3];
+  bool m_swap;                  // file in the other byte order
+};
+
+class xyz_reader {
+
+ public:
+
+  xyz_reader() : m_status(point_file_open_failed), m_pos(0), m_count(0), m_line(0) {}
+
+  explicit xyz_reader(const char* path) : m_status(point_file_open_failed), m_pos(0), m_count(0), m_line(0)
+  {
+    open(path);
+  }
+
+  /// Map the file at path.
+  point_file_status open(const char* path)
+  {
+    m_pos = m_count = m_line = 0;
+    if (!m_file.open(path)) return m_status = point_file_open_failed;
+    m_file.will_need(0, std::size_t(1) << 20);
+    return m_status = point_file_ok;
+  }
+
+  void close()
+  {
+    m_file.close();
+    m_status = point_file_open_failed;
+  }
+
+  /// Outcome of open, or of the last read.
+  point_file_status status() const { return m_status; }
+
+  /// Number of points read so far.
+  std::size_t position() const { return m_count; }
+
+  /// Number of lines read so far, which on a parse error is the bad one.
+  std::size_t line() const { return m_line; }
+
+  /// True once the whole file has been read, or after an error.
+  bool at_end() const { return m_status != point_file_ok || m_pos == m_file.size(); }
+
+  ///
+  /// Read the next points, at most max_points, to out. Return the number
+  /// read, 0 at the end of the file. On a line that does not start with
+  /// three numbers, stop, and set status() to point_file_parse_error.
+  ///
+  template <typename T>
+  std::size_t read(point3d<T>* out, std::size_t max_points)
+  {
+    T* p = &out[0][0];
+    return read(p, p + 1, p + 2, 3, max_points);
+  }
+
+  /// As above, resizing out to the number of points read.
+  template <typename T>
+  std::size_t read(point_cloud<T>& out, std::size_t max_points)
+  {
+    out.resize(max_points);
+    const std::size_t n = read(out.x_data(), out.y_data(), out.z_data(), 1, max_points);
+    out.resize(n);
+    return n;
+  }
+
+ private:
+
+  xyz_reader(const xyz_reader&);
+  xyz_reader& operator=(const xyz_reader&);
+
+  template <typename T>
+  std::size_t read(T* x, T* y, T* z, std::size_t out_stride, std::size_t max_points)
+  {
+    if (m_status != point_file_ok) return 0;
+    const char* data = m_file.data();
+    const std::size_t size = m_file.size();
+    const std::size_t begin = m_pos;
+    std::size_t n = 0;
+    while (n < max_points && m_pos < size)
+    {
+      const char* line = data + m_pos;
+      const char* eol = static_cast<const char*>(std::memchr(line, '\n', size - m_pos));
+      if (!eol) eol = data + size;
+      ++m_line;
+      const char* p = line;
+      while (p != eol && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+      if (p != eol && *p != '#')
+      {
+        double v[3];
+        if (!detail::parse_scalars(p, eol, v, 3u))
+        {
+          m_status = point_file_parse_error;
+          break;
+        }
+        x[n*out_stride] = static_cast<T>(v[0]);
+        y[n*out_stride] = static_cast<T>(v[1]);
+        z[n*out_stride] = static_cast<T>(v[2]);
+        ++n;
+      }
+      m_pos = std::min(size, static_cast<std::size_t>(eol - data) + 1);
+    }
+    // about as many bytes again are likely to be read next
+    m_file.will_need(m_pos, m_pos - begin);
+    m_file.release(begin, m_pos - begin);
+    m_count += n;
+    return n;
+  }
+
+  mapped_file m_file;
+  point_file_status m_status;
+  std::size_t m_pos;    // offset of the next line
+  std::size_t m_count;  // points read
+  std::size_t m_line;   // lines read
+};
+
+// ============================================================================
+// Writers
+
+template <typename T>
+class ply_writer {
+
+ public:
+
+  ply_writer() : m_file(0), m_count(0), m_count_pos(0), m_status(point_file_open_failed) {}
+
+  explicit ply_writer(const char* path)
+  :
+  m_file(0), m_count(0), m_count_pos(0), m_status(point_file_open_failed)
+  {
+    open(path);
+  }
+
+  ~ply_writer() { close(); }
+
+  /// Create the file at path and write the header.
+  point_file_status open(const char* path)
+  {
+    close();
+    m_count = 0;
+    m_file = std::fopen(path, "wb");
+    if (!m_file) return m_status = point_file_open_failed;
+    m_status = point_file_ok;
+    std::fprintf(m_file, "ply\nformat %s 1.0\nelement vertex ",
+                 detail::host_is_little_endian() ? "binary_little_endian" : "binary_big_endian");
+    m_count_pos = std::ftell(m_file);
+    // room for any count, filled in by close
+    std::fprintf(m_file, "%-20lu\n", 0ul);
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      std::fprintf(m_file, "property %s %c\n", detail::ply_type_name<T>::get(), "xyz"[d]);
+    }
+    std::fprintf(m_file, "end_header\n");
+    return check();
+  }
+
+  /// Append the points of [first, last).
+  template <typename InputIterator>
+  point_file_status write(InputIterator first, InputIterator last)
+  {
+    if (m_status != point_file_ok) return m_status;
+    T buf[3*buffer_points];
+    std::size_t n = 0;
+    for (; first != last; ++first)
+    {
+      buf[3*n] = static_cast<T>((*first).x());
+      buf[3*n + 1] = static_cast<T>((*first).y());
+      buf[3*n + 2] = static_cast<T>((*first).z());
+      if (++n == buffer_points)
+      {
+        flush(buf, n);
+        n = 0;
+      }
+    }
+    flush(buf, n);
+    return check();
+  }
+
+  /// Fill in the vertex count and close the file.
+  point_file_status close()
+  {
+    if (!m_file) return m_status;
+    if (m_status == point_file_ok)
+    {
+      if (std::fseek(m_file, m_count_pos, SEEK_SET) != 0) m_status = point_file_write_failed;
+      else std::fprintf(m_file, "%-20lu", static_cast<unsigned long>(m_count));
+      check();
+    }
+    if (std::fclose(m_file) != 0) m_status = point_file_write_failed;
+    m_file = 0;
+    return m_status;
+  }
+
+  point_file_status status() const { return m_status; }
+
+  /// Number of points written so far.
+  std::size_t size() const { return m_count; }
+
+ private:
+
+  static const std::size_t buffer_points = 1024;
+
+  ply_writer(const ply_writer&);
+  ply_writer& operator=(const ply_writer&);
+
+  void flush(const T* buf, std::size_t n)
+  {
+    if (n != 0 && std::fwrite(buf, 3*sizeof(T), n, m_file) != n) m_status = point_file_write_failed;
+    m_count += n;
+  }
+
+  point_file_status check()
+  {
+    if (std::ferror(m_file)) m_status = point_file_write_failed;
+    return m_status;
+  }
+
+  std::FILE* m_file;
+  std::size_t m_count;
+  long m_count_pos; // file position of the vertex count
+  point_file_status m_status;
+};
+
+template <typename T>
+class xyz_writer {
+
+ public:
+
+  xyz_writer() : m_file(0), m_count(0), m_status(point_file_open_failed) {}
+
+  explicit xyz_writer(const char* path) : m_file(0), m_count(0), m_status(point_file_open_failed)
+  {
+    open(path);
+  }
+
+  ~xyz_writer() { close(); }
+
+  /// Create the file at path.
+  point_file_status open(const char* path)
+  {
+    close();
+    m_count = 0;
+    m_file = std::fopen(path, "w");
+    return m_status = m_file ? point_file_ok : point_file_open_failed;
+  }
+
+  /// Append the points of [first, last), one per line.
+  template <typename InputIterator>
+  point_file_status write(InputIterator first, InputIterator last)
+  {
+    if (m_status != point_file_ok) return m_status;
+    char buf[buffer_chars];
+    char* p = buf;
+    for (; first != last; ++first)
+    {
+      const point3d<T> q(static_cast<T>((*first).x()), static_cast<T>((*first).y()),
+                         static_cast<T>((*first).z()));
+      if (buf + buffer_chars - p < line_chars)
+      {
+        flush(buf, p);
+        p = buf;
+      }
+      p = to_chars(p, buf + buffer_chars, q);
+      *p++ = '\n';
+      ++m_count;
+    }
+    flush(buf, p);
+    return m_status;
+  }
+
+  /// Close the file.
+  point_file_status close()
+  {
+    if (!m_file) return m_status;
+    if (std::fclose(m_file) != 0) m_status = point_file_write_failed;
+    m_file = 0;
+    return m_status;
+  }
+
+  point_file_status status() const { return m_status; }
+
+  /// Number of points written so far.
+  std::size_t size() const { return m_count; }
+
+ private:
+
+  static const std::size_t buffer_chars = 1 << 16;
+  // longest line: three values, two separators and a newline
+  static const std::ptrdiff_t line_chars = static_cast<std::ptrdiff_t>(3*detail::max_scalar_chars + 3);
+
+  xyz_writer(const xyz_writer&);
+  xyz_writer& operator=(const xyz_writer&);
+
+  void flush(const char* first, const char* last)
+  {
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n != 0 && std::fwrite(first, 1, n, m_file) != n) m_status = point_file_write_failed;
+  }
+
+  std::FILE* m_file;
+  std::size_t m_count;
+  point_file_status m_status;
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT_FILE_IO_H_
@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT_REF_H_
+#define MINIMATH_POINT_REF_H_
+
+#include <cstddef>
+#include <iterator>
+#include <ostream>
+#include <tr1/type_traits>
+#include "minimath/type_traits.hpp"
+#include "minimath/point3d.hpp"
+
+//
+// Proxy reference to a 3D point whose x, y and z coordinates live in
+// separate memory locations, and a random access iterator yielding such
+// references. Used to present structure-of-arrays and strided buffers as
+// ranges of XYZ points.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+///
+/// Reference to the coordinates of a point stored elsewhere. S is the
+/// scalar type, const qualified for read-only references.
+/// point_ref satisfies is_point3d, so it can be passed to the generic
+/// functions of point3d_ops.hpp. Assignment writes through to the
+/// referenced coordinates.
+///
+template <typename S>
+class point_ref {
+
+ public:
+
+  typedef typename std::tr1::remove_const<S>::type value_type;
+  typedef value_type scalar_type;
+
+  point_ref(S* x, S* y, S* z) : m_x(x), m_y(y), m_z(z) {}
+
+  // conversion from a mutable to a read-only reference
+  template <typename S1>
+  point_ref(const point_ref<S1>& rhs) : m_x(rhs.x_ptr()), m_y(rhs.y_ptr()), m_z(rhs.z_ptr()) {}
+
+  value_type x() const { return *m_x; }
+  value_type y() const { return *m_y; }
+  value_type z() const { return *m_z; }
+
+  const point_ref& x(const value_type& x) const { *m_x = x; return *this; }
+  const point_ref& y(const value_type& y) const { *m_y = y; return *this; }
+  const point_ref& z(const value_type& z) const { *m_z = z; return *this; }
+
+  // assign the coordinates of the referenced point, not the reference
+  const point_ref& operator=(const point_ref& rhs) const
+  {
+    return assign(rhs.x(), rhs.y(), rhs.z());
+  }
+
+  template <typename P>
+  typename enable_if<is_point3d<P>::value, const point_ref&>::type
+  operator=(const P& rhs) const
+  {
+    return assign(rhs.x(), rhs.y(), rhs.z());
+  }
+
+  template <typename P>
+  bool operator==(const P& rhs) const { return equal(*this, rhs, 1); }
+
+  template <typename P>
+  bool operator!=(const P& rhs) const { return !(*this == rhs); }
+
+  S* x_ptr() const { return m_x; }
+  S* y_ptr() const { return m_y; }
+  S* z_ptr() const { return m_z; }
+
+ private:
+
+  const point_ref& assign(value_type x, value_type y, value_type z) const
+  {
+    *m_x = x;
+    *m_y = y;
+    *m_z = z;
+    return *this;
+  }
+
+  S* m_x;
+  S* m_y;
+  S* m_z;
+};
+
+template <typename S>
+std::ostream& operator<<(std::ostream& out, const point_ref<S>& p)
+{
+  return out << point3d<typename point_ref<S>::value_type>(p);
+}
+
+///
+/// Random access iterator over points with coordinates at x[i*stride],
+/// y[i*stride] and z[i*stride]. Dereferencing yields a point_ref.
+///
+template <typename S>
+class point_iterator {
+
+ public:
+
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef point3d<typename std::tr1::remove_const<S>::type> value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef void pointer;
+  typedef point_ref<S> reference;
+
+  point_iterator() : m_x(0), m_y(0), m_z(0), m_stride(1) {}
+
+  point_iterator(S* x, S* y, S* z, difference_type stride = 1)
+  :
+  m_x(x), m_y(y), m_z(z), m_stride(stride) {}
+
+  // conversion from a mutable to a read-only iterator
+  template <typename S1>
+  point_iterator(const point_iterator<S1>& rhs)
+  :
+  m_x(rhs.x_ptr()), m_y(rhs.y_ptr()), m_z(rhs.z_ptr()), m_stride(rhs.stride()) {}
+
+  reference operator*() const { return reference(m_x, m_y, m_z); }
+
+  reference operator[](difference_type n) const
+  {
+    const difference_type offset = n*m_stride;
+    return reference(m_x + offset, m_y + offset, m_z + offset);
+  }
+
+  point_iterator& operator+=(difference_type n)
+  {
+    const difference_type offset = n*m_stride;
+    m_x += offset;
+    m_y += offset;
+    m_z += offset;
+    return *this;
+  }
+
+  point_iterator& operator-=(difference_type n) { return *this += -n; }
+  point_iterator& operator++() { return *this += 1; }
+  point_iterator& operator--() { return *this += -1; }
+
+  point_iterator operator++(int)
+  {
+    point_iterator tmp(*this);
+    ++*this;
+    return tmp;
+  }
+
+  point_iterator operator--(int)
+  {
+    point_iterator tmp(*this);
+    --*this;
+    return tmp;
+  }
+
+  point_iterator operator+(difference_type n) const { return point_iterator(*this) += n; }
+  point_iterator operator-(difference_type n) const { return point_iterator(*this) -= n; }
+
+  difference_type operator-(const point_iterator& rhs) const
+  {
+    return (m_x - rhs.m_x)/m_stride;
+  }
+
+  bool operator==(const point_iterator& rhs) const { return m_x == rhs.m_x; }
+  bool operator!=(const point_iterator& rhs) const { return m_x != rhs.m_x; }
+  bool operator<(const point_iterator& rhs) const { return m_x < rhs.m_x; }
+  bool operator>(const point_iterator& rhs) const { return m_x > rhs.m_x; }
+  bool operator<=(const point_iterator& rhs) const { return m_x <= rhs.m_x; }
+  bool operator>=(const point_iterator& rhs) const { return m_x >= rhs.m_x; }
+
+  S* x_ptr() const { return m_x; }
+  S* y_ptr() const { return m_y; }
+  S* z_ptr() const { return m_z; }
+  difference_type stride() const { return m_stride; }
+
+ private:
+  S* m_x;
+  S* m_y;
+  S* m_z;
+  difference_type m_stride;
+};
+
+template <typename S>
+point_iterator<S> operator+(typename point_iterator<S>::difference_type n,
+                            const point_iterator<S>& it)
+{
+  return it + n;
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT_REF_H_
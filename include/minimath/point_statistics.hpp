@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT_STATISTICS_H_
+#define MINIMATH_POINT_STATISTICS_H_
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "minimath/type_traits.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/matrix.hpp"
+
+//
+// Centroid, scatter and covariance matrices of ranges of XYZ points, the
+// first step of alignment, PCA and plane fitting.
+//
+// The range is split into blocks of a fixed number of points. Each block
+// is summed serially, the blocks are summed in parallel when OpenMP is
+// enabled, and the block sums are then combined pairwise in a fixed
+// order. The order of the additions depends only on the number of
+// points, so the results are bit-identical for any number of threads.
+// Pairwise combination also keeps the rounding error growing with the
+// logarithm of the number of blocks rather than linearly.
+//
+// Ranges are given by random access iterators to is_point3d types, such
+// as pointers to point3d and the iterators of point_cloud and the point
+// views. Sums are accumulated in the scalar type of the points.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// points summed serially before the pairwise stage
+const std::size_t reduction_block_size = 512;
+
+// Sum of the points of a block
+template <typename T>
+struct point_sum_kernel
+{
+  static const unsigned int size = 3;
+
+  template <typename RandomAccessIterator>
+  void operator()(RandomAccessIterator first, RandomAccessIterator last, T* out) const
+  {
+    T sx = T(), sy = T(), sz = T();
+    for (; first != last; ++first)
+    {
+      sx += (*first).x();
+      sy += (*first).y();
+      sz += (*first).z();
+    }
+    out[0] = sx;
+    out[1] = sy;
+    out[2] = sz;
+  }
+};
+
+// Upper triangle of sum((p - c)*(p - c)^T) over the points of a block
+template <typename T>
+struct scatter_kernel
+{
+  static const unsigned int size = 6;
+
+  scatter_kernel(const point3d<T>& c) : m_c(c) {}
+
+  template <typename RandomAccessIterator>
+  void operator()(RandomAccessIterator first, RandomAccessIterator last, T* out) const
+  {
+    T xx = T(), xy = T(), xz = T(), yy = T(), yz = T(), zz = T();
+    for (; first != last; ++first)
+    {
+      const T dx = (*first).x() - m_c.x();
+      const T dy = (*first).y() - m_c.y();
+      const T dz = (*first).z() - m_c.z();
+      xx += dx*dx;
+      xy += dx*dy;
+      xz += dx*dz;
+      yy += dy*dy;
+      yz += dy*dz;
+      zz += dz*dz;
+    }
+    out[0] = xx;
+    out[1] = xy;
+    out[2] = xz;
+    out[3] = yy;
+    out[4] = yz;
+    out[5] = zz;
+  }
+
+ private:
+  point3d<T> m_c;
+};
+
+// Apply kernel to each block of [first, last) and combine the block sums
+// pairwise, writing Kernel::size sums to result. Zero for an empty range.
+template <typename T, typename RandomAccessIterator, typename Kernel>
+void block_reduce(RandomAccessIterator first, RandomAccessIterator last,
+                  const Kernel& kernel, T* result)
+{
+  const unsigned int N = Kernel::size;
+  const std::size_t n = static_cast<std::size_t>(last - first);
+  const std::size_t nBlocks = (n + reduction_block_size - 1)/reduction_block_size;
+  if (nBlocks == 0)
+  {
+    for (unsigned int k = 0; k < N; ++k) result[k] = T();
+    return;
+  }
+  std::vector<T> partial(nBlocks*N);
+  const long size = static_cast<long>(nBlocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long b = 0; b < size; ++b)
+  {
+    const std::size_t begin = static_cast<std::size_t>(b)*reduction_block_size;
+    const std::size_t end = begin + reduction_block_size < n ? begin + reduction_block_size : n;
+    kernel(first + static_cast<std::ptrdiff_t>(begin),
+           first + static_cast<std::ptrdiff_t>(end),
+           &partial[static_cast<std::size_t>(b)*N]);
+  }
+  for (std::size_t stride = 1; stride < nBlocks; stride *= 2)
+  {
+    for (std::size_t b = 0; b + stride < nBlocks; b += 2*stride)
+    {
+      for (unsigned int k = 0; k < N; ++k) partial[b*N + k] += partial[(b + stride)*N + k];
+    }
+  }
+  for (unsigned int k = 0; k < N; ++k) result[k] = partial[k];
+}
+
+template <typename RandomAccessIterator>
+struct point_scalar
+{
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type point_type;
+  typedef typename point_type::value_type type;
+};
+
+} // namespace detail
+
+///
+/// Centroid of the points in [first, last).
+/// The origin for an empty range.
+///
+template <typename RandomAccessIterator>
+point3d<typename detail::point_scalar<RandomAccessIterator>::type>
+centroid(RandomAccessIterator first, RandomAccessIterator last)
+{
+  typedef typename detail::point_scalar<RandomAccessIterator>::type T;
+  T s[3];
+  detail::block_reduce(first, last, detail::point_sum_kernel<T>(), s);
+  point3d<T> c(s[0], s[1], s[2]);
+  if (first != last) c /= static_cast<T>(last - first);
+  return c;
+}
+
+///
+/// Scatter matrix sum((p - c)*(p - c)^T) of the points in [first, last)
+/// about the point c. Zero for an empty range.
+///
+template <typename RandomAccessIterator>
+matrix<typename detail::point_scalar<RandomAccessIterator>::type, 3>
+scatter(RandomAccessIterator first,
+        RandomAccessIterator last,
+        const point3d<typename detail::point_scalar<RandomAccessIterator>::type>& c)
+{
+  typedef typename detail::point_scalar<RandomAccessIterator>::type T;
+  T s[6];
+  detail::block_reduce(first, last, detail::scatter_kernel<T>(c), s);
+  matrix<T,3> m;
+  m(0,0) = s[0];
+  m(0,1) = m(1,0) = s[1];
+  m(0,2) = m(2,0) = s[2];
+  m(1,1) = s[3];
+  m(1,2) = m(2,1) = s[4];
+  m(2,2) = s[5];
+  return m;
+}
+
+///
+/// Covariance matrix of the points in [first, last) about a precomputed
+/// centroid c, normalized by the number of points. Zero for an empty
+/// range.
+///
+template <typename RandomAccessIterator>
+matrix<typename detail::point_scalar<RandomAccessIterator>::type, 3>
+covariance(RandomAccessIterator first,
+           RandomAccessIterator last,
+           const point3d<typename detail::point_scalar<RandomAccessIterator>::type>& c)
+{
+  typedef typename detail::point_scalar<RandomAccessIterator>::type T;
+  matrix<T,3> m = scatter(first, last, c);
+  if (first != last)
+  {
+    const T n = static_cast<T>(last - first);
+    for (unsigned int i = 0; i < m.size(); ++i) m[i] /= n;
+  }
+  return m;
+}
+
+///
+/// Covariance matrix of the points in [first, last) about their centroid,
+/// normalized by the number of points. Zero for an empty range.
+///
+template <typename RandomAccessIterator>
+matrix<typename detail::point_scalar<RandomAccessIterator>::type, 3>
+covariance(RandomAccessIterator first, RandomAccessIterator last)
+{
+  return covariance(first, last, centroid(first, last));
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT_STATISTICS_H_
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_POINT_VIEW_H_
+#define MINIMATH_POINT_VIEW_H_
+
+#include <cstddef>
+#include "minimath/point_ref.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/transform3d.hpp"
+
+//
+// Non-owning views presenting external buffers of scalars as ranges of
+// XYZ points, without copying:
+//
+// - strided_point_view: point i has coordinates x[i*stride], y[i*stride]
+//   and z[i*stride]. Covers interleaved buffers, e.g. x y z intensity
+//   records with stride 4, and planar buffers (three arrays, stride 1).
+// - point_span: packed x y z triplets, stride 3.
+//
+// Elements are point_ref proxies, so writes go straight to the buffer and
+// transformations can be applied in place. S is the scalar type, const
+// qualified for read-only views. Strides are in elements, not bytes.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+template <typename S>
+class strided_point_view {
+
+ public:
+
+  typedef typename std::tr1::remove_const<S>::type scalar_type;
+  typedef point3d<scalar_type> value_type;
+  typedef point_ref<S> reference;
+  typedef point_iterator<S> iterator;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  strided_point_view() : m_first(), m_size(0) {}
+
+  strided_point_view(S* x, S* y, S* z, size_type n, difference_type stride = 1)
+  :
+  m_first(x, y, z, stride), m_size(n) {}
+
+  // conversion from a mutable to a read-only view
+  template <typename S1>
+  strided_point_view(const strided_point_view<S1>& rhs)
+  :
+  m_first(rhs.begin()), m_size(rhs.size()) {}
+
+  size_type size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  difference_type stride() const { return m_first.stride(); }
+
+  reference operator[](size_type i) const { return m_first[static_cast<difference_type>(i)]; }
+
+  iterator begin() const { return m_first; }
+  iterator end() const { return m_first + static_cast<difference_type>(m_size); }
+
+ private:
+  iterator m_first;
+  size_type m_size;
+};
+
+/// View of packed x y z triplets.
+template <typename S>
+class point_span : public strided_point_view<S> {
+
+ public:
+
+  point_span() {}
+
+  point_span(S* data, std::size_t n)
+  :
+  strided_point_view<S>(data, data + 1, data + 2, n, 3) {}
+};
+
+/// View n interleaved records of stride elements, with x, y and z the
+/// first three elements of each record.
+template <typename S>
+strided_point_view<S> interleaved_points(S* data, std::size_t n, std::ptrdiff_t stride = 3)
+{
+  return strided_point_view<S>(data, data + 1, data + 2, n, stride);
+}
+
+/// View n points held in three separate coordinate arrays.
+template <typename S>
+strided_point_view<S> planar_points(S* x, S* y, S* z, std::size_t n)
+{
+  return strided_point_view<S>(x, y, z, n, 1);
+}
+
+// ============================================================================
+// In place transformations
+
+///
+/// Apply the transformation held in a 3x4 matrix to all points of a view,
+/// in place.
+///
+template <typename T>
+void transform(const matrix<T,3,4>& m, const strided_point_view<T>& view)
+{
+  const T m00 = m(0,0), m01 = m(0,1), m02 = m(0,2), m03 = m(0,3);
+  const T m10 = m(1,0), m11 = m(1,1), m12 = m(1,2), m13 = m(1,3);
+  const T m20 = m(2,0), m21 = m(2,1), m22 = m(2,2), m23 = m(2,3);
+  typename strided_point_view<T>::iterator it = view.begin();
+  T* px = it.x_ptr();
+  T* py = it.y_ptr();
+  T* pz = it.z_ptr();
+  const std::ptrdiff_t stride = view.stride();
+  const std::size_t n = view.size();
+  for (std::size_t i = 0; i < n; ++i, px += stride, py += stride, pz += stride)
+  {
+    const T x = *px;
+    const T y = *py;
+    const T z = *pz;
+    *px = m00*x + m01*y + m02*z + m03;
+    *py = m10*x + m11*y + m12*z + m13;
+    *pz = m20*x + m21*y + m22*z + m23;
+  }
+}
+
+/// Apply a transform3d to all points of a view, in place.
+template <typename T>
+void transform(const transform3d<T>& t, const strided_point_view<T>& view)
+{
+  transform(to_matrix(t), view);
+}
+
+///
+/// Apply any transformation that can be applied to a point3d, such as
+/// rotation3d or translation3d, to all points of a view, in place.
+///
+template <typename Transform, typename T>
+void transform(const Transform& t, const strided_point_view<T>& view)
+{
+  typedef typename strided_point_view<T>::iterator iterator;
+  for (iterator it = view.begin(); it != view.end(); ++it)
+  {
+    *it = t*point3d<T>(*it);
+  }
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_POINT_VIEW_H_
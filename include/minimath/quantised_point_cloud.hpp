@@ -0,0 +1,430 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_QUANTISED_POINT_CLOUD_H_
+#define MINIMATH_QUANTISED_POINT_CLOUD_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/aligned_allocator.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_batch_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "minimath/transform3d.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//
+// Compact storage of XYZ points as 16 or 32 bit integers, for archiving
+// and transferring large clouds: 6 or 12 bytes per point instead of the 24
+// of point3d<double>.
+//
+// Points are quantised in blocks of B consecutive points. Each block has
+// an offset, the centre of its bounding box, and a scale, the size of one
+// integer step, and stores a point p as the integers nearest to
+// (p - offset)/scale. The scale is the smallest that fits the block in
+// the integer range, or the requested resolution if that is larger, so
+// the error is at most half a step along each axis.
+//
+// Coordinates are held as separate x, y and z integer arrays, which with
+// the block records are all there is to store, and all that is needed to
+// rebuild the cloud on loading. Decoding
+// and transform kernels fold the offset and scale of each block into the
+// transformation, converting the integers straight to transformed points
+// without an intermediate decoded cloud. Float kernels convert four points
+// at a time with SSE2, and blocks are processed in parallel when OpenMP
+// is enabled.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+/// Offset and scale of a block: point = offset + scale*(x, y, z).
+struct quantised_block
+{
+  point3d<double> offset;
+  double scale;
+};
+
+template <typename Int, unsigned int B = 1024>
+class quantised_point_cloud {
+
+ public:
+
+  typedef Int integer_type;
+  typedef std::vector<Int, aligned_allocator<Int> > array_type;
+  typedef std::size_t size_type;
+
+  static const unsigned int block_points = B;
+
+  quantised_point_cloud() : m_size(0) {}
+
+  ///
+  /// Quantise the points of [first, last), with steps of at least
+  /// resolution. A resolution of zero gives the finest steps that fit.
+  ///
+  template <typename InputIterator>
+  quantised_point_cloud(InputIterator first, InputIterator last, double resolution = 0.)
+  :
+  m_size(0)
+  {
+    assign(first, last, resolution);
+  }
+
+  /// Replace the contents with the quantised points of [first, last).
+  template <typename InputIterator>
+  void assign(InputIterator first, InputIterator last, double resolution = 0.)
+  {
+    clear();
+    // one block at a time, to bound the temporary storage
+    std::vector<point3d<double> > block;
+    block.reserve(B);
+    for (; first != last; ++first)
+    {
+      block.push_back(point3d<double>((*first).x(), (*first).y(), (*first).z()));
+      if (block.size() == B)
+      {
+        push_block(block, resolution);
+        block.clear();
+      }
+    }
+    if (!block.empty()) push_block(block, resolution);
+  }
+
+  ///
+  /// Rebuild a cloud from stored data: the x, y and z integer coordinates
+  /// of n points, and the records of their nBlocks blocks, as given by
+  /// x_data(), y_data(), z_data() and block_data(). success is set to
+  /// false, and the cloud left empty, if nBlocks is not the number of
+  /// blocks of n points or a block has a scale that is not positive.
+  ///
+  quantised_point_cloud(const Int* x, const Int* y, const Int* z, size_type n,
+                        const quantised_block* blocks, size_type nBlocks, bool& success)
+  :
+  m_size(0)
+  {
+    success = assign(x, y, z, n, blocks, nBlocks);
+  }
+
+  /// Replace the contents with stored data. Return false on size mismatch.
+  bool assign(const Int* x, const Int* y, const Int* z, size_type n,
+              const quantised_block* blocks, size_type nBlocks)
+  {
+    clear();
+    if (nBlocks != (n + B - 1)/B) return false;
+    for (size_type b = 0; b < nBlocks; ++b)
+    {
+      if (!(blocks[b].scale > 0.)) return false;
+    }
+    m_x.assign(x, x + n);
+    m_y.assign(y, y + n);
+    m_z.assign(z, z + n);
+    m_blocks.assign(blocks, blocks + nBlocks);
+    m_size = n;
+    return true;
+  }
+
+  size_type size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  void clear()
+  {
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_blocks.clear();
+    m_size = 0;
+  }
+
+  /// Number of blocks. Block b holds points [b*B, b*B + block_size(b)).
+  size_type block_count() const { return m_blocks.size(); }
+  size_type block_size(size_type b) const { return std::min(size_type(B), m_size - b*B); }
+  const quantised_block& block(size_type b) const { return m_blocks[b]; }
+
+  /// Decoded point i.
+  point3d<double> operator[](size_type i) const
+  {
+    const quantised_block& b = m_blocks[i/B];
+    point3d<double> p(static_cast<double>(m_x[i]), static_cast<double>(m_y[i]),
+                      static_cast<double>(m_z[i]));
+    p *= b.scale;
+    p += b.offset;
+    return p;
+  }
+
+  /// Integer coordinates, for storage and transfer.
+  const Int* x_data() const { return m_x.empty() ? 0 : &m_x[0]; }
+  const Int* y_data() const { return m_y.empty() ? 0 : &m_y[0]; }
+  const Int* z_data() const { return m_z.empty() ? 0 : &m_z[0]; }
+
+  /// Block records, block_count() of them, for storage and transfer.
+  const quantised_block* block_data() const { return m_blocks.empty() ? 0 : &m_blocks[0]; }
+
+ private:
+
+  void push_block(const std::vector<point3d<double> >& points, double resolution)
+  {
+    point3d<double> lo = points[0], hi = points[0];
+    for (size_type i = 1; i < points.size(); ++i)
+    {
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        lo[d] = std::min(lo[d], points[i][d]);
+        hi[d] = std::max(hi[d], points[i][d]);
+      }
+    }
+    const double maxInt = static_cast<double>(std::numeric_limits<Int>::max());
+    quantised_block b;
+    double half = 0.;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      b.offset[d] = lo[d] + (hi[d] - lo[d])/2;
+      half = std::max(half, std::max(hi[d] - b.offset[d], b.offset[d] - lo[d]));
+    }
+    b.scale = std::max(resolution, half/maxInt);
+    if (!(b.scale > 0.)) b.scale = 1.;
+    m_blocks.push_back(b);
+    const double inv = 1./b.scale;
+    for (size_type i = 0; i < points.size(); ++i)
+    {
+      m_x.push_back(quantise((points[i].x() - b.offset.x())*inv, maxInt));
+      m_y.push_back(quantise((points[i].y() - b.offset.y())*inv, maxInt));
+      m_z.push_back(quantise((points[i].z() - b.offset.z())*inv, maxInt));
+    }
+    m_size += points.size();
+  }
+
+  static Int quantise(double v, double maxInt)
+  {
+    const double r = std::floor(v + 0.5);
+    return static_cast<Int>(r < -maxInt ? -maxInt : r > maxInt ? maxInt : r);
+  }
+
+  array_type m_x;
+  array_type m_y;
+  array_type m_z;
+  std::vector<quantised_block> m_blocks;
+  size_type m_size;
+};
+
+// ============================================================================
+// Kernels
+
+namespace detail
+{
+
+// Destination of structure-of-arrays kernels
+template <typename T>
+struct soa_output
+{
+  soa_output(T* x_, T* y_, T* z_) : x(x_), y(y_), z(z_) {}
+  soa_output operator+(std::size_t i) const { return soa_output(x + i, y + i, z + i); }
+  T* x;
+  T* y;
+  T* z;
+};
+
+// m applied to offset + scale*q, as a 3x4 matrix acting on q, in row
+// major order. Computed in double.
+template <typename T>
+void block_matrix(const matrix<T,3,4>& m, const quantised_block& b, T out[12])
+{
+  for (unsigned int r = 0; r < 3; ++r)
+  {
+    double t = static_cast<double>(m(r,3));
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+      const double a = static_cast<double>(m(r,c));
+      out[4*r + c] = static_cast<T>(a*b.scale);
+      t += a*b.offset[c];
+    }
+    out[4*r + 3] = static_cast<T>(t);
+  }
+}
+
+template <typename T, typename Int>
+void affine_scalar(const T m[12], const Int* qx, const Int* qy, const Int* qz, std::size_t i,
+                   T& x, T& y, T& z)
+{
+  const T a = static_cast<T>(qx[i]);
+  const T b = static_cast<T>(qy[i]);
+  const T c = static_cast<T>(qz[i]);
+  x = m[0]*a + m[1]*b + m[2]*c + m[3];
+  y = m[4]*a + m[5]*b + m[6]*c + m[7];
+  z = m[8]*a + m[9]*b + m[10]*c + m[11];
+}
+
+template <typename T, typename Int>
+void affine_block(const T m[12], const Int* qx, const Int* qy, const Int* qz,
+                  std::size_t n, point3d<T>* out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    T x, y, z;
+    affine_scalar(m, qx, qy, qz, i, x, y, z);
+    out[i] = point3d<T>(x, y, z);
+  }
+}
+
+template <typename T, typename Int>
+void affine_block(const T m[12], const Int* qx, const Int* qy, const Int* qz,
+                  std::size_t n, soa_output<T> out)
+{
+  for (std::size_t i = 0; i < n; ++i) affine_scalar(m, qx, qy, qz, i, out.x[i], out.y[i], out.z[i]);
+}
+
+#if defined(__SSE2__)
+
+inline __m128 load_int4(const std::tr1::int16_t* q)
+{
+  const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q));
+  // sign extend to 32 bits
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+inline __m128 load_int4(const std::tr1::int32_t* q)
+{
+  return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(q)));
+}
+
+// row r of m applied to four points
+inline __m128 sse_affine_row(const float* m, __m128 x, __m128 y, __m128 z)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0]), x), _mm_mul_ps(_mm_set1_ps(m[1]), y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[2]), z), _mm_set1_ps(m[3])));
+}
+
+template <typename Int>
+void affine_block(const float m[12], const Int* qx, const Int* qy, const Int* qz,
+                  std::size_t n, point3d<float>* out)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 x = load_int4(qx + i), y = load_int4(qy + i), z = load_int4(qz + i);
+    store_points4(out + i, sse_affine_row(m, x, y, z), sse_affine_row(m + 4, x, y, z),
+                  sse_affine_row(m + 8, x, y, z));
+  }
+  for (; i < n; ++i)
+  {
+    float x, y, z;
+    affine_scalar(m, qx, qy, qz, i, x, y, z);
+    out[i] = point3d<float>(x, y, z);
+  }
+}
+
+template <typename Int>
+void affine_block(const float m[12], const Int* qx, const Int* qy, const Int* qz,
+                  std::size_t n, soa_output<float> out)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 x = load_int4(qx + i), y = load_int4(qy + i), z = load_int4(qz + i);
+    _mm_storeu_ps(out.x + i, sse_affine_row(m, x, y, z));
+    _mm_storeu_ps(out.y + i, sse_affine_row(m + 4, x, y, z));
+    _mm_storeu_ps(out.z + i, sse_affine_row(m + 8, x, y, z));
+  }
+  for (; i < n; ++i) affine_scalar(m, qx, qy, qz, i, out.x[i], out.y[i], out.z[i]);
+}
+
+#endif
+
+// m applied to points [first, first + n) of cloud, written to out[0, n)
+template <typename T, typename Int, unsigned int B, typename Output>
+void quantised_affine(const matrix<T,3,4>& m, const quantised_point_cloud<Int,B>& cloud,
+                      std::size_t first, std::size_t n, Output out)
+{
+  if (n == 0) return;
+  const std::size_t firstBlock = first/B;
+  const long nBlocks = static_cast<long>((first + n - 1)/B - firstBlock + 1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long j = 0; j < nBlocks; ++j)
+  {
+    const std::size_t b = firstBlock + static_cast<std::size_t>(j);
+    const std::size_t begin = std::max(first, b*B);
+    const std::size_t end = std::min(first + n, b*B + B);
+    T mb[12];
+    block_matrix(m, cloud.block(b), mb);
+    affine_block(mb, cloud.x_data() + begin, cloud.y_data() + begin, cloud.z_data() + begin,
+                 end - begin, out + (begin - first));
+  }
+}
+
+} // namespace detail
+
+/// Decode points [first, first + n) of cloud to out[0, n).
+template <typename T, typename Int, unsigned int B>
+void decode(const quantised_point_cloud<Int,B>& cloud, std::size_t first, std::size_t n,
+            point3d<T>* out)
+{
+  detail::quantised_affine(matrix<T,3,4>(identity_matrix()), cloud, first, n, out);
+}
+
+/// Decode all points of cloud to out[0, cloud.size()).
+template <typename T, typename Int, unsigned int B>
+void decode(const quantised_point_cloud<Int,B>& cloud, point3d<T>* out)
+{
+  decode(cloud, 0, cloud.size(), out);
+}
+
+/// Decode all points of cloud to out, which is resized to cloud.size().
+template <typename T, typename Int, unsigned int B>
+void decode(const quantised_point_cloud<Int,B>& cloud, point_cloud<T>& out)
+{
+  out.resize(cloud.size());
+  detail::quantised_affine(matrix<T,3,4>(identity_matrix()), cloud, 0, cloud.size(),
+                           detail::soa_output<T>(out.x_data(), out.y_data(), out.z_data()));
+}
+
+///
+/// out[i] = m*cloud[i], the 4th column of m being the translation, for all
+/// points of cloud, without decoding them first.
+///
+template <typename T, typename Int, unsigned int B>
+void transform(const matrix<T,3,4>& m, const quantised_point_cloud<Int,B>& cloud, point3d<T>* out)
+{
+  detail::quantised_affine(m, cloud, 0, cloud.size(), out);
+}
+
+/// As above, writing to out, which is resized to cloud.size().
+template <typename T, typename Int, unsigned int B>
+void transform(const matrix<T,3,4>& m, const quantised_point_cloud<Int,B>& cloud, point_cloud<T>& out)
+{
+  out.resize(cloud.size());
+  detail::quantised_affine(m, cloud, 0, cloud.size(),
+                           detail::soa_output<T>(out.x_data(), out.y_data(), out.z_data()));
+}
+
+/// out[i] = t*cloud[i] for all points of cloud.
+template <typename T, typename Int, unsigned int B>
+void transform(const transform3d<T>& t, const quantised_point_cloud<Int,B>& cloud, point3d<T>* out)
+{
+  transform(to_matrix(t), cloud, out);
+}
+
+/// As above, writing to out, which is resized to cloud.size().
+template <typename T, typename Int, unsigned int B>
+void transform(const transform3d<T>& t, const quantised_point_cloud<Int,B>& cloud, point_cloud<T>& out)
+{
+  transform(to_matrix(t), cloud, out);
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_QUANTISED_POINT_CLOUD_H_
@@ -0,0 +1,515 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_SPACE_FILLING_CURVES_H_
+#define MINIMATH_SPACE_FILLING_CURVES_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/point3d.hpp"
+#include "minimath/point_cloud.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//
+// Morton (Z order) and Hilbert keys of XYZ points, and reordering of point
+// arrays along these curves, so that points close in space are close in
+// memory and spatial queries and transformations stay in cache.
+//
+// Keys are computed on a grid of 2^10 (30 bit keys) or 2^21 (63 bit keys)
+// cells along each axis of a bounding box. Hilbert keys take longer to
+// compute than Morton keys, but consecutive Hilbert keys are always
+// neighbouring cells, which gives somewhat better locality.
+//
+// Points are sorted by key with a parallel least significant digit radix
+// sort. It is stable, so the result does not depend on the number of
+// threads. The permutation it produces can be applied to attribute arrays
+// with reorder.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// 64 bit constant from two 32 bit halves, avoiding long long literals
+inline std::tr1::uint64_t make_uint64(std::tr1::uint32_t hi, std::tr1::uint32_t lo)
+{
+  return (static_cast<std::tr1::uint64_t>(hi) << 32) | lo;
+}
+
+// Spread the lower 10 bits of x to every third bit
+inline std::tr1::uint32_t morton_spread10(std::tr1::uint32_t x)
+{
+  x &= 0x3ff;
+  x = (x | x << 16) & 0x030000ff;
+  x = (x | x << 8)  & 0x0300f00f;
+  x = (x | x << 4)  & 0x030c30c3;
+  x = (x | x << 2)  & 0x09249249;
+  return x;
+}
+
+// Inverse of morton_spread10
+inline std::tr1::uint32_t morton_compact10(std::tr1::uint32_t x)
+{
+  x &= 0x09249249;
+  x = (x | x >> 2)  & 0x030c30c3;
+  x = (x | x >> 4)  & 0x0300f00f;
+  x = (x | x >> 8)  & 0x030000ff;
+  x = (x | x >> 16) & 0x3ff;
+  return x;
+}
+
+// Spread the lower 21 bits of x to every third bit
+inline std::tr1::uint64_t morton_spread21(std::tr1::uint64_t x)
+{
+  x &= 0x1fffff;
+  x = (x | x << 32) & make_uint64(0x001f0000, 0x0000ffff);
+  x = (x | x << 16) & make_uint64(0x001f0000, 0xff0000ff);
+  x = (x | x << 8)  & make_uint64(0x100f00f0, 0x0f00f00f);
+  x = (x | x << 4)  & make_uint64(0x10c30c30, 0xc30c30c3);
+  x = (x | x << 2)  & make_uint64(0x12492492, 0x49249249);
+  return x;
+}
+
+// Inverse of morton_spread21
+inline std::tr1::uint32_t morton_compact21(std::tr1::uint64_t x)
+{
+  x &= make_uint64(0x12492492, 0x49249249);
+  x = (x | x >> 2)  & make_uint64(0x10c30c30, 0xc30c30c3);
+  x = (x | x >> 4)  & make_uint64(0x100f00f0, 0x0f00f00f);
+  x = (x | x >> 8)  & make_uint64(0x001f0000, 0xff0000ff);
+  x = (x | x >> 16) & make_uint64(0x001f0000, 0x0000ffff);
+  x = (x | x >> 32) & 0x1fffff;
+  return static_cast<std::tr1::uint32_t>(x);
+}
+
+// Hilbert curve coordinates of b bit cell coordinates, in place, following
+// J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004).
+// The bits of the curve index are the bits of the transposed coordinates,
+// taken from the most significant down, x first.
+inline void hilbert_transpose(std::tr1::uint32_t X[3], unsigned int b)
+{
+  const std::tr1::uint32_t M = std::tr1::uint32_t(1) << (b - 1);
+  for (std::tr1::uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    const std::tr1::uint32_t P = Q - 1;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (X[i] & Q)
+      {
+        X[0] ^= P;
+      }
+      else
+      {
+        const std::tr1::uint32_t t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  X[1] ^= X[0];
+  X[2] ^= X[1];
+  std::tr1::uint32_t t = 0;
+  for (std::tr1::uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    if (X[2] & Q) t ^= Q - 1;
+  }
+  for (unsigned int i = 0; i < 3; ++i) X[i] ^= t;
+}
+
+// Inverse of hilbert_transpose
+inline void hilbert_untranspose(std::tr1::uint32_t X[3], unsigned int b)
+{
+  const std::tr1::uint32_t N = std::tr1::uint32_t(2) << (b - 1);
+  std::tr1::uint32_t t = X[2] >> 1;
+  X[2] ^= X[1];
+  X[1] ^= X[0];
+  X[0] ^= t;
+  for (std::tr1::uint32_t Q = 2; Q != N; Q <<= 1)
+  {
+    const std::tr1::uint32_t P = Q - 1;
+    for (unsigned int i = 3; i-- > 0; )
+    {
+      if (X[i] & Q)
+      {
+        X[0] ^= P;
+      }
+      else
+      {
+        t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+}
+
+} // namespace detail
+
+// ============================================================================
+// Keys of cell coordinates
+
+/// 30 bit Morton key of 10 bit cell coordinates, x in the lowest bit.
+inline std::tr1::uint32_t morton_encode30(std::tr1::uint32_t x, std::tr1::uint32_t y,
+                                          std::tr1::uint32_t z)
+{
+  using namespace detail;
+  return morton_spread10(x) | morton_spread10(y) << 1 | morton_spread10(z) << 2;
+}
+
+inline void morton_decode30(std::tr1::uint32_t key, std::tr1::uint32_t& x,
+                            std::tr1::uint32_t& y, std::tr1::uint32_t& z)
+{
+  x = detail::morton_compact10(key);
+  y = detail::morton_compact10(key >> 1);
+  z = detail::morton_compact10(key >> 2);
+}
+
+/// 63 bit Morton key of 21 bit cell coordinates, x in the lowest bit.
+inline std::tr1::uint64_t morton_encode63(std::tr1::uint32_t x, std::tr1::uint32_t y,
+                                          std::tr1::uint32_t z)
+{
+  using namespace detail;
+  return morton_spread21(x) | morton_spread21(y) << 1 | morton_spread21(z) << 2;
+}
+
+inline void morton_decode63(std::tr1::uint64_t key, std::tr1::uint32_t& x,
+                            std::tr1::uint32_t& y, std::tr1::uint32_t& z)
+{
+  x = detail::morton_compact21(key);
+  y = detail::morton_compact21(key >> 1);
+  z = detail::morton_compact21(key >> 2);
+}
+
+/// 30 bit Hilbert key of 10 bit cell coordinates.
+inline std::tr1::uint32_t hilbert_encode30(std::tr1::uint32_t x, std::tr1::uint32_t y,
+                                           std::tr1::uint32_t z)
+{
+  std::tr1::uint32_t X[3] = { x & 0x3ff, y & 0x3ff, z & 0x3ff };
+  detail::hilbert_transpose(X, 10);
+  return morton_encode30(X[2], X[1], X[0]);
+}
+
+inline void hilbert_decode30(std::tr1::uint32_t key, std::tr1::uint32_t& x,
+                             std::tr1::uint32_t& y, std::tr1::uint32_t& z)
+{
+  std::tr1::uint32_t X[3];
+  morton_decode30(key, X[2], X[1], X[0]);
+  detail::hilbert_untranspose(X, 10);
+  x = X[0];
+  y = X[1];
+  z = X[2];
+}
+
+/// 63 bit Hilbert key of 21 bit cell coordinates.
+inline std::tr1::uint64_t hilbert_encode63(std::tr1::uint32_t x, std::tr1::uint32_t y,
+                                           std::tr1::uint32_t z)
+{
+  std::tr1::uint32_t X[3] = { x & 0x1fffff, y & 0x1fffff, z & 0x1fffff };
+  detail::hilbert_transpose(X, 21);
+  return morton_encode63(X[2], X[1], X[0]);
+}
+
+inline void hilbert_decode63(std::tr1::uint64_t key, std::tr1::uint32_t& x,
+                             std::tr1::uint32_t& y, std::tr1::uint32_t& z)
+{
+  std::tr1::uint32_t X[3];
+  morton_decode63(key, X[2], X[1], X[0]);
+  detail::hilbert_untranspose(X, 21);
+  x = X[0];
+  y = X[1];
+  z = X[2];
+}
+
+// ============================================================================
+// Keys of points
+
+namespace detail
+{
+
+struct morton_curve
+{
+  template <typename Key>
+  static Key encode(std::tr1::uint32_t x, std::tr1::uint32_t y, std::tr1::uint32_t z, Key*)
+  {
+    return sizeof(Key) == 4 ? Key(morton_encode30(x, y, z)) : Key(morton_encode63(x, y, z));
+  }
+};
+
+struct hilbert_curve
+{
+  template <typename Key>
+  static Key encode(std::tr1::uint32_t x, std::tr1::uint32_t y, std::tr1::uint32_t z, Key*)
+  {
+    return sizeof(Key) == 4 ? Key(hilbert_encode30(x, y, z)) : Key(hilbert_encode63(x, y, z));
+  }
+};
+
+// Keys of [first, last) on a grid over the box [min, max]: 10 bits per
+// axis for 32 bit keys, 21 for 64 bit keys. Points outside the box are
+// clamped to it.
+template <typename Curve, typename RandomAccessIterator, typename T, typename Key>
+void curve_keys(RandomAccessIterator first, RandomAccessIterator last,
+                const point3d<T>& min, const point3d<T>& max, Key* out)
+{
+  const unsigned int bits = sizeof(Key) == 4 ? 10 : 21;
+  const std::tr1::uint32_t maxCell = (std::tr1::uint32_t(1) << bits) - 1;
+  const T cells = static_cast<T>(std::tr1::uint32_t(1) << bits);
+  T scale[3];
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    const T extent = max[d] - min[d];
+    scale[d] = T() < extent ? cells/extent : T();
+  }
+  const long size = static_cast<long>(last - first);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long i = 0; i < size; ++i)
+  {
+    const point3d<T> p(first[i].x(), first[i].y(), first[i].z());
+    std::tr1::uint32_t c[3];
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      const T q = (p[d] - min[d])*scale[d];
+      c[d] = q < T() ? 0 : q < cells ? static_cast<std::tr1::uint32_t>(q) : maxCell;
+    }
+    out[i] = Curve::encode(c[0], c[1], c[2], static_cast<Key*>(0));
+  }
+}
+
+// Bounding box of n > 0 points
+template <typename RandomAccessIterator, typename T>
+void bounds(RandomAccessIterator first, std::size_t n, point3d<T>& min, point3d<T>& max)
+{
+  min = max = point3d<T>(first[0].x(), first[0].y(), first[0].z());
+  for (std::size_t i = 1; i < n; ++i)
+  {
+    const point3d<T> p(first[i].x(), first[i].y(), first[i].z());
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      if (p[d] < min[d]) min[d] = p[d];
+      if (max[d] < p[d]) max[d] = p[d];
+    }
+  }
+}
+
+} // namespace detail
+
+///
+/// 30 or 63 bit Morton keys, depending on the key type, of the points of
+/// [first, last) on a grid over the box [min, max]. Points outside the
+/// box are clamped to it.
+///
+template <typename RandomAccessIterator, typename T>
+void morton_keys(RandomAccessIterator first, RandomAccessIterator last,
+                 const point3d<T>& min, const point3d<T>& max, std::tr1::uint32_t* out)
+{
+  detail::curve_keys<detail::morton_curve>(first, last, min, max, out);
+}
+
+template <typename RandomAccessIterator, typename T>
+void morton_keys(RandomAccessIterator first, RandomAccessIterator last,
+                 const point3d<T>& min, const point3d<T>& max, std::tr1::uint64_t* out)
+{
+  detail::curve_keys<detail::morton_curve>(first, last, min, max, out);
+}
+
+///
+/// 30 or 63 bit Hilbert keys, depending on the key type, of the points of
+/// [first, last) on a grid over the box [min, max]. Points outside the
+/// box are clamped to it.
+///
+template <typename RandomAccessIterator, typename T>
+void hilbert_keys(RandomAccessIterator first, RandomAccessIterator last,
+                  const point3d<T>& min, const point3d<T>& max, std::tr1::uint32_t* out)
+{
+  detail::curve_keys<detail::hilbert_curve>(first, last, min, max, out);
+}
+
+template <typename RandomAccessIterator, typename T>
+void hilbert_keys(RandomAccessIterator first, RandomAccessIterator last,
+                  const point3d<T>& min, const point3d<T>& max, std::tr1::uint64_t* out)
+{
+  detail::curve_keys<detail::hilbert_curve>(first, last, min, max, out);
+}
+
+// ============================================================================
+// Sorting and reordering
+
+///
+/// Stable sort of n unsigned integer keys, without moving them: perm[i]
+/// is set to the position of the i-th smallest key. Byte wise radix sort,
+/// histogramming and scattering chunks of keys in parallel when OpenMP is
+/// enabled. Passes over bytes that are equal in all keys are skipped.
+///
+template <typename Key>
+void radix_sort_permutation(const Key* keys, std::size_t n, std::size_t* perm)
+{
+  std::vector<Key> k0(keys, keys + n), k1(n);
+  std::vector<std::size_t> p0(n), p1(n);
+  for (std::size_t i = 0; i < n; ++i) p0[i] = i;
+#ifdef _OPENMP
+  const std::size_t nChunks = static_cast<std::size_t>(omp_get_max_threads());
+#else
+  const std::size_t nChunks = 1;
+#endif
+  const std::size_t chunk = (n + nChunks - 1)/nChunks;
+  const long nc = static_cast<long>(nChunks);
+  std::vector<std::size_t> counts(nChunks*256);
+  for (unsigned int shift = 0; shift < 8*sizeof(Key); shift += 8)
+  {
+    std::fill(counts.begin(), counts.end(), 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long c = 0; c < nc; ++c)
+    {
+      const std::size_t uc = static_cast<std::size_t>(c);
+      std::size_t* row = &counts[uc*256];
+      const std::size_t end = std::min(n, (uc + 1)*chunk);
+      for (std::size_t i = uc*chunk; i < end; ++i) ++row[(k0[i] >> shift) & 0xff];
+    }
+    // chunk c writes its keys of digit d from counts[c*256 + d] on
+    std::size_t total = 0;
+    bool trivial = false;
+    for (unsigned int d = 0; d < 256 && !trivial; ++d)
+    {
+      const std::size_t start = total;
+      for (std::size_t c = 0; c < nChunks; ++c)
+      {
+        const std::size_t count = counts[c*256 + d];
+        counts[c*256 + d] = total;
+        total += count;
+      }
+      trivial = total - start == n;
+    }
+    if (trivial) continue;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long c = 0; c < nc; ++c)
+    {
+      const std::size_t uc = static_cast<std::size_t>(c);
+      std::size_t* row = &counts[uc*256];
+      const std::size_t end = std::min(n, (uc + 1)*chunk);
+      for (std::size_t i = uc*chunk; i < end; ++i)
+      {
+        const std::size_t j = row[(k0[i] >> shift) & 0xff]++;
+        k1[j] = k0[i];
+        p1[j] = p0[i];
+      }
+    }
+    k0.swap(k1);
+    p0.swap(p1);
+  }
+  std::copy(p0.begin(), p0.end(), perm);
+}
+
+///
+/// Reorder n elements of data so that element i becomes the old element
+/// perm[i], as given by radix_sort_permutation or the sorting functions
+/// below. Use it to carry attribute arrays along with their points.
+///
+template <typename T>
+void reorder(const std::size_t* perm, std::size_t n, T* data)
+{
+  std::vector<T> tmp(n);
+  const long size = static_cast<long>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long i = 0; i < size; ++i)
+  {
+    tmp[static_cast<std::size_t>(i)] = data[perm[i]];
+  }
+  std::copy(tmp.begin(), tmp.end(), data);
+}
+
+namespace detail
+{
+
+template <typename Curve, typename T>
+void curve_sort(point3d<T>* p, std::size_t n, std::size_t* perm)
+{
+  if (n == 0) return;
+  point3d<T> min, max;
+  bounds(p, n, min, max);
+  std::vector<std::tr1::uint64_t> keys(n);
+  curve_keys<Curve>(p, p + n, min, max, &keys[0]);
+  std::vector<std::size_t> order(n);
+  radix_sort_permutation(&keys[0], n, &order[0]);
+  reorder(&order[0], n, p);
+  if (perm) std::copy(order.begin(), order.end(), perm);
+}
+
+template <typename Curve, typename T>
+void curve_sort(point_cloud<T>& cloud, std::size_t* perm)
+{
+  const std::size_t n = cloud.size();
+  if (n == 0) return;
+  point3d<T> min, max;
+  bounds(cloud.begin(), n, min, max);
+  std::vector<std::tr1::uint64_t> keys(n);
+  curve_keys<Curve>(cloud.begin(), cloud.end(), min, max, &keys[0]);
+  std::vector<std::size_t> order(n);
+  radix_sort_permutation(&keys[0], n, &order[0]);
+  reorder(&order[0], n, cloud.x_data());
+  reorder(&order[0], n, cloud.y_data());
+  reorder(&order[0], n, cloud.z_data());
+  if (perm) std::copy(order.begin(), order.end(), perm);
+}
+
+} // namespace detail
+
+///
+/// Sort p[0, n) in place along the Morton curve over their bounding box,
+/// using 63 bit keys. If perm is not null, the old position of each point
+/// is written to it, for use with reorder.
+///
+template <typename T>
+void morton_sort(point3d<T>* p, std::size_t n, std::size_t* perm = 0)
+{
+  detail::curve_sort<detail::morton_curve>(p, n, perm);
+}
+
+/// Sort the points of a cloud in place along the Morton curve.
+template <typename T>
+void morton_sort(point_cloud<T>& cloud, std::size_t* perm = 0)
+{
+  detail::curve_sort<detail::morton_curve>(cloud, perm);
+}
+
+///
+/// Sort p[0, n) in place along the Hilbert curve over their bounding box,
+/// using 63 bit keys. If perm is not null, the old position of each point
+/// is written to it, for use with reorder.
+///
+template <typename T>
+void hilbert_sort(point3d<T>* p, std::size_t n, std::size_t* perm = 0)
+{
+  detail::curve_sort<detail::hilbert_curve>(p, n, perm);
+}
+
+/// Sort the points of a cloud in place along the Hilbert curve.
+template <typename T>
+void hilbert_sort(point_cloud<T>& cloud, std::size_t* perm = 0)
+{
+  detail::curve_sort<detail::hilbert_curve>(cloud, perm);
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_SPACE_FILLING_CURVES_H_
@@ -0,0 +1,270 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_SPATIAL_HASH_GRID_H_
+#define MINIMATH_SPATIAL_HASH_GRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/aligned_allocator.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/kd_tree.hpp" // for kd_neighbour
+#include "minimath/space_filling_curves.hpp" // for radix_sort_permutation
+
+//
+// Uniform grid of cubic cells over a set of XYZ points, for fixed radius
+// neighbour queries on dense, evenly spread clouds.
+//
+// Cells are hashed into a table of about as many buckets as points, so
+// memory does not depend on the extent of the cloud. The points are radix
+// sorted by bucket: the points of a bucket are a contiguous run of x, y
+// and z arrays, found through an offsets table. The sort runs in parallel
+// over chunks of points when OpenMP is enabled, and is stable, so the
+// layout does not depend on the number of threads.
+//
+// A radius query scans the buckets of the cells overlapping the query
+// sphere, checking each point with its squared distance. Distinct cells
+// sharing a bucket only cost extra distance checks. Queries are fastest
+// with the cell size close to the query radius.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+template <typename T>
+class spatial_hash_grid {
+
+ public:
+
+  typedef T value_type;
+  typedef point3d<T> point_type;
+  typedef kd_neighbour<T> neighbour;
+  typedef std::size_t size_type;
+
+  spatial_hash_grid() : m_cell(1), m_inv_cell(1), m_mask(0), m_offsets(2, 0) {}
+
+  ///
+  /// Build a grid of cells of side cell_size over the points of [first, last).
+  /// The grid is left empty if cell_size is not positive.
+  ///
+  template <typename InputIterator>
+  spatial_hash_grid(InputIterator first, InputIterator last, T cell_size)
+  :
+  m_cell(1), m_inv_cell(1), m_mask(0), m_offsets(2, 0)
+  {
+    build(first, last, cell_size);
+  }
+
+  ///
+  /// Rebuild the grid over the points of [first, last). Return false,
+  /// leaving the grid empty, if cell_size is not positive.
+  ///
+  template <typename InputIterator>
+  bool build(InputIterator first, InputIterator last, T cell_size)
+  {
+    if (!(T(0) < cell_size))
+    {
+      *this = spatial_hash_grid();
+      return false;
+    }
+    array_type x, y, z;
+    for (; first != last; ++first)
+    {
+      x.push_back((*first).x());
+      y.push_back((*first).y());
+      z.push_back((*first).z());
+    }
+    m_cell = cell_size;
+    m_inv_cell = T(1)/cell_size;
+    build(x, y, z);
+    return true;
+  }
+
+  size_type size() const { return m_index.size(); }
+  bool empty() const { return m_index.empty(); }
+
+  T cell_size() const { return m_cell; }
+
+  /// Number of hash buckets, a power of two.
+  size_type buckets() const { return m_offsets.size() - 1; }
+
+  ///
+  /// Append to out the points within distance r of q, in no particular
+  /// order. Return the number of points appended.
+  ///
+  template <typename P>
+  size_type radius(const P& q, T r, std::vector<neighbour>& out) const
+  {
+    const size_type n = out.size();
+    if (empty()) return 0;
+    const point_type p(q.x(), q.y(), q.z());
+    const T r2 = r*r;
+    long lo[3], hi[3];
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      lo[d] = cell(p[d] - r);
+      hi[d] = cell(p[d] + r);
+    }
+    const double nCells = double(hi[0] - lo[0] + 1)*double(hi[1] - lo[1] + 1)*double(hi[2] - lo[2] + 1);
+    if (nCells >= double(buckets()))
+    {
+      scan(0, size(), p, r2, out);
+      return out.size() - n;
+    }
+    // distinct buckets of the overlapped cells
+    std::vector<size_type> b;
+    b.reserve(static_cast<size_type>(nCells));
+    for (long i = lo[0]; i <= hi[0]; ++i)
+      for (long j = lo[1]; j <= hi[1]; ++j)
+        for (long k = lo[2]; k <= hi[2]; ++k) b.push_back(bucket(i, j, k));
+    std::sort(b.begin(), b.end());
+    b.erase(std::unique(b.begin(), b.end()), b.end());
+    for (size_type i = 0; i < b.size(); ++i)
+    {
+      scan(m_offsets[b[i]], m_offsets[b[i] + 1], p, r2, out);
+    }
+    return out.size() - n;
+  }
+
+  ///
+  /// Points within distance r of each query point of [first, last),
+  /// processed in parallel. out is resized to the number of queries and
+  /// out[i] holds the results of query i.
+  ///
+  template <typename RandomAccessIterator>
+  void radius(RandomAccessIterator first, RandomAccessIterator last, T r,
+              std::vector<std::vector<neighbour> >& out) const
+  {
+    const long size = static_cast<long>(last - first);
+    out.resize(static_cast<size_type>(size));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      std::vector<neighbour>& result = out[static_cast<size_type>(i)];
+      result.clear();
+      radius(first[i], r, result);
+    }
+  }
+
+ private:
+
+  typedef std::vector<T, aligned_allocator<T> > array_type;
+
+  // cell coordinate, clamped so that the conversion to long is defined
+  // for any c, including huge and NaN values
+  long cell(T c) const
+  {
+    using std::floor;
+    const T limit = T(1 << 30);
+    const T q = floor(c*m_inv_cell);
+    return q < limit ? (q > -limit ? static_cast<long>(q) : -(1L << 30)) : 1L << 30;
+  }
+
+  size_type bucket(long i, long j, long k) const
+  {
+    const unsigned long h = static_cast<unsigned long>(i)*73856093ul ^
+                            static_cast<unsigned long>(j)*19349663ul ^
+                            static_cast<unsigned long>(k)*83492791ul;
+    return static_cast<size_type>(h) & m_mask;
+  }
+
+  void scan(size_type begin, size_type end, const point_type& q, T r2,
+            std::vector<neighbour>& out) const
+  {
+    for (size_type i = begin; i < end; ++i)
+    {
+      const T dx = m_x[i] - q.x();
+      const T dy = m_y[i] - q.y();
+      const T dz = m_z[i] - q.z();
+      const T d2 = dx*dx + dy*dy + dz*dz;
+      if (!(r2 < d2)) out.push_back(neighbour(m_index[i], d2));
+    }
+  }
+
+  void build(const array_type& x, const array_type& y, const array_type& z)
+  {
+    const size_type n = x.size();
+    size_type nBuckets = 1;
+    while (nBuckets < n) nBuckets *= 2;
+    m_mask = nBuckets - 1;
+    // narrow keys save the radix sort passes over their zero high bytes
+    if (m_mask <= 0xfffffffful)
+    {
+      sort_points<std::tr1::uint32_t>(x, y, z);
+    }
+    else
+    {
+      sort_points<size_type>(x, y, z);
+    }
+  }
+
+  template <typename Key>
+  void sort_points(const array_type& x, const array_type& y, const array_type& z)
+  {
+    const size_type n = x.size();
+    std::vector<Key> keys(n);
+    const long size = static_cast<long>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      const size_type u = static_cast<size_type>(i);
+      keys[u] = static_cast<Key>(bucket(cell(x[u]), cell(y[u]), cell(z[u])));
+    }
+
+    // stable radix sort by bucket, with histograms of 256 digits per
+    // thread, so the extra memory does not grow with the bucket count
+    m_index.resize(n);
+    if (n != 0) radix_sort_permutation(&keys[0], n, &m_index[0]);
+
+    // bucket b starts at the first point of key b or more
+    m_offsets.assign(m_mask + 2, n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      const size_type u = static_cast<size_type>(i);
+      const size_type key = keys[m_index[u]];
+      const size_type b = u == 0 ? 0 : static_cast<size_type>(keys[m_index[u - 1]]) + 1;
+      for (size_type k = b; k <= key; ++k) m_offsets[k] = u;
+    }
+
+    m_x.resize(n);
+    m_y.resize(n);
+    m_z.resize(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < size; ++i)
+    {
+      const size_type u = static_cast<size_type>(i);
+      m_x[u] = x[m_index[u]];
+      m_y[u] = y[m_index[u]];
+      m_z[u] = z[m_index[u]];
+    }
+  }
+
+  T m_cell;
+  T m_inv_cell;
+  size_type m_mask;
+  std::vector<size_type> m_offsets; // first point of each bucket, plus the end
+  std::vector<size_type> m_index;   // build range position of each point
+  array_type m_x, m_y, m_z;         // points in bucket order
+};
+
+} // namespace minimath
+
+#endif // MINIMATH_SPATIAL_HASH_GRID_H_
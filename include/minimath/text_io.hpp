@@ -0,0 +1,252 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_TEXT_IO_H_
+#define MINIMATH_TEXT_IO_H_
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <tr1/cstdint>
+#include "minimath/matrix.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/transform3d.hpp"
+
+//
+// Text formatting and parsing of matrices, points and transforms into and
+// out of caller supplied character buffers, without iostreams.
+//
+// Values are written with enough digits (17 for double, 9 for float) to be
+// read back exactly, using the C locale conventions of the C library.
+// Elements are written in row-major order, separated by a single separator
+// character, with no trailing separator or newline. A transform3d is
+// written as the 12 elements of its 3x4 matrix.
+//
+// The formatters return a pointer one past the last character written, or
+// 0 if the buffer is too small. The parsers accept elements separated by
+// any mix of white space, commas and semicolons, and return a pointer one
+// past the last character parsed, or 0 on error. No terminating null
+// character is written or required. Short plain decimal values, the bulk
+// of most point files, are converted without calling strtod.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+namespace detail
+{
+
+// longest value written by format_scalar, "-1.2345678901234567e-308"
+const std::size_t max_scalar_chars = 32;
+
+inline char* copy_chars(char* first, char* last, const char* buf, int n)
+{
+  if (n <= 0 || last - first < n) return 0;
+  std::memcpy(first, buf, static_cast<std::size_t>(n));
+  return first + n;
+}
+
+inline char* format_scalar(char* first, char* last, double value)
+{
+  char buf[max_scalar_chars];
+  return copy_chars(first, last, buf, std::sprintf(buf, "%.17g", value));
+}
+
+inline char* format_scalar(char* first, char* last, float value)
+{
+  char buf[max_scalar_chars];
+  return copy_chars(first, last, buf, std::sprintf(buf, "%.9g", static_cast<double>(value)));
+}
+
+inline bool is_text_separator(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ';';
+}
+
+// Plain decimal numbers, [-+]digits[.digits][(e|E)[-+]digits], of at most
+// 19 significant digits whose mantissa fits in a double and whose power of
+// ten is within 10^22 of it, are converted exactly by a single
+// multiplication or division of exact doubles, which is correctly rounded.
+// Return 0 for anything else, to be left to strtod.
+inline const char* parse_decimal(const char* first, const char* last, double& value)
+{
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                   1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+                                   1e20, 1e21, 1e22 };
+  const char* p = first;
+  const bool negative = p != last && *p == '-';
+  if (p != last && (*p == '-' || *p == '+')) ++p;
+  std::tr1::uint64_t mantissa = 0;
+  int digits = 0, exponent = 0;
+  bool any = false;
+  for (; p != last && *p >= '0' && *p <= '9'; ++p, any = true)
+  {
+    if (mantissa != 0 || *p != '0') ++digits;
+    mantissa = mantissa*10 + static_cast<unsigned int>(*p - '0');
+    if (digits > 19) return 0;
+  }
+  if (p != last && *p == '.')
+  {
+    for (++p; p != last && *p >= '0' && *p <= '9'; ++p, any = true)
+    {
+      if (mantissa != 0 || *p != '0') ++digits;
+      mantissa = mantissa*10 + static_cast<unsigned int>(*p - '0');
+      --exponent;
+      if (digits > 19) return 0;
+    }
+  }
+  if (!any) return 0;
+  if (p != last && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    const bool negativeExp = p != last && *p == '-';
+    if (p != last && (*p == '-' || *p == '+')) ++p;
+    if (p == last || *p < '0' || *p > '9') return 0;
+    int e = 0;
+    for (; p != last && *p >= '0' && *p <= '9'; ++p)
+    {
+      if (e > 1000) return 0;
+      e = e*10 + (*p - '0');
+    }
+    exponent += negativeExp ? -e : e;
+  }
+  // strtod would stop at the same place only if the token ends here
+  if (p != last && !is_text_separator(*p)) return 0;
+  if (mantissa > (std::tr1::uint64_t(1) << 53) || exponent < -22 || exponent > 22) return 0;
+  double d = static_cast<double>(mantissa);
+  d = exponent < 0 ? d/powers[-exponent] : d*powers[exponent];
+  value = negative ? -d : d;
+  return p;
+}
+
+// parse one value, skipping leading separators
+inline const char* parse_scalar(const char* first, const char* last, double& value)
+{
+  while (first != last && is_text_separator(*first)) ++first;
+  if (const char* end = parse_decimal(first, last, value)) return end;
+  // strtod needs a null terminated string
+  char buf[max_scalar_chars + 1];
+  std::size_t n = 0;
+  while (first + n != last && n < max_scalar_chars && !is_text_separator(first[n]))
+  {
+    buf[n] = first[n];
+    ++n;
+  }
+  // a token too long for the buffer, or one strtod does not consume
+  // entirely, is an error rather than the start of the next value
+  if (n == 0 || (n == max_scalar_chars && first + n != last && !is_text_separator(first[n])))
+  {
+    return 0;
+  }
+  buf[n] = '\0';
+  char* end = 0;
+  const double d = std::strtod(buf, &end);
+  if (end != buf + n) return 0;
+  value = d;
+  return first + n;
+}
+
+inline const char* parse_scalar(const char* first, const char* last, float& value)
+{
+  double d = 0.;
+  const char* end = parse_scalar(first, last, d);
+  if (end) value = static_cast<float>(d);
+  return end;
+}
+
+template <typename T>
+char* format_scalars(char* first, char* last, const T* values, unsigned int n, char sep)
+{
+  for (unsigned int i = 0; i < n && first; ++i)
+  {
+    if (i != 0)
+    {
+      if (first == last) return 0;
+      *first++ = sep;
+    }
+    first = format_scalar(first, last, values[i]);
+  }
+  return first;
+}
+
+template <typename T>
+const char* parse_scalars(const char* first, const char* last, T* values, unsigned int n)
+{
+  for (unsigned int i = 0; i < n && first; ++i)
+  {
+    first = parse_scalar(first, last, values[i]);
+  }
+  return first;
+}
+
+} // namespace detail
+
+///
+/// Write the elements of a matrix, row by row, to [first, last).
+/// Return one past the last character written, or 0 if the buffer is
+/// too small.
+///
+template <typename T, unsigned int R, unsigned int C>
+char* to_chars(char* first, char* last, const matrix<T,R,C>& m, char sep = ' ')
+{
+  return detail::format_scalars(first, last, &m[0], R*C, sep);
+}
+
+/// Write the x, y and z coordinates of a point to [first, last).
+template <typename T>
+char* to_chars(char* first, char* last, const point3d<T>& p, char sep = ' ')
+{
+  const T xyz[3] = { p.x(), p.y(), p.z() };
+  return detail::format_scalars(first, last, xyz, 3, sep);
+}
+
+/// Write the 12 elements of the 3x4 matrix of a transform to [first, last).
+template <typename T>
+char* to_chars(char* first, char* last, const transform3d<T>& t, char sep = ' ')
+{
+  return to_chars(first, last, to_matrix(t), sep);
+}
+
+///
+/// Read the elements of a matrix, row by row, from [first, last).
+/// Return one past the last character parsed, or 0 on error, in which case
+/// m is left unchanged.
+///
+template <typename T, unsigned int R, unsigned int C>
+const char* from_chars(const char* first, const char* last, matrix<T,R,C>& m)
+{
+  matrix<T,R,C> tmp;
+  first = detail::parse_scalars(first, last, &tmp[0], R*C);
+  if (first) m = tmp;
+  return first;
+}
+
+/// Read the x, y and z coordinates of a point from [first, last).
+template <typename T>
+const char* from_chars(const char* first, const char* last, point3d<T>& p)
+{
+  T xyz[3];
+  first = detail::parse_scalars(first, last, xyz, 3);
+  if (first) p = point3d<T>(xyz[0], xyz[1], xyz[2]);
+  return first;
+}
+
+/// Read the 12 elements of the 3x4 matrix of a transform from [first, last).
+template <typename T>
+const char* from_chars(const char* first, const char* last, transform3d<T>& t)
+{
+  matrix<T,3,4> tmp;
+  first = from_chars(first, last, tmp);
+  if (first) t = transform3d<T>(tmp);
+  return first;
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_TEXT_IO_H_
@@ -0,0 +1,353 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_TILED_POINT_CLOUD_H_
+#define MINIMATH_TILED_POINT_CLOUD_H_
+
+#include <vector>
+#include <cstddef>
+#include "minimath/aligned_allocator.hpp"
+#include "minimath/point_ref.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/transform3d.hpp"
+
+//
+// Array-of-structures-of-arrays (AoSoA) point container. Points are stored
+// in tiles of W points, each tile holding x[W], y[W] and z[W], followed by
+// A optional per-point attribute arrays of W elements.
+//
+// A tile is a few cache lines, so touching one point brings in only its
+// neighbours, while bulk kernels process W points at a time with unit
+// stride loads. W = 8 suits 256 bit registers for float, W = 16 512 bit
+// registers.
+//
+// The tile storage starts on a 64 byte boundary and tiles follow each other
+// without padding, so only the first tile is 64 byte aligned in general.
+// Every x, y, z and attribute array of every tile is aligned to the largest
+// power of two dividing W*sizeof(T), up to 64 bytes: 32 bytes for W = 8 and
+// float, which is what aligned 256 bit loads need.
+//
+// Lanes of the last tile beyond size() are zero and are ignored by the
+// kernels.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+/// W points with A extra attributes each.
+template <typename T, unsigned int W, unsigned int A = 0>
+struct point_tile
+{
+  T x[W];
+  T y[W];
+  T z[W];
+  T attr[A][W];
+};
+
+template <typename T, unsigned int W>
+struct point_tile<T, W, 0>
+{
+  T x[W];
+  T y[W];
+  T z[W];
+};
+
+template <typename T, unsigned int W = 8, unsigned int A = 0>
+class tiled_point_cloud {
+
+ public:
+
+  typedef T scalar_type;
+  typedef point_tile<T,W,A> tile_type;
+  typedef point_ref<T> reference;
+  typedef point_ref<const T> const_reference;
+  typedef std::size_t size_type;
+
+  static const unsigned int tile_width = W;
+  static const unsigned int attribute_count = A;
+
+  tiled_point_cloud() : m_size(0) {}
+
+  explicit tiled_point_cloud(size_type n) : m_size(0) { resize(n); }
+
+  /// Construct from a range of XYZ points
+  template <typename Iterator>
+  tiled_point_cloud(Iterator first, Iterator last) : m_size(0)
+  {
+    assign(first, last);
+  }
+
+  /// Replace the contents with a range of XYZ points. Attributes are zero.
+  template <typename Iterator>
+  void assign(Iterator first, Iterator last)
+  {
+    clear();
+    for (; first != last; ++first) push_back(*first);
+  }
+
+  size_type size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  size_type tile_count() const { return m_tiles.size(); }
+
+  void resize(size_type n)
+  {
+    m_tiles.resize((n + W - 1)/W, zero_tile());
+    // clear lanes dropped from the last tile
+    for (size_type i = n; i < m_size && i < m_tiles.size()*W; ++i) set_lane(i, T(), T(), T());
+    m_size = n;
+  }
+
+  void reserve(size_type n) { m_tiles.reserve((n + W - 1)/W); }
+
+  void clear()
+  {
+    m_tiles.clear();
+    m_size = 0;
+  }
+
+  template <typename P>
+  void push_back(const P& p)
+  {
+    if (m_size == m_tiles.size()*W) m_tiles.push_back(zero_tile());
+    set_lane(m_size, p.x(), p.y(), p.z());
+    ++m_size;
+  }
+
+  reference operator[](size_type i)
+  {
+    tile_type& t = m_tiles[i/W];
+    const size_type l = i%W;
+    return reference(&t.x[l], &t.y[l], &t.z[l]);
+  }
+
+  const_reference operator[](size_type i) const
+  {
+    const tile_type& t = m_tiles[i/W];
+    const size_type l = i%W;
+    return const_reference(&t.x[l], &t.y[l], &t.z[l]);
+  }
+
+  /// Attribute k of point i
+  T& attribute(size_type i, unsigned int k) { return m_tiles[i/W].attr[k][i%W]; }
+  const T& attribute(size_type i, unsigned int k) const { return m_tiles[i/W].attr[k][i%W]; }
+
+  tile_type* tiles() { return m_tiles.empty() ? 0 : &m_tiles[0]; }
+  const tile_type* tiles() const { return m_tiles.empty() ? 0 : &m_tiles[0]; }
+
+  /// Number of valid lanes in tile t
+  unsigned int lanes(size_type t) const
+  {
+    const size_type first = t*W;
+    return static_cast<unsigned int>(m_size - first < W ? m_size - first : W);
+  }
+
+ private:
+
+  static tile_type zero_tile()
+  {
+    tile_type t = tile_type();
+    return t;
+  }
+
+  void set_lane(size_type i, T x, T y, T z)
+  {
+    tile_type& t = m_tiles[i/W];
+    const size_type l = i%W;
+    t.x[l] = x;
+    t.y[l] = y;
+    t.z[l] = z;
+  }
+
+  std::vector<tile_type, aligned_allocator<tile_type> > m_tiles;
+  size_type m_size;
+};
+
+// ============================================================================
+// Kernels
+
+/// Apply the transformation held in a 3x4 matrix to every point, in place.
+template <typename T, unsigned int W, unsigned int A>
+void transform(const matrix<T,3,4>& m, tiled_point_cloud<T,W,A>& cloud)
+{
+  typedef typename tiled_point_cloud<T,W,A>::tile_type tile_type;
+  const T m00 = m(0,0), m01 = m(0,1), m02 = m(0,2), m03 = m(0,3);
+  const T m10 = m(1,0), m11 = m(1,1), m12 = m(1,2), m13 = m(1,3);
+  const T m20 = m(2,0), m21 = m(2,1), m22 = m(2,2), m23 = m(2,3);
+  tile_type* tiles = cloud.tiles();
+  const std::size_t nTiles = cloud.tile_count();
+  for (std::size_t t = 0; t < nTiles; ++t)
+  {
+    tile_type& tile = tiles[t];
+    for (unsigned int l = 0; l < W; ++l)
+    {
+      const T x = tile.x[l];
+      const T y = tile.y[l];
+      const T z = tile.z[l];
+      tile.x[l] = m00*x + m01*y + m02*z + m03;
+      tile.y[l] = m10*x + m11*y + m12*z + m13;
+      tile.z[l] = m20*x + m21*y + m22*z + m23;
+    }
+  }
+  // keep the padding lanes of the last tile at zero
+  for (std::size_t i = cloud.size(); i < nTiles*W; ++i)
+  {
+    cloud[i] = point3d<T>();
+  }
+}
+
+/// Apply a transform3d to every point, in place.
+template <typename T, unsigned int W, unsigned int A>
+void transform(const transform3d<T>& t, tiled_point_cloud<T,W,A>& cloud)
+{
+  transform(to_matrix(t), cloud);
+}
+
+/// out[i] = dist2(cloud[i], p)
+template <typename T, unsigned int W, unsigned int A, typename P>
+typename enable_if<is_point3d<P>::value>::type
+dist2(const tiled_point_cloud<T,W,A>& cloud, const P& p, T* out)
+{
+  typedef typename tiled_point_cloud<T,W,A>::tile_type tile_type;
+  const T px = p.x();
+  const T py = p.y();
+  const T pz = p.z();
+  const tile_type* tiles = cloud.tiles();
+  const std::size_t nTiles = cloud.tile_count();
+  for (std::size_t t = 0; t < nTiles; ++t)
+  {
+    const tile_type& tile = tiles[t];
+    T d[W];
+    for (unsigned int l = 0; l < W; ++l)
+    {
+      const T dx = px - tile.x[l];
+      const T dy = py - tile.y[l];
+      const T dz = pz - tile.z[l];
+      d[l] = dx*dx + dy*dy + dz*dz;
+    }
+    const unsigned int lanes = cloud.lanes(t);
+    for (unsigned int l = 0; l < lanes; ++l) out[t*W + l] = d[l];
+  }
+}
+
+/// Sum of the coordinates of all points.
+template <typename T, unsigned int W, unsigned int A>
+point3d<T> sum(const tiled_point_cloud<T,W,A>& cloud)
+{
+  typedef typename tiled_point_cloud<T,W,A>::tile_type tile_type;
+  // one accumulator per lane; padding lanes are zero
+  T sx[W], sy[W], sz[W];
+  for (unsigned int l = 0; l < W; ++l) sx[l] = sy[l] = sz[l] = T();
+  const tile_type* tiles = cloud.tiles();
+  const std::size_t nTiles = cloud.tile_count();
+  for (std::size_t t = 0; t < nTiles; ++t)
+  {
+    const tile_type& tile = tiles[t];
+    for (unsigned int l = 0; l < W; ++l)
+    {
+      sx[l] += tile.x[l];
+      sy[l] += tile.y[l];
+      sz[l] += tile.z[l];
+    }
+  }
+  T x = T(), y = T(), z = T();
+  for (unsigned int l = 0; l < W; ++l)
+  {
+    x += sx[l];
+    y += sy[l];
+    z += sz[l];
+  }
+  return point3d<T>(x, y, z);
+}
+
+/// Mean of all points. Zero for an empty cloud.
+template <typename T, unsigned int W, unsigned int A>
+point3d<T> centroid(const tiled_point_cloud<T,W,A>& cloud)
+{
+  point3d<T> c = sum(cloud);
+  if (!cloud.empty()) c /= static_cast<T>(cloud.size());
+  return c;
+}
+
+///
+/// Axis aligned bounding box of the points.
+/// Return false, leaving min and max untouched, for an empty cloud.
+///
+template <typename T, unsigned int W, unsigned int A>
+bool bounding_box(const tiled_point_cloud<T,W,A>& cloud, point3d<T>& min, point3d<T>& max)
+{
+  typedef typename tiled_point_cloud<T,W,A>::tile_type tile_type;
+  if (cloud.empty()) return false;
+  const tile_type* tiles = cloud.tiles();
+  // full tiles lane by lane, seeded with the first point
+  T lo[3][W], hi[3][W];
+  for (unsigned int l = 0; l < W; ++l)
+  {
+    lo[0][l] = hi[0][l] = tiles[0].x[0];
+    lo[1][l] = hi[1][l] = tiles[0].y[0];
+    lo[2][l] = hi[2][l] = tiles[0].z[0];
+  }
+  const std::size_t nFull = cloud.size()/W;
+  for (std::size_t t = 0; t < nFull; ++t)
+  {
+    const tile_type& tile = tiles[t];
+    for (unsigned int l = 0; l < W; ++l)
+    {
+      lo[0][l] = tile.x[l] < lo[0][l] ? tile.x[l] : lo[0][l];
+      hi[0][l] = tile.x[l] > hi[0][l] ? tile.x[l] : hi[0][l];
+      lo[1][l] = tile.y[l] < lo[1][l] ? tile.y[l] : lo[1][l];
+      hi[1][l] = tile.y[l] > hi[1][l] ? tile.y[l] : hi[1][l];
+      lo[2][l] = tile.z[l] < lo[2][l] ? tile.z[l] : lo[2][l];
+      hi[2][l] = tile.z[l] > hi[2][l] ? tile.z[l] : hi[2][l];
+    }
+  }
+  // valid lanes of a partial last tile
+  if (nFull < cloud.tile_count())
+  {
+    const tile_type& tile = tiles[nFull];
+    const unsigned int lanes = cloud.lanes(nFull);
+    for (unsigned int l = 0; l < lanes; ++l)
+    {
+      lo[0][l] = tile.x[l] < lo[0][l] ? tile.x[l] : lo[0][l];
+      hi[0][l] = tile.x[l] > hi[0][l] ? tile.x[l] : hi[0][l];
+      lo[1][l] = tile.y[l] < lo[1][l] ? tile.y[l] : lo[1][l];
+      hi[1][l] = tile.y[l] > hi[1][l] ? tile.y[l] : hi[1][l];
+      lo[2][l] = tile.z[l] < lo[2][l] ? tile.z[l] : lo[2][l];
+      hi[2][l] = tile.z[l] > hi[2][l] ? tile.z[l] : hi[2][l];
+    }
+  }
+  for (unsigned int k = 0; k < 3; ++k)
+  {
+    T a = lo[k][0];
+    T b = hi[k][0];
+    for (unsigned int l = 1; l < W; ++l)
+    {
+      a = lo[k][l] < a ? lo[k][l] : a;
+      b = hi[k][l] > b ? hi[k][l] : b;
+    }
+    min[k] = a;
+    max[k] = b;
+  }
+  return true;
+}
+
+/// Copy all points to an output iterator of XYZ points.
+template <typename T, unsigned int W, unsigned int A, typename OutputIterator>
+OutputIterator copy_points(const tiled_point_cloud<T,W,A>& cloud, OutputIterator out)
+{
+  for (std::size_t i = 0; i < cloud.size(); ++i, ++out)
+  {
+    *out = point3d<T>(cloud[i]);
+  }
+  return out;
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_TILED_POINT_CLOUD_H_
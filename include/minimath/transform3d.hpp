@@ -12,6 +12,7 @@
 #include "minimath/rotation3d.hpp"
 #include "minimath/translation3d.hpp"
 #include "minimath/point3d.hpp"
+#include "minimath/matrix_solve.hpp"
 
 namespace minimath {
 
@@ -128,10 +129,19 @@ class transform3d {
 
   transform3d& invert(bool& success)
   {
-    // we need Tr^-1 * R`-1
-    transform3d tmp(translation().inverse(), rotation().inverse(success));
+    // we need Tr^-1 * R^-1, with R^-1 the solution of R*X = I
+    matrix<T,3,3> rot;
+    for (unsigned int r = 0; r < 3; ++r)
+    {
+      for (unsigned int c = 0; c < 3; ++c)
+      {
+        rot(r,c) = m_mat(r,c);
+      }
+    }
+    const matrix<T,3,3> rotInv = solve(rot, matrix<T,3,3>(identity_matrix()), success);
     if (success)
     {
+      transform3d tmp(translation().inverse(), rotation3d<T>(rotInv));
       m_mat = tmp.m_mat;
     }
     return *this;
@@ -159,7 +169,7 @@ class transform3d {
   /// return the underlying 3D translation
   translation3d<T> translation() const
   {
-    return translation3d<T>(pointxyzd(m_mat(0,3), m_mat(1,3), m_mat(2,3)));
+    return translation3d<T>(point3d<T>(m_mat(0,3), m_mat(1,3), m_mat(2,3)));
   }
 
   std::ostream& print(std::ostream& out) const
@@ -172,6 +182,24 @@ class transform3d {
 
 };
 
+/// The 3x4 matrix [R|t] of a transform, rotation followed by translation.
+template <typename T>
+matrix<T,3,4> to_matrix(const transform3d<T>& t)
+{
+  const rotation3d<T> rot = t.rotation();
+  const translation3d<T> trans = t.translation();
+  matrix<T,3,4> m;
+  for (unsigned int r = 0; r < 3; ++r)
+  {
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+      m(r,c) = rot(r,c);
+    }
+    m(r,3) = trans[r];
+  }
+  return m;
+}
+
 template <typename T>
 inline std::ostream& operator<<(std::ostream& out, const transform3d<T>& t)
 {
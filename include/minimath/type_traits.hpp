@@ -23,6 +23,11 @@ using std::tr1::is_arithmetic;
 using std::tr1::integral_constant;
 using std::tr1::is_class;
 
+/// Number types that can be combined with matrices as scalars.
+/// Arithmetic types by default. Specialize for user defined number types.
+template <typename T>
+struct is_numeric : integral_constant<bool, is_arithmetic<T>::value> {};
+
 } // minimath
 
 /// adapted from wikibooks.org example
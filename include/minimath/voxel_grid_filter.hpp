@@ -0,0 +1,340 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+
+#ifndef MINIMATH_VOXEL_GRID_FILTER_H_
+#define MINIMATH_VOXEL_GRID_FILTER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/point3d.hpp"
+#include "minimath/point_statistics.hpp" // for point_scalar
+#include "minimath/space_filling_curves.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//
+// Voxel grid downsampling of XYZ point ranges: the points are binned into
+// cubic voxels of a given side, aligned with the minimum corner of their
+// bounding box, and each occupied voxel is replaced by one representative,
+// either the centroid of its points or the first of its points in the
+// input range.
+//
+// Voxels are identified by the Morton key of their integer coordinates and
+// the points are grouped by radix sorting the keys, so representatives
+// come out in Morton order. To bound memory, the key space is split into
+// 4096 ranges of consecutive keys, which are processed in batches of at
+// most max_block points (a single range with more points is a batch on
+// its own). The range of each point is kept, in two bytes, from a first
+// pass over the input, so each batch only computes the keys of its own
+// points. Keys, the sort and the reduction of each batch
+// run in parallel when OpenMP is enabled, and the output does not depend
+// on the number of threads.
+//
+// The leaf must be positive and the bounding box must span fewer than
+// 2^21 voxels along each axis. Otherwise the filters write nothing and
+// return 0, and voxel_grid_check tells which condition failed.
+//
+// @author Juan Palacios juan.palacios.puyana@gmail.com
+//
+
+namespace minimath {
+
+enum voxel_grid_status
+{
+  voxel_grid_ok,
+  voxel_grid_bad_leaf,     // the leaf is not positive
+  voxel_grid_too_large     // 2^21 voxels or more along an axis
+};
+
+namespace detail
+{
+
+// Voxel coordinates, as 63 bit Morton keys, over the bounding box of n
+// points. Keys are only valid if status is voxel_grid_ok.
+template <typename T>
+struct voxel_grid
+{
+  template <typename RandomAccessIterator>
+  voxel_grid(RandomAccessIterator first, std::size_t n, T leaf)
+  :
+  inv_leaf(T(1)/leaf), max_cell((std::tr1::uint32_t(1) << 21) - 1), bits(0),
+  status(voxel_grid_ok)
+  {
+    if (!(T(0) < leaf))
+    {
+      status = voxel_grid_bad_leaf;
+      return;
+    }
+    if (n == 0) return;
+    point3d<T> max;
+    bounds(first, n, min, max);
+    std::tr1::uint32_t cells = 0;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      // cells beyond max_cell would be clamped into it
+      if (!((max[d] - min[d])*inv_leaf < static_cast<T>(max_cell + 1)))
+      {
+        status = voxel_grid_too_large;
+        return;
+      }
+      cells = std::max(cells, cell(max[d], d));
+    }
+    while (bits < 21 && (cells >> bits) != 0) ++bits;
+  }
+
+  std::tr1::uint32_t cell(T x, unsigned int d) const
+  {
+    const T q = (x - min[d])*inv_leaf;
+    return q < static_cast<T>(max_cell) ? static_cast<std::tr1::uint32_t>(q) : max_cell;
+  }
+
+  template <typename P>
+  std::tr1::uint64_t key(const P& p) const
+  {
+    return morton_encode63(cell(p.x(), 0), cell(p.y(), 1), cell(p.z(), 2));
+  }
+
+  point3d<T> min;
+  T inv_leaf;
+  std::tr1::uint32_t max_cell;
+  unsigned int bits; // per axis, used by the keys
+  voxel_grid_status status;
+};
+
+// representatives of the voxel of the points first[index[perm[i]]] for
+// i in [begin, end)
+template <typename T>
+struct voxel_centroid
+{
+  typedef point3d<T> result_type;
+
+  template <typename RandomAccessIterator>
+  static result_type reduce(RandomAccessIterator first, const std::size_t* index,
+                            const std::size_t* perm, std::size_t begin, std::size_t end)
+  {
+    // summed relative to the first point, for precision in far off voxels
+    const point3d<T> p0 = point_at(first, index[perm[begin]]);
+    point3d<T> sum;
+    for (std::size_t i = begin + 1; i < end; ++i)
+    {
+      sum += point_at(first, index[perm[i]]);
+      sum -= p0;
+    }
+    sum /= static_cast<T>(end - begin);
+    sum += p0;
+    return sum;
+  }
+
+  template <typename RandomAccessIterator>
+  static point3d<T> point_at(RandomAccessIterator first, std::size_t i)
+  {
+    return point3d<T>(first[i].x(), first[i].y(), first[i].z());
+  }
+};
+
+template <typename T>
+struct voxel_first
+{
+  typedef point3d<T> result_type;
+
+  template <typename RandomAccessIterator>
+  static result_type reduce(RandomAccessIterator first, const std::size_t* index,
+                            const std::size_t* perm, std::size_t begin, std::size_t)
+  {
+    return voxel_centroid<T>::point_at(first, index[perm[begin]]);
+  }
+};
+
+struct voxel_first_index
+{
+  typedef std::size_t result_type;
+
+  template <typename RandomAccessIterator>
+  static result_type reduce(RandomAccessIterator, const std::size_t* index,
+                            const std::size_t* perm, std::size_t begin, std::size_t)
+  {
+    return index[perm[begin]];
+  }
+};
+
+template <typename Reduce, typename RandomAccessIterator, typename OutputIterator>
+std::size_t voxel_filter(RandomAccessIterator first, RandomAccessIterator last,
+                         typename point_scalar<RandomAccessIterator>::type leaf,
+                         OutputIterator out, std::size_t max_block)
+{
+  typedef typename point_scalar<RandomAccessIterator>::type T;
+  typedef typename Reduce::result_type result_type;
+  const std::size_t n = static_cast<std::size_t>(last - first);
+  if (n == 0) return 0;
+  const voxel_grid<T> grid(first, n, leaf);
+  if (grid.status != voxel_grid_ok) return 0;
+  const unsigned int keyBits = 3*grid.bits;
+  const unsigned int shift = keyBits > 12 ? keyBits - 12 : 0;
+  const std::size_t nParts = std::size_t(1) << (keyBits - shift);
+
+#ifdef _OPENMP
+  const std::size_t nChunks = static_cast<std::size_t>(omp_get_max_threads());
+#else
+  const std::size_t nChunks = 1;
+#endif
+  const std::size_t chunk = (n + nChunks - 1)/nChunks;
+  const long nc = static_cast<long>(nChunks);
+
+  // key range of each point, and points per key range
+  std::vector<std::tr1::uint16_t> part(n);
+  std::vector<std::size_t> counts(nChunks*nParts, 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long c = 0; c < nc; ++c)
+  {
+    const std::size_t uc = static_cast<std::size_t>(c);
+    std::size_t* row = &counts[uc*nParts];
+    const std::size_t end = std::min(n, (uc + 1)*chunk);
+    for (std::size_t i = uc*chunk; i < end; ++i)
+    {
+      part[i] = static_cast<std::tr1::uint16_t>(grid.key(first[i]) >> shift);
+      ++row[part[i]];
+    }
+  }
+  std::vector<std::size_t> partSize(nParts, 0);
+  for (std::size_t c = 0; c < nChunks; ++c)
+  {
+    for (std::size_t p = 0; p < nParts; ++p) partSize[p] += counts[c*nParts + p];
+  }
+
+  std::vector<std::tr1::uint64_t> keys;
+  std::vector<std::size_t> index, perm, starts;
+  std::vector<std::size_t> chunkOffset(nChunks + 1);
+  std::vector<result_type> reps;
+  std::size_t written = 0;
+  for (std::size_t p = 0; p < nParts; )
+  {
+    // batch of key ranges [p, q)
+    std::size_t q = p, total = 0;
+    do { total += partSize[q++]; } while (q < nParts && total + partSize[q] <= max_block);
+    const std::size_t from = p;
+    p = q;
+    if (total == 0) continue;
+
+    // gather the points of the batch, in input order, keying only them
+    keys.resize(total);
+    index.resize(total);
+    perm.resize(total);
+    chunkOffset[0] = 0;
+    for (std::size_t c = 0; c < nChunks; ++c)
+    {
+      std::size_t inBatch = 0;
+      for (std::size_t r = from; r < q; ++r) inBatch += counts[c*nParts + r];
+      chunkOffset[c + 1] = chunkOffset[c] + inBatch;
+    }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long c = 0; c < nc; ++c)
+    {
+      const std::size_t uc = static_cast<std::size_t>(c);
+      std::size_t j = chunkOffset[uc];
+      const std::size_t end = std::min(n, (uc + 1)*chunk);
+      for (std::size_t i = uc*chunk; i < end; ++i)
+      {
+        if (part[i] < from || !(part[i] < q)) continue;
+        keys[j] = grid.key(first[i]);
+        index[j++] = i;
+      }
+    }
+    radix_sort_permutation(&keys[0], total, &perm[0]);
+
+    // one representative per run of equal keys
+    starts.clear();
+    for (std::size_t i = 0; i < total; ++i)
+    {
+      if (i == 0 || keys[perm[i]] != keys[perm[i - 1]]) starts.push_back(i);
+    }
+    starts.push_back(total);
+    const long nRuns = static_cast<long>(starts.size() - 1);
+    reps.resize(starts.size() - 1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long r = 0; r < nRuns; ++r)
+    {
+      const std::size_t ur = static_cast<std::size_t>(r);
+      reps[ur] = Reduce::reduce(first, &index[0], &perm[0], starts[ur], starts[ur + 1]);
+    }
+    out = std::copy(reps.begin(), reps.end(), out);
+    written += reps.size();
+  }
+  return written;
+}
+
+} // namespace detail
+
+///
+/// Whether the voxel grid filters below can be applied to the points of
+/// [first, last) with voxels of side leaf, or why not.
+///
+template <typename RandomAccessIterator>
+voxel_grid_status voxel_grid_check(RandomAccessIterator first, RandomAccessIterator last,
+                                   typename detail::point_scalar<RandomAccessIterator>::type leaf)
+{
+  typedef typename detail::point_scalar<RandomAccessIterator>::type T;
+  return detail::voxel_grid<T>(first, static_cast<std::size_t>(last - first), leaf).status;
+}
+
+///
+/// Write to out the centroid of the points of [first, last) in each
+/// occupied voxel of side leaf, in Morton order of the voxels. At most
+/// max_block points are sorted at a time. Returns the number of voxels,
+/// or 0 without writing anything if voxel_grid_check fails.
+///
+template <typename RandomAccessIterator, typename OutputIterator>
+std::size_t voxel_grid_centroids(RandomAccessIterator first, RandomAccessIterator last,
+                                 typename detail::point_scalar<RandomAccessIterator>::type leaf,
+                                 OutputIterator out,
+                                 std::size_t max_block = std::size_t(1) << 22)
+{
+  typedef typename detail::point_scalar<RandomAccessIterator>::type T;
+  return detail::voxel_filter<detail::voxel_centroid<T> >(first, last, leaf, out, max_block);
+}
+
+///
+/// Write to out the first point of [first, last) in each occupied voxel
+/// of side leaf, in Morton order of the voxels. Returns the number of
+/// voxels.
+///
+template <typename RandomAccessIterator, typename OutputIterator>
+std::size_t voxel_grid_first(RandomAccessIterator first, RandomAccessIterator last,
+                             typename detail::point_scalar<RandomAccessIterator>::type leaf,
+                             OutputIterator out,
+                             std::size_t max_block = std::size_t(1) << 22)
+{
+  typedef typename detail::point_scalar<RandomAccessIterator>::type T;
+  return detail::voxel_filter<detail::voxel_first<T> >(first, last, leaf, out, max_block);
+}
+
+///
+/// As voxel_grid_first, writing the positions in [first, last) of the
+/// points instead, to select their attributes too.
+///
+template <typename RandomAccessIterator, typename OutputIterator>
+std::size_t voxel_grid_first_indices(RandomAccessIterator first, RandomAccessIterator last,
+                                     typename detail::point_scalar<RandomAccessIterator>::type leaf,
+                                     OutputIterator out,
+                                     std::size_t max_block = std::size_t(1) << 22)
+{
+  return detail::voxel_filter<detail::voxel_first_index>(first, last, leaf, out, max_block);
+}
+
+} // namespace minimath
+
+#endif // MINIMATH_VOXEL_GRID_FILTER_H_
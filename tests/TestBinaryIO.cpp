@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestBinaryIO
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "minimath/binary_io.hpp"
+#include "minimath/mapped_file.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/transform3d.hpp"
+
+using namespace minimath;
+
+typedef matrix<float,2,5> M2x5f;
+typedef matrix<double,3,4> M3x4;
+
+namespace
+{
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+template <typename M>
+void fillRandom(M& m)
+{
+  for (unsigned int i = 0; i < m.size(); ++i) {
+    m[i] = (std::rand()%2000 - 1000)/7.;
+  }
+}
+
+std::vector<transform3d<double> > randomTransforms(unsigned int n)
+{
+  std::vector<transform3d<double> > v;
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    matrix<double,3,4> m;
+    fillRandom(m);
+    v.push_back(transform3d<double>(m));
+  }
+  return v;
+}
+
+// records in a double buffer, so that they are suitably aligned
+template <typename Record>
+std::vector<double> toBuffer(const std::vector<Record>& records)
+{
+  std::vector<double> buffer(binary_size<Record>(records.size())/sizeof(double) + 1);
+  write_binary(&records[0], records.size(), reinterpret_cast<char*>(&buffer[0]));
+  return buffer;
+}
+
+bool sameBytes(const transform3d<double>& lhs, const transform3d<double>& rhs)
+{
+  return std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestBinaryIO, setup)
+
+BOOST_AUTO_TEST_CASE(testHeaderLayout)
+{
+  BOOST_CHECK_EQUAL(sizeof(binary_header), 32u);
+  BOOST_CHECK_EQUAL(binary_size<transform3d<double> >(10), 32u + 10*12*8);
+  BOOST_CHECK_EQUAL(binary_size<M2x5f>(3), 32u + 3*10*4);
+}
+
+BOOST_AUTO_TEST_CASE(testTransformRoundTrip)
+{
+  const std::vector<transform3d<double> > records = randomTransforms(100);
+  const std::vector<double> buffer = toBuffer(records);
+  bool success = false;
+  binary_view<transform3d<double> > view(&buffer[0], buffer.size()*sizeof(double), success);
+  BOOST_CHECK(success);
+  BOOST_CHECK_EQUAL(view.size(), records.size());
+  // records are used in place
+  BOOST_CHECK(reinterpret_cast<const char*>(view.begin()) ==
+              reinterpret_cast<const char*>(&buffer[0]) + sizeof(binary_header));
+  for (unsigned int i = 0; i < view.size(); ++i)
+  {
+    BOOST_CHECK(sameBytes(view[i], records[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testRotationRoundTrip)
+{
+  std::vector<rotation3d<float> > records;
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    records.push_back(rotation3d<float>(rotation3dz<float>(0.1f*static_cast<float>(i))));
+  }
+  const std::vector<double> buffer = toBuffer(records);
+  bool success = false;
+  binary_view<rotation3d<float> > view(&buffer[0], buffer.size()*sizeof(double), success);
+  BOOST_CHECK(success);
+  BOOST_CHECK(std::equal(view.begin(), view.end(), records.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(testTranslationAndMatrixRoundTrip)
+{
+  std::vector<translation3d<double> > trans;
+  trans.push_back(translation3d<double>(1., 2., 3.));
+  trans.push_back(translation3d<double>(-4., 5.5, 1e-300));
+  std::vector<double> buffer = toBuffer(trans);
+  bool success = false;
+  binary_view<translation3d<double> > tview(&buffer[0], buffer.size()*sizeof(double), success);
+  BOOST_CHECK(success);
+  BOOST_CHECK(tview[1][2] == 1e-300);
+
+  std::vector<matrix<double,6,6> > mats(3);
+  for (unsigned int i = 0; i < mats.size(); ++i) fillRandom(mats[i]);
+  buffer = toBuffer(mats);
+  binary_view<matrix<double,6,6> > mview(&buffer[0], buffer.size()*sizeof(double), success);
+  BOOST_CHECK(success);
+  BOOST_CHECK(std::equal(mview.begin(), mview.end(), mats.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(testTypeMismatch)
+{
+  const std::vector<double> buffer = toBuffer(randomTransforms(4));
+  const std::size_t size = buffer.size()*sizeof(double);
+  BOOST_CHECK_EQUAL(check_binary<transform3d<float> >(&buffer[0], size), binary_type_mismatch);
+  BOOST_CHECK_EQUAL(check_binary<M3x4>(&buffer[0], size), binary_type_mismatch);
+  bool success = true;
+  binary_view<rotation3d<double> > view(&buffer[0], size, success);
+  BOOST_CHECK(!success);
+  BOOST_CHECK(view.empty());
+  BOOST_CHECK_EQUAL(view.status(), binary_type_mismatch);
+}
+
+BOOST_AUTO_TEST_CASE(testTruncatedAndBadMagic)
+{
+  std::vector<double> buffer = toBuffer(randomTransforms(4));
+  const std::size_t size = binary_size<transform3d<double> >(4);
+  BOOST_CHECK_EQUAL(check_binary<transform3d<double> >(&buffer[0], size), binary_ok);
+  BOOST_CHECK_EQUAL(check_binary<transform3d<double> >(&buffer[0], size - 1), binary_truncated);
+  BOOST_CHECK_EQUAL(check_binary<transform3d<double> >(&buffer[0], 16), binary_truncated);
+  reinterpret_cast<char*>(&buffer[0])[0] = 'X';
+  BOOST_CHECK_EQUAL(check_binary<transform3d<double> >(&buffer[0], size), binary_bad_magic);
+}
+
+BOOST_AUTO_TEST_CASE(testMisaligned)
+{
+  const std::vector<transform3d<double> > records = randomTransforms(2);
+  std::vector<double> buffer(binary_size<transform3d<double> >(2)/sizeof(double) + 1);
+  char* p = reinterpret_cast<char*>(&buffer[0]) + 4;
+  write_binary(&records[0], records.size(), p);
+  BOOST_CHECK_EQUAL(check_binary<transform3d<double> >(p, binary_size<transform3d<double> >(2)),
+                    binary_misaligned);
+}
+
+BOOST_AUTO_TEST_CASE(testSwapByteOrder)
+{
+  const std::vector<transform3d<double> > records = randomTransforms(5);
+  std::vector<double> buffer = toBuffer(records);
+  const std::size_t size = buffer.size()*sizeof(double);
+  // emulate a file written on a machine of the other byte order
+  char* bytes = reinterpret_cast<char*>(&buffer[0]);
+  std::reverse(bytes + 4, bytes + 8);   // byte_order
+  std::reverse(bytes + 8, bytes + 10);  // version
+  std::reverse(bytes + 12, bytes + 14); // rows
+  std::reverse(bytes + 14, bytes + 16); // cols
+  std::reverse(bytes + 16, bytes + 20); // record_size
+  std::reverse(bytes + 24, bytes + 32); // count
+  for (unsigned int i = 0; i < 5*12; ++i)
+  {
+    char* p = bytes + sizeof(binary_header) + i*sizeof(double);
+    std::reverse(p, p + sizeof(double));
+  }
+  BOOST_CHECK_EQUAL(check_binary<transform3d<double> >(bytes, size), binary_byte_order);
+  BOOST_CHECK(swap_byte_order(bytes, size));
+  bool success = false;
+  binary_view<transform3d<double> > view(bytes, size, success);
+  BOOST_CHECK(success);
+  BOOST_CHECK_EQUAL(view.size(), 5u);
+  for (unsigned int i = 0; i < view.size(); ++i)
+  {
+    BOOST_CHECK(sameBytes(view[i], records[i]));
+  }
+  // native order is left untouched
+  BOOST_CHECK(swap_byte_order(bytes, size));
+  BOOST_CHECK(sameBytes(view[0], records[0]));
+}
+
+BOOST_AUTO_TEST_CASE(testMappedFile)
+{
+  const char* path = "TestBinaryIO.bin";
+  const std::vector<transform3d<double> > records = randomTransforms(1000);
+  {
+    std::ofstream out(path, std::ios::binary);
+    BOOST_CHECK(write_binary(out, &records[0], records.size()));
+  }
+  mapped_file file;
+  BOOST_CHECK(file.open(path));
+  BOOST_CHECK(file.is_open());
+  BOOST_CHECK_EQUAL(file.size(), binary_size<transform3d<double> >(records.size()));
+  bool success = false;
+  binary_view<transform3d<double> > view(file.data(), file.size(), success);
+  BOOST_CHECK(success);
+  BOOST_CHECK_EQUAL(view.size(), records.size());
+  for (unsigned int i = 0; i < view.size(); ++i)
+  {
+    BOOST_CHECK(sameBytes(view[i], records[i]));
+  }
+  file.close();
+  BOOST_CHECK(!file.is_open());
+  std::remove(path);
+  BOOST_CHECK(!file.open(path));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
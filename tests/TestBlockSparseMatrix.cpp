@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestBlockSparseMatrix
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cstdlib>
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "minimath/block_sparse_matrix.hpp"
+
+namespace
+{
+
+typedef minimath::matrix<double,3> M3x3;
+typedef minimath::block_sparse_matrix<double,3> BSR3;
+typedef BSR3::triplet_type Triplet;
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+M3x3 randomBlock()
+{
+  M3x3 m;
+  for (unsigned int i = 0; i < m.size(); ++i) {
+    m[i] = std::rand()%10 - 5;
+  }
+  return m;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestBlockSparseMatrix, setup)
+
+BOOST_AUTO_TEST_CASE(testEmpty)
+{
+  BSR3 a(4, 5);
+  BOOST_CHECK_EQUAL(a.block_rows(), 4u);
+  BOOST_CHECK_EQUAL(a.block_cols(), 5u);
+  BOOST_CHECK_EQUAL(a.rows(), 12u);
+  BOOST_CHECK_EQUAL(a.cols(), 15u);
+  BOOST_CHECK_EQUAL(a.nonzero_blocks(), 0u);
+  BOOST_CHECK(a.find(1, 1) == 0);
+  std::vector<double> x(a.cols(), 1.), y;
+  a.multiply(x, y);
+  BOOST_CHECK_EQUAL(y.size(), 12u);
+  for (unsigned int i = 0; i < y.size(); ++i) BOOST_CHECK_EQUAL(y[i], 0.);
+}
+
+BOOST_AUTO_TEST_CASE(testAssemblySumsDuplicates)
+{
+  std::vector<Triplet> triplets;
+  const M3x3 b0 = randomBlock();
+  const M3x3 b1 = randomBlock();
+  const M3x3 b2 = randomBlock();
+  triplets.push_back(Triplet(1, 2, b0));
+  triplets.push_back(Triplet(0, 0, b1));
+  triplets.push_back(Triplet(1, 0, b2));
+  triplets.push_back(Triplet(1, 2, b1));
+  BSR3 a(2, 3, triplets.begin(), triplets.end());
+
+  BOOST_CHECK_EQUAL(a.nonzero_blocks(), 3u);
+  BOOST_REQUIRE(a.find(1, 2) != 0);
+  BOOST_CHECK(*a.find(1, 2) == b0 + b1);
+  BOOST_CHECK(*a.find(0, 0) == b1);
+  BOOST_CHECK(*a.find(1, 0) == b2);
+  BOOST_CHECK(a.find(0, 1) == 0);
+  // columns are sorted within rows
+  BOOST_CHECK_EQUAL(a.column_indices()[1], 0u);
+  BOOST_CHECK_EQUAL(a.column_indices()[2], 2u);
+}
+
+BOOST_AUTO_TEST_CASE(testOutOfRangeTriplets)
+{
+  std::vector<Triplet> triplets;
+  triplets.push_back(Triplet(0, 1, randomBlock()));
+  bool success = false;
+  BSR3 a(2, 2, triplets.begin(), triplets.end(), success);
+  BOOST_CHECK(success);
+  BOOST_CHECK_EQUAL(a.nonzero_blocks(), 1u);
+
+  triplets.push_back(Triplet(5, 0, randomBlock()));
+  BSR3 b(2, 2, triplets.begin(), triplets.end(), success);
+  BOOST_CHECK(!success);
+  BOOST_CHECK_EQUAL(b.block_rows(), 0u);
+  BOOST_CHECK_EQUAL(b.nonzero_blocks(), 0u);
+
+  triplets.back() = Triplet(1, 2, randomBlock());
+  BOOST_CHECK(!a.assign(2, 2, triplets.begin(), triplets.end()));
+  BOOST_CHECK_EQUAL(a.rows(), 0u);
+  BOOST_CHECK_EQUAL(a.nonzero_blocks(), 0u);
+  BOOST_CHECK(a.assign(2, 3, triplets.begin(), triplets.end()));
+  BOOST_CHECK_EQUAL(a.nonzero_blocks(), 2u);
+
+  // x must match the columns
+  std::vector<double> x(a.cols() - 1, 1.), y(2, 7.);
+  BOOST_CHECK(!a.multiply(x, y));
+  BOOST_CHECK_EQUAL(y.size(), 2u);
+  x.push_back(1.);
+  BOOST_CHECK(a.multiply(x, y));
+  BOOST_CHECK_EQUAL(y.size(), a.rows());
+}
+
+BOOST_AUTO_TEST_CASE(testMultiplyMatchesDense)
+{
+  const unsigned int n = 50;
+  std::vector<Triplet> triplets;
+  std::vector<M3x3> dense(n*n, M3x3(minimath::zero_matrix()));
+  for (unsigned int k = 0; k < 400; ++k)
+  {
+    const unsigned int i = static_cast<unsigned int>(std::rand())%n;
+    const unsigned int j = static_cast<unsigned int>(std::rand())%n;
+    const M3x3 b = randomBlock();
+    triplets.push_back(Triplet(i, j, b));
+    dense[i*n + j] += b;
+  }
+  BSR3 a(n, n, triplets.begin(), triplets.end());
+
+  std::vector<double> x(a.cols());
+  for (unsigned int i = 0; i < x.size(); ++i) x[i] = std::rand()%7 - 3;
+  std::vector<double> y;
+  a.multiply(x, y);
+
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    for (unsigned int r = 0; r < 3; ++r)
+    {
+      double expected = 0;
+      for (unsigned int j = 0; j < n; ++j)
+      {
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+          expected += dense[i*n + j](r,c) * x[j*3 + c];
+        }
+      }
+      BOOST_CHECK_EQUAL(y[i*3 + r], expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSixBySixBlocks)
+{
+  typedef minimath::matrix<double,6> M6x6;
+  typedef minimath::block_sparse_matrix<double,6> BSR6;
+  std::vector<BSR6::triplet_type> triplets;
+  triplets.push_back(BSR6::triplet_type(0, 1, M6x6(minimath::identity_matrix())));
+  triplets.push_back(BSR6::triplet_type(1, 0, M6x6(2.)));
+  BSR6 a(2, 2, triplets.begin(), triplets.end());
+  std::vector<double> x(12), y;
+  for (unsigned int i = 0; i < x.size(); ++i) x[i] = i;
+  a.multiply(x, y);
+  for (unsigned int i = 0; i < 6; ++i)
+  {
+    BOOST_CHECK_EQUAL(y[i], x[i+6]);
+    BOOST_CHECK_EQUAL(y[i+6], 30.);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
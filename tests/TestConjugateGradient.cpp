@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestConjugateGradient
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "minimath/conjugate_gradient.hpp"
+
+namespace
+{
+
+// Block tridiagonal SPD system, as from a chain of survey stations:
+// diagonal blocks D = 4*I + S*S^T, off-diagonal blocks -I.
+template <unsigned int B>
+minimath::block_sparse_matrix<double,B> chain(unsigned int n)
+{
+  typedef minimath::matrix<double,B> M;
+  typedef typename minimath::block_sparse_matrix<double,B>::triplet_type Triplet;
+  std::vector<Triplet> triplets;
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    M s;
+    for (unsigned int k = 0; k < s.size(); ++k) s[k] = std::rand()%5 - 2;
+    M d = s*s.transpose();
+    d += M(minimath::identity_matrix())*4.;
+    triplets.push_back(Triplet(i, i, d));
+    if (i + 1 < n)
+    {
+      triplets.push_back(Triplet(i, i+1, M(minimath::identity_matrix())*-1.));
+      triplets.push_back(Triplet(i+1, i, M(minimath::identity_matrix())*-1.));
+    }
+  }
+  return minimath::block_sparse_matrix<double,B>(n, n, triplets.begin(), triplets.end());
+}
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestConjugateGradient, setup)
+
+BOOST_AUTO_TEST_CASE(testPreconditionerInvertsDiagonal)
+{
+  minimath::block_sparse_matrix<double,3> A = chain<3>(10);
+  minimath::block_jacobi_preconditioner<double,3> M;
+  BOOST_CHECK(M.compute(A));
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    BOOST_CHECK(minimath::equal(M.blocks()[i]*(*A.find(i,i)),
+                                minimath::matrix<double,3>(minimath::identity_matrix()),
+                                64));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testPreconditionerMissingDiagonal)
+{
+  minimath::block_sparse_matrix<double,3> A(2, 2);
+  minimath::block_jacobi_preconditioner<double,3> M;
+  BOOST_CHECK(!M.compute(A));
+}
+
+BOOST_AUTO_TEST_CASE(testSolveInputErrors)
+{
+  // a missing diagonal block is reported, not replaced by identity
+  minimath::block_sparse_matrix<double,3> A(2, 2);
+  std::vector<double> b(A.rows(), 1.), x;
+  minimath::pcg_result<double> res = minimath::pcg_solve(A, b, x, 1e-12, 100);
+  BOOST_CHECK(res.input_error);
+  BOOST_CHECK(!res.converged);
+  BOOST_CHECK_EQUAL(res.iterations, 0u);
+
+  A = chain<3>(4);
+  b.resize(A.rows() - 1);
+  res = minimath::pcg_solve(A, b, x, 1e-12, 100);
+  BOOST_CHECK(res.input_error);
+  BOOST_CHECK(!res.converged);
+  b.push_back(1.);
+  res = minimath::pcg_solve(A, b, x, 1e-12, 100);
+  BOOST_CHECK(!res.input_error);
+  BOOST_CHECK(res.converged);
+}
+
+BOOST_AUTO_TEST_CASE(testSolve3x3Blocks)
+{
+  const unsigned int n = 200;
+  minimath::block_sparse_matrix<double,3> A = chain<3>(n);
+  std::vector<double> xTrue(A.cols()), b;
+  for (unsigned int i = 0; i < xTrue.size(); ++i) xTrue[i] = std::rand()%11 - 5;
+  A.multiply(xTrue, b);
+
+  std::vector<double> x(A.cols(), 0.);
+  minimath::pcg_result<double> res = minimath::pcg_solve(A, b, x, 1e-12, 1000);
+  BOOST_CHECK(res.converged);
+  BOOST_CHECK(res.iterations > 0u);
+  BOOST_CHECK(res.residual_norm <= 1e-12);
+  for (unsigned int i = 0; i < x.size(); ++i)
+  {
+    BOOST_CHECK(std::abs(x[i] - xTrue[i]) < 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSolve6x6BlocksWithWorkspace)
+{
+  const unsigned int n = 50;
+  minimath::block_sparse_matrix<double,6> A = chain<6>(n);
+  std::vector<double> xTrue(A.cols()), b;
+  for (unsigned int i = 0; i < xTrue.size(); ++i) xTrue[i] = std::rand()%11 - 5;
+  A.multiply(xTrue, b);
+
+  minimath::block_jacobi_preconditioner<double,6> M(A);
+  minimath::pcg_workspace<double> work;
+  for (unsigned int attempt = 0; attempt < 2; ++attempt)
+  {
+    std::vector<double> x(A.cols(), 0.);
+    minimath::pcg_result<double> res =
+      minimath::pcg_solve(A, &b[0], &x[0], M, 1e-12, 1000u, work);
+    BOOST_CHECK(res.converged);
+    for (unsigned int i = 0; i < x.size(); ++i)
+    {
+      BOOST_CHECK(std::abs(x[i] - xTrue[i]) < 1e-9);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testExactInitialGuess)
+{
+  minimath::block_sparse_matrix<double,3> A = chain<3>(5);
+  std::vector<double> x(A.cols(), 1.), b;
+  A.multiply(x, b);
+  minimath::pcg_result<double> res = minimath::pcg_solve(A, b, x, 1e-12, 10);
+  BOOST_CHECK(res.converged);
+  BOOST_CHECK_EQUAL(res.iterations, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testIterationLimit)
+{
+  minimath::block_sparse_matrix<double,3> A = chain<3>(100);
+  std::vector<double> b(A.rows(), 1.), x(A.cols(), 0.);
+  minimath::pcg_result<double> res = minimath::pcg_solve(A, b, x, 1e-14, 2);
+  BOOST_CHECK(!res.converged);
+  BOOST_CHECK_EQUAL(res.iterations, 2u);
+  BOOST_CHECK(res.residual_norm > 1e-14);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestDynamicKDTree
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "minimath/dynamic_kd_tree.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+typedef dynamic_kd_tree<double, 4> tree_type;
+
+// live points sorted by distance to q, by brute force
+std::vector<kd_neighbour<double> > bruteForce(const tree_type& tree, std::size_t nIds,
+                                              const point3d<double>& q)
+{
+  std::vector<kd_neighbour<double> > all;
+  for (std::size_t id = 0; id < nIds; ++id)
+  {
+    if (tree.contains(id)) all.push_back(kd_neighbour<double>(id, dist2(tree.point(id), q)));
+  }
+  std::sort(all.begin(), all.end());
+  return all;
+}
+
+void checkQueries(const tree_type& tree, std::size_t nIds)
+{
+  for (unsigned int attempt = 0; attempt < 5; ++attempt)
+  {
+    const point3d<double> q = randomPoint<double>();
+    const std::vector<kd_neighbour<double> > expected = bruteForce(tree, nIds, q);
+    BOOST_REQUIRE_EQUAL(expected.size(), tree.size());
+
+    kd_neighbour<double> out[5];
+    const std::size_t found = tree.nearest(q, 5, out);
+    BOOST_REQUIRE_EQUAL(found, std::min<std::size_t>(5, tree.size()));
+    for (std::size_t i = 0; i < found; ++i) BOOST_CHECK_EQUAL(out[i].index, expected[i].index);
+
+    std::vector<kd_neighbour<double> > within;
+    tree.radius(q, 4., within);
+    std::sort(within.begin(), within.end());
+    std::size_t n = 0;
+    while (n < expected.size() && expected[n].dist2 <= 16.) ++n;
+    BOOST_REQUIRE_EQUAL(within.size(), n);
+    for (std::size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL(within[i].index, expected[i].index);
+
+    std::vector<std::size_t> inBox;
+    tree.box(q - point3d<double>(3., 3., 3.), q + point3d<double>(3., 3., 3.), inBox);
+    std::size_t nBox = 0;
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      const point3d<double> d = tree.point(expected[i].index) - q;
+      if (std::fabs(d.x()) <= 3. && std::fabs(d.y()) <= 3. && std::fabs(d.z()) <= 3.) ++nBox;
+    }
+    BOOST_CHECK_EQUAL(inBox.size(), nBox);
+  }
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestDynamicKDTree, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testInsert)
+{
+  tree_type tree;
+  BOOST_CHECK(tree.empty());
+  for (std::size_t i = 0; i < 1000; ++i)
+  {
+    BOOST_CHECK_EQUAL(tree.insert(randomPoint<double>()), i);
+  }
+  BOOST_CHECK_EQUAL(tree.size(), 1000u);
+  // 1000 = 31*32 + 8: trees of 32, 64, 128, 256 and 512 points plus the buffer
+  BOOST_CHECK_EQUAL(tree.trees(), 5u);
+  checkQueries(tree, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(testRemove)
+{
+  tree_type tree;
+  std::vector<point3d<double> > pts;
+  for (unsigned int i = 0; i < 700; ++i) pts.push_back(randomPoint<double>());
+  tree.insert(pts.begin(), pts.end());
+  BOOST_CHECK(!tree.remove(700));
+  BOOST_CHECK(tree.remove(3));
+  BOOST_CHECK(!tree.remove(3));
+  BOOST_CHECK(!tree.contains(3));
+  BOOST_CHECK(tree.remove(699)); // still buffered
+  BOOST_CHECK_EQUAL(tree.size(), 698u);
+  checkQueries(tree, 700);
+
+  // interleave, until removed points trigger full rebuilds
+  std::size_t nIds = 700;
+  for (unsigned int round = 0; round < 2000; ++round)
+  {
+    if (std::rand()%3 == 0)
+    {
+      tree.insert(randomPoint<double>());
+      ++nIds;
+    }
+    else
+    {
+      tree.remove(static_cast<std::size_t>(std::rand())%nIds);
+    }
+    if (round%250 == 0) checkQueries(tree, nIds);
+  }
+  checkQueries(tree, nIds);
+
+  for (std::size_t id = 0; id < nIds; ++id) tree.remove(id);
+  BOOST_CHECK(tree.empty());
+  kd_neighbour<double> out;
+  BOOST_CHECK_EQUAL(tree.nearest(point3d<double>(), 1, &out), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testChurn)
+{
+  // a stream of insertions and removals of the oldest points, with about
+  // 500 live at a time: slots are reused and ids are not
+  tree_type tree;
+  std::size_t oldest = 0, nIds = 0;
+  for (unsigned int round = 0; round < 20000; ++round)
+  {
+    BOOST_REQUIRE_EQUAL(tree.insert(randomPoint<double>()), nIds);
+    ++nIds;
+    if (tree.size() > 500 || (tree.size() > 400 && std::rand()%2 == 0))
+    {
+      BOOST_REQUIRE(tree.remove(oldest));
+      ++oldest;
+    }
+  }
+  BOOST_CHECK(tree.capacity() <= 2*500 + tree_type::buffer_size);
+  BOOST_CHECK(!tree.contains(oldest - 1));
+  BOOST_CHECK(tree.contains(nIds - 1));
+  checkQueries(tree, nIds);
+}
+
+BOOST_AUTO_TEST_CASE(testBatch)
+{
+  dynamic_kd_tree<float> tree;
+  for (unsigned int i = 0; i < 3000; ++i)
+  {
+    const point3d<double> p = randomPoint<double>();
+    tree.insert(point3d<float>(float(p.x()), float(p.y()), float(p.z())));
+  }
+  for (std::size_t id = 0; id < 3000; id += 7) tree.remove(id);
+  std::vector<point3d<float> > queries;
+  for (unsigned int i = 0; i < 32; ++i) queries.push_back(point3d<float>(float(i), 0.f, -float(i)));
+  std::vector<kd_neighbour<float> > out(3*queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  tree.nearest(queries.begin(), queries.end(), 3, &out[0], &counts[0]);
+  std::vector<std::vector<kd_neighbour<float> > > within;
+  tree.radius(queries.begin(), queries.end(), 2.f, within);
+  for (std::size_t q = 0; q < queries.size(); ++q)
+  {
+    kd_neighbour<float> single[3];
+    BOOST_CHECK_EQUAL(counts[q], tree.nearest(queries[q], 3, single));
+    for (std::size_t i = 0; i < counts[q]; ++i)
+    {
+      BOOST_CHECK_EQUAL(out[3*q + i].index, single[i].index);
+      BOOST_CHECK(out[3*q + i].index%7 != 0);
+    }
+    std::vector<kd_neighbour<float> > r;
+    tree.radius(queries[q], 2.f, r);
+    BOOST_CHECK_EQUAL(within[q].size(), r.size());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestFastNormalize
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "minimath/fast_normalize.hpp"
+#include "minimath/point_view.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+// largest relative error of approx against the exact normalization of p
+double relativeError(const point3d<float>& p, const point3d<float>& approx)
+{
+  const double len = std::sqrt(double(p.x())*p.x() + double(p.y())*p.y() + double(p.z())*p.z());
+  double err = 0.;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    err = std::max(err, std::fabs(approx[i] - p[i]/len));
+  }
+  return err;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestFastNormalize, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testErrorBound)
+{
+  const std::vector<point3d<float> > pts = randomPoints<float>(1000);
+  double worst = 0.;
+  for (unsigned int i = 0; i < pts.size(); ++i)
+  {
+    if (pts[i] == point3d<float>()) continue;
+    worst = std::max(worst, relativeError(pts[i], normalize_approx(pts[i])));
+  }
+  BOOST_TEST_MESSAGE("worst relative error " << worst);
+  BOOST_CHECK_LT(worst, 1.e-6);
+
+  // tiny and huge magnitudes
+  const point3d<float> tiny(1.e-18f, -2.e-18f, 3.e-18f);
+  BOOST_CHECK_LT(relativeError(tiny, normalize_approx(tiny)), 1.e-6);
+  const point3d<float> huge(1.e18f, 2.e18f, -3.e18f);
+  BOOST_CHECK_LT(relativeError(huge, normalize_approx(huge)), 1.e-6);
+}
+
+BOOST_AUTO_TEST_CASE(testZeroUnchanged)
+{
+  BOOST_CHECK(normalize_approx(point3d<float>()) == point3d<float>());
+  BOOST_CHECK(normalize_approx(point3d<double>()) == point3d<double>());
+  const point3d<float> denormal(1.e-39f, 0.f, 0.f);
+  BOOST_CHECK_EQUAL(normalize_approx(denormal).x(), 1.e-39f);
+}
+
+BOOST_AUTO_TEST_CASE(testDouble)
+{
+  const point3d<double> p(3., 0., 4.);
+  BOOST_CHECK(equal(normalize_approx(p), normalize(p), 1));
+}
+
+BOOST_AUTO_TEST_CASE(testBatchMatchesScalar)
+{
+  // all lengths up to a few SIMD blocks, to exercise the scalar tails
+  for (unsigned int n = 0; n < 14; ++n)
+  {
+    std::vector<point3d<float> > a = randomPoints<float>(n + 1);
+    a[n/2] = point3d<float>();
+    const std::vector<point3d<float> > orig = a;
+    normalize_approx(&a[0], n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+      BOOST_CHECK(a[i] == normalize_approx(orig[i]));
+    }
+    BOOST_CHECK(a[n] == orig[n]);
+
+    point_cloud<float> cloud(orig.begin(), orig.begin() + n);
+    normalize_approx(cloud);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+      BOOST_CHECK(cloud[i] == normalize_approx(orig[i]));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testViews)
+{
+  std::vector<float> xyz;
+  const std::vector<point3d<float> > pts = randomPoints<float>(9);
+  for (unsigned int i = 0; i < pts.size(); ++i)
+  {
+    xyz.push_back(pts[i].x());
+    xyz.push_back(pts[i].y());
+    xyz.push_back(pts[i].z());
+  }
+  const point_span<float> span(&xyz[0], pts.size());
+  normalize_approx(span.begin(), span.end());
+  for (unsigned int i = 0; i < pts.size(); ++i)
+  {
+    BOOST_CHECK(span[i] == normalize_approx(pts[i]));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestFixedPoint
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <limits>
+#include "minimath/fixed_point.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/transform3d.hpp"
+
+using minimath::q16_16;
+using minimath::q8_24;
+using minimath::q8_8;
+
+namespace
+{
+typedef minimath::matrix<q16_16, 3> M3x3;
+typedef minimath::point3d<q16_16> Point;
+}
+
+BOOST_AUTO_TEST_SUITE(TestFixedPoint)
+
+BOOST_AUTO_TEST_CASE(testConstruction)
+{
+  BOOST_CHECK_EQUAL(q16_16().raw(), 0);
+  BOOST_CHECK_EQUAL(q16_16(1).raw(), 65536);
+  BOOST_CHECK_EQUAL(q16_16(-2).raw(), -131072);
+  BOOST_CHECK_EQUAL(q16_16(2u).raw(), 131072);
+  BOOST_CHECK_EQUAL(q16_16(0.5).raw(), 32768);
+  BOOST_CHECK_EQUAL(q16_16(-0.25).raw(), -16384);
+  BOOST_CHECK_EQUAL(q16_16::from_raw(3).raw(), 3);
+  BOOST_CHECK_EQUAL(q16_16(1.5).to_double(), 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(testArithmetic)
+{
+  const q16_16 a(1.5);
+  const q16_16 b(-0.25);
+  BOOST_CHECK(a + b == q16_16(1.25));
+  BOOST_CHECK(a - b == q16_16(1.75));
+  BOOST_CHECK(a * b == q16_16(-0.375));
+  BOOST_CHECK(a / b == q16_16(-6));
+  BOOST_CHECK(2*a == q16_16(3));
+  BOOST_CHECK(-a == q16_16(-1.5));
+  BOOST_CHECK(b < 0);
+  BOOST_CHECK(minimath::abs(b) == q16_16(0.25));
+}
+
+BOOST_AUTO_TEST_CASE(testRounding)
+{
+  // 1/3 rounds to nearest
+  const q16_16 third = q16_16(1)/q16_16(3);
+  BOOST_CHECK_EQUAL(third.raw(), 21845);
+  BOOST_CHECK_EQUAL((q16_16(2)/q16_16(3)).raw(), 43691);
+  BOOST_CHECK_EQUAL((q16_16(-2)/q16_16(3)).raw(), -43691);
+  // smallest values multiply to half an ulp, which rounds away from zero
+  const q16_16 ulp = std::numeric_limits<q16_16>::epsilon();
+  BOOST_CHECK_EQUAL((ulp*q16_16(0.5)).raw(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testSaturation)
+{
+  const q8_8 big(100);
+  BOOST_CHECK(big*big == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK(-big*big == std::numeric_limits<q8_8>::lowest());
+  BOOST_CHECK(big + big + big == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK(q8_8(1)/q8_8() == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK(q8_8(1000.) == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK(q8_8(4000000000u) == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK(q8_8(20000000) == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK(q8_8(-20000000) == std::numeric_limits<q8_8>::lowest());
+  BOOST_CHECK(q8_8(128) == std::numeric_limits<q8_8>::max());
+  BOOST_CHECK_EQUAL(q8_8(127).raw(), 127*256);
+  BOOST_CHECK_EQUAL(q8_8(-128).raw(), -128*256);
+}
+
+BOOST_AUTO_TEST_CASE(testSqrt)
+{
+  BOOST_CHECK(sqrt(q16_16(4)) == q16_16(2));
+  BOOST_CHECK(sqrt(q16_16(0.25)) == q16_16(0.5));
+  BOOST_CHECK(minimath::equal(sqrt(q16_16(2)), q16_16(std::sqrt(2.)), 1));
+  BOOST_CHECK(sqrt(q16_16(-1)) == q16_16());
+}
+
+BOOST_AUTO_TEST_CASE(testMatrixInversion)
+{
+  M3x3 m;
+  m(0,0) = 2; m(0,1) = 1;
+  m(1,0) = 1; m(1,1) = 3;
+  m(2,2) = 4;
+  bool success = false;
+  M3x3 mInv = m.inverse(success);
+  BOOST_CHECK(success);
+  BOOST_CHECK(minimath::equal(m*mInv, M3x3(minimath::identity_matrix()), 4));
+
+  M3x3 singular(q16_16(1));
+  singular.invert(success);
+  BOOST_CHECK(!success);
+}
+
+BOOST_AUTO_TEST_CASE(testMatrixScalar)
+{
+  M3x3 m = minimath::identity_matrix();
+  M3x3 m2 = m*q16_16(2) + q16_16(1);
+  BOOST_CHECK(m2(0,0) == q16_16(3));
+  BOOST_CHECK(m2(0,1) == q16_16(1));
+}
+
+BOOST_AUTO_TEST_CASE(testPoint)
+{
+  Point p(3, 4, 0);
+  BOOST_CHECK(p.mag2() == q16_16(25));
+  Point n = minimath::normalize(p);
+  BOOST_CHECK(minimath::equal(n.x(), q16_16(0.6), 1));
+  BOOST_CHECK(minimath::equal(n.y(), q16_16(0.8), 1));
+  BOOST_CHECK(p + p == Point(6, 8, 0));
+}
+
+BOOST_AUTO_TEST_CASE(testTransform)
+{
+  // rotation of 90 degrees about Z plus a translation
+  minimath::matrix<q16_16,3,4> mat;
+  mat(0,1) = -1; mat(1,0) = 1; mat(2,2) = 1;
+  mat(0,3) = 10; mat(1,3) = q16_16(0.5); mat(2,3) = -3;
+  minimath::transform3d<q16_16> t(mat);
+  Point p = t*Point(1, 2, 3);
+  BOOST_CHECK(p.x() == q16_16(8));
+  BOOST_CHECK(p.y() == q16_16(1.5));
+  BOOST_CHECK(p.z() == q16_16(0));
+
+  bool success = false;
+  minimath::transform3d<q16_16> tInv = t.inverse(success);
+  BOOST_CHECK(success);
+  Point p1 = tInv*p;
+  BOOST_CHECK(p1.x() == q16_16(1));
+  BOOST_CHECK(p1.y() == q16_16(2));
+  BOOST_CHECK(p1.z() == q16_16(3));
+}
+
+BOOST_AUTO_TEST_CASE(testWideAccumulation)
+{
+  // each product is half an ulp, only their sum is representable
+  minimath::matrix<q8_24,3> m;
+  m(0,0) = m(0,1) = m(0,2) = q8_24::from_raw(1);
+  minimath::point3d<q8_24> p(q8_24(0.5), q8_24(0.5), q8_24(0.5));
+  minimath::point3d<q8_24> r = m*p;
+  BOOST_CHECK_EQUAL(r.x().raw(), 2); // 1.5 ulp rounds to 2
+}
+
+BOOST_AUTO_TEST_SUITE_END()
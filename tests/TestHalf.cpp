@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestHalf
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "minimath/half.hpp"
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/transform3d.hpp"
+
+using minimath::half;
+using minimath::bfloat16;
+
+BOOST_AUTO_TEST_SUITE(TestHalf)
+
+BOOST_AUTO_TEST_CASE(testStorageSize)
+{
+  BOOST_CHECK_EQUAL(sizeof(half), 2u);
+  BOOST_CHECK_EQUAL(sizeof(bfloat16), 2u);
+  BOOST_CHECK_EQUAL(sizeof(minimath::point3d<half>), 6u);
+  BOOST_CHECK_EQUAL(sizeof(minimath::matrix<half,3,4>), 24u);
+  BOOST_CHECK_EQUAL(sizeof(minimath::transform3d<bfloat16>), 24u);
+}
+
+BOOST_AUTO_TEST_CASE(testHalfExactValues)
+{
+  BOOST_CHECK_EQUAL(half(1.f).bits(), 0x3c00u);
+  BOOST_CHECK_EQUAL(half(-2.f).bits(), 0xc000u);
+  BOOST_CHECK_EQUAL(half(0.5f).bits(), 0x3800u);
+  BOOST_CHECK_EQUAL(half(65504.f).bits(), 0x7bffu);
+  BOOST_CHECK_EQUAL(float(half::from_bits(0x3555u)), 0.333251953125f);
+  BOOST_CHECK_EQUAL(float(half(3)), 3.f);
+}
+
+BOOST_AUTO_TEST_CASE(testHalfRounding)
+{
+  // 1 + 2^-11 is halfway between 1 and 1 + 2^-10: ties to even
+  BOOST_CHECK_EQUAL(half(1.f + std::ldexp(1.f, -11)).bits(), 0x3c00u);
+  BOOST_CHECK_EQUAL(half(1.f + 3*std::ldexp(1.f, -11)).bits(), 0x3c02u);
+  // overflow to infinity
+  BOOST_CHECK_EQUAL(half(70000.f).bits(), 0x7c00u);
+  BOOST_CHECK_EQUAL(half(-70000.f).bits(), 0xfc00u);
+}
+
+BOOST_AUTO_TEST_CASE(testHalfSubnormals)
+{
+  const float tiny = std::ldexp(1.f, -24);
+  BOOST_CHECK_EQUAL(half(tiny).bits(), 0x0001u);
+  BOOST_CHECK_EQUAL(float(half::from_bits(0x0001u)), tiny);
+  BOOST_CHECK_EQUAL(float(half::from_bits(0x03ffu)), std::ldexp(1023.f, -24));
+  BOOST_CHECK_EQUAL(half(std::ldexp(1.f, -26)).bits(), 0x0000u);
+  BOOST_CHECK_EQUAL(half(-0.f).bits(), 0x8000u);
+}
+
+BOOST_AUTO_TEST_CASE(testHalfSpecials)
+{
+  BOOST_CHECK(std::isinf(float(std::numeric_limits<half>::infinity())));
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  BOOST_CHECK(std::isnan(float(half(nan))));
+  BOOST_CHECK(std::isnan(float(bfloat16(nan))));
+  BOOST_CHECK_EQUAL(float(std::numeric_limits<half>::epsilon()), std::ldexp(1.f, -10));
+  BOOST_CHECK_EQUAL(float(std::numeric_limits<bfloat16>::epsilon()), std::ldexp(1.f, -7));
+}
+
+BOOST_AUTO_TEST_CASE(testHalfRoundTripAll)
+{
+  // every finite half converts to float and back unchanged
+  for (unsigned int b = 0; b < 0x10000u; ++b)
+  {
+    if ((b & 0x7c00u) == 0x7c00u) continue;
+    const half h = half::from_bits(static_cast<half::bits_type>(b));
+    if (half(float(h)).bits() != h.bits())
+    {
+      BOOST_ERROR("round trip failed for bits " << b);
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBfloat16)
+{
+  BOOST_CHECK_EQUAL(bfloat16(1.f).bits(), 0x3f80u);
+  BOOST_CHECK_EQUAL(float(bfloat16(3.f)), 3.f);
+  BOOST_CHECK_EQUAL(float(bfloat16(1e30f)), float(bfloat16::from_bits(bfloat16(1e30f).bits())));
+  // ties to even
+  BOOST_CHECK_EQUAL(bfloat16(1.f + std::ldexp(1.f, -8)).bits(), 0x3f80u);
+  BOOST_CHECK_EQUAL(bfloat16(1.f + 3*std::ldexp(1.f, -8)).bits(), 0x3f82u);
+}
+
+BOOST_AUTO_TEST_CASE(testArithmetic)
+{
+  half a(1.5f);
+  half b(0.25f);
+  BOOST_CHECK_EQUAL(a*b, 0.375f);
+  a += b;
+  BOOST_CHECK_EQUAL(float(a), 1.75f);
+  a /= 7.f;
+  BOOST_CHECK_EQUAL(float(a), 0.25f);
+}
+
+BOOST_AUTO_TEST_CASE(testBulkConversion)
+{
+  std::vector<float> in;
+  for (int i = -50; i < 51; ++i) in.push_back(static_cast<float>(i)*0.37f);
+  std::vector<half> h(in.size());
+  minimath::from_float(&in[0], in.size(), &h[0]);
+  std::vector<float> out(in.size());
+  minimath::to_float(&h[0], h.size(), &out[0]);
+  for (unsigned int i = 0; i < in.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(h[i].bits(), half(in[i]).bits());
+    BOOST_CHECK_EQUAL(out[i], float(half(in[i])));
+  }
+
+  std::vector<bfloat16> bf(in.size());
+  minimath::from_float(&in[0], in.size(), &bf[0]);
+  minimath::to_float(&bf[0], bf.size(), &out[0]);
+  for (unsigned int i = 0; i < in.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(out[i], float(bfloat16(in[i])));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBulkPointConversion)
+{
+  std::vector<minimath::point3d<float> > in;
+  for (int i = 0; i < 20; ++i)
+  {
+    const float f = static_cast<float>(i);
+    in.push_back(minimath::point3d<float>(f, 0.5f*f, -f));
+  }
+  std::vector<minimath::point3d<half> > h(in.size());
+  minimath::from_float(&in[0], in.size(), &h[0]);
+  std::vector<minimath::point3d<float> > out(in.size());
+  minimath::to_float(&h[0], h.size(), &out[0]);
+  for (unsigned int i = 0; i < in.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(out[i].x(), in[i].x());
+    BOOST_CHECK_EQUAL(out[i].y(), in[i].y());
+    BOOST_CHECK_EQUAL(out[i].z(), in[i].z());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testMatrixInversion)
+{
+  minimath::matrix<half,3> m;
+  m(0,0) = 2.f; m(1,1) = 4.f; m(2,2) = 0.5f; m(0,1) = 1.f;
+  bool success = false;
+  minimath::matrix<half,3> mInv = m.inverse(success);
+  BOOST_CHECK(success);
+  BOOST_CHECK(minimath::equal(m*mInv, minimath::matrix<half,3>(minimath::identity_matrix()), 2));
+}
+
+BOOST_AUTO_TEST_CASE(testTransform)
+{
+  minimath::matrix<bfloat16,3,4> mat;
+  mat(0,1) = -1.f; mat(1,0) = 1.f; mat(2,2) = 1.f;
+  mat(0,3) = 10.f; mat(1,3) = 0.5f; mat(2,3) = -3.f;
+  minimath::transform3d<bfloat16> t(mat);
+  minimath::point3d<bfloat16> p = t*minimath::point3d<bfloat16>(1.f, 2.f, 3.f);
+  BOOST_CHECK_EQUAL(float(p.x()), 8.f);
+  BOOST_CHECK_EQUAL(float(p.y()), 1.5f);
+  BOOST_CHECK_EQUAL(float(p.z()), 0.f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
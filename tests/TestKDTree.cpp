@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestKDTree
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "minimath/kd_tree.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+template <typename T>
+void checkNearest(unsigned int n)
+{
+  const std::vector<point3d<T> > pts = randomPoints<T>(n);
+  const kd_tree<T> tree(pts.begin(), pts.end());
+  BOOST_CHECK_EQUAL(tree.size(), n);
+  const std::vector<point3d<T> > queries = randomPoints<T>(20);
+  const std::size_t k = 7;
+  std::vector<kd_neighbour<T> > out(k);
+  for (unsigned int q = 0; q < queries.size(); ++q)
+  {
+    const std::vector<kd_neighbour<T> > expected = bruteForceNearest(pts, queries[q]);
+    const std::size_t found = tree.nearest(queries[q], k, &out[0]);
+    BOOST_CHECK_EQUAL(found, std::min<std::size_t>(k, n));
+    for (std::size_t i = 0; i < found; ++i)
+    {
+      BOOST_CHECK_EQUAL(out[i].index, expected[i].index);
+      BOOST_CHECK_EQUAL(out[i].dist2, expected[i].dist2);
+    }
+  }
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestKDTree, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testEmpty)
+{
+  const kd_tree<double> tree;
+  BOOST_CHECK(tree.empty());
+  kd_neighbour<double> out;
+  BOOST_CHECK_EQUAL(tree.nearest(point3d<double>(), 1, &out), 0u);
+  std::vector<kd_neighbour<double> > r;
+  BOOST_CHECK_EQUAL(tree.radius(point3d<double>(), 1., r), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testStructure)
+{
+  const std::vector<point3d<float> > pts = randomPoints<float>(1000);
+  const kd_tree<float, 16> tree(pts.begin(), pts.end());
+  // 1000/2^6 = 15.6
+  BOOST_CHECK_EQUAL(tree.depth(), 6u);
+  const kd_tree<float, 16> small(pts.begin(), pts.begin() + 16);
+  BOOST_CHECK_EQUAL(small.depth(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testNearest)
+{
+  checkNearest<float>(1);
+  checkNearest<float>(5);
+  checkNearest<float>(17);
+  checkNearest<float>(1000);
+  checkNearest<double>(3000);
+}
+
+BOOST_AUTO_TEST_CASE(testDuplicates)
+{
+  std::vector<point3d<double> > pts(100, point3d<double>(1., 2., 3.));
+  pts.push_back(point3d<double>(1., 2., 4.));
+  const kd_tree<double, 4> tree(pts.begin(), pts.end());
+  kd_neighbour<double> out[3];
+  BOOST_CHECK_EQUAL(tree.nearest(point3d<double>(1., 2., 5.), 3, out), 3u);
+  BOOST_CHECK_EQUAL(out[0].index, 100u);
+  BOOST_CHECK_EQUAL(out[1].index, 0u);
+  BOOST_CHECK_EQUAL(out[2].index, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(testRadiusAndBox)
+{
+  const std::vector<point3d<float> > pts = randomPoints<float>(2000);
+  const point_cloud<float> cloud(pts.begin(), pts.end());
+  const kd_tree<float, 8> tree(cloud.begin(), cloud.end());
+  const std::vector<point3d<float> > queries = randomPoints<float>(10);
+  for (unsigned int q = 0; q < queries.size(); ++q)
+  {
+    const float r = 3.5f;
+    std::vector<kd_neighbour<float> > found;
+    tree.radius(queries[q], r, found);
+    std::sort(found.begin(), found.end());
+    const std::vector<kd_neighbour<float> > all = bruteForceNearest(pts, queries[q]);
+    std::size_t expected = 0;
+    while (expected < all.size() && all[expected].dist2 <= r*r) ++expected;
+    BOOST_REQUIRE_EQUAL(found.size(), expected);
+    for (std::size_t i = 0; i < expected; ++i) BOOST_CHECK_EQUAL(found[i].index, all[i].index);
+
+    const point3d<float> lo = queries[q] - point3d<float>(2.f, 3.f, 4.f);
+    const point3d<float> hi = queries[q] + point3d<float>(2.f, 3.f, 4.f);
+    std::vector<std::size_t> inBox;
+    tree.box(lo, hi, inBox);
+    std::sort(inBox.begin(), inBox.end());
+    std::vector<std::size_t> expectedBox;
+    for (std::size_t i = 0; i < pts.size(); ++i)
+    {
+      if (pts[i].x() >= lo.x() && pts[i].x() <= hi.x() &&
+          pts[i].y() >= lo.y() && pts[i].y() <= hi.y() &&
+          pts[i].z() >= lo.z() && pts[i].z() <= hi.z()) expectedBox.push_back(i);
+    }
+    BOOST_CHECK(inBox == expectedBox);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBatch)
+{
+  const std::vector<point3d<double> > pts = randomPoints<double>(5000);
+  const kd_tree<double> tree(pts.begin(), pts.end());
+  const std::vector<point3d<double> > queries = randomPoints<double>(64);
+  const std::size_t k = 4;
+  std::vector<kd_neighbour<double> > out(k*queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  tree.nearest(queries.begin(), queries.end(), k, &out[0], &counts[0]);
+  std::vector<std::vector<kd_neighbour<double> > > within;
+  tree.radius(queries.begin(), queries.end(), 2., within);
+  BOOST_CHECK_EQUAL(within.size(), queries.size());
+  for (std::size_t q = 0; q < queries.size(); ++q)
+  {
+    kd_neighbour<double> single[4];
+    BOOST_CHECK_EQUAL(counts[q], tree.nearest(queries[q], k, single));
+    for (std::size_t i = 0; i < k; ++i) BOOST_CHECK_EQUAL(out[q*k + i].index, single[i].index);
+    std::vector<kd_neighbour<double> > r;
+    tree.radius(queries[q], 2., r);
+    BOOST_CHECK_EQUAL(within[q].size(), r.size());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
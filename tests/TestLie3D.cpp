@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestLie3D
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+#include "minimath/lie3d.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "Defines.h"
+
+using namespace minimath;
+
+namespace
+{
+
+typedef matrix<double,6,1> twist;
+
+twist makeTwist(double wx, double wy, double wz,
+                double vx, double vy, double vz)
+{
+  twist xi;
+  xi[0] = wx; xi[1] = wy; xi[2] = wz;
+  xi[3] = vx; xi[4] = vy; xi[5] = vz;
+  return xi;
+}
+
+bool sameTransform(const transform3d<double>& lhs,
+                   const transform3d<double>& rhs,
+                   unsigned int nEpsilons)
+{
+  return minimath::equal(lhs*p100, rhs*p100, nEpsilons) &&
+         minimath::equal(lhs*p010, rhs*p010, nEpsilons) &&
+         minimath::equal(lhs*p001, rhs*p001, nEpsilons) &&
+         minimath::equal(lhs*p111, rhs*p111, nEpsilons);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(TestLie3D)
+
+BOOST_AUTO_TEST_CASE(testExpSO3Zero)
+{
+  rotation3d<double> rot = exp_so3(pointxyzd());
+  BOOST_CHECK(rot.equal(rotation3d<double>(), 0));
+}
+
+BOOST_AUTO_TEST_CASE(testExpSO3MatchesAxisAngle)
+{
+  const pointxyzd axis = normalize(pointxyzd(1, 2, 3));
+  for (int i = 1; i < 9; ++i)
+  {
+    const double angle = PI/i;
+    rotation3d<double> rot = exp_so3(axis*angle);
+    rotation3d<double> ref(axisangle<double>(axis, angle));
+    BOOST_CHECK(rot.equal(ref, 8));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLogSO3RoundTrip)
+{
+  const pointxyzd axis = normalize(pointxyzd(-1, 0.5, 2));
+  const double angles[] = { 1e-9, 1e-5, 1e-3, 0.1, 1., 2., 3., PI - 1e-4 };
+  for (unsigned int i = 0; i < sizeof(angles)/sizeof(angles[0]); ++i)
+  {
+    const pointxyzd w = axis*angles[i];
+    const pointxyzd w1 = log_so3(exp_so3(w));
+    BOOST_CHECK(minimath::equal(w, w1, 64));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLogSO3HalfTurn)
+{
+  // at pi the sign of omega is arbitrary, so compare rotations
+  const pointxyzd w = normalize(pointxyzd(-1, 0.5, 2))*PI;
+  const pointxyzd w1 = log_so3(exp_so3(w));
+  BOOST_CHECK(minimath::equal(mag2(w1), PI*PI, 64));
+  BOOST_CHECK(exp_so3(w1).equal(exp_so3(w), 8));
+}
+
+BOOST_AUTO_TEST_CASE(testExpSE3PureTranslation)
+{
+  transform3d<double> trans = exp_se3(makeTwist(0, 0, 0, 1, 2, 3));
+  BOOST_CHECK(sameTransform(trans, transform3d<double>(translation3d<double>(1, 2, 3)), 0));
+}
+
+BOOST_AUTO_TEST_CASE(testExpSE3SmallAngle)
+{
+  // first order: R = I + [w]x, t = v + w x v / 2
+  const twist xi = makeTwist(1e-9, -2e-9, 3e-9, 1, 2, 3);
+  transform3d<double> trans = exp_se3(xi);
+  const pointxyzd w(xi[0], xi[1], xi[2]);
+  const pointxyzd v(xi[3], xi[4], xi[5]);
+  const pointxyzd t = v + cross(w, v)*0.5;
+  BOOST_CHECK(minimath::equal(trans*p000, t, 8));
+}
+
+BOOST_AUTO_TEST_CASE(testLogSE3RoundTrip)
+{
+  // start below pi, where the sign of omega is arbitrary
+  for (int i = 2; i < 9; ++i)
+  {
+    const double angle = PI/i;
+    const pointxyzd w = normalize(pointxyzd(1, -1, 2))*angle;
+    const twist xi = makeTwist(w.x(), w.y(), w.z(), 10, -20, 30);
+    const twist xi1 = log_se3(exp_se3(xi));
+    BOOST_CHECK(minimath::equal(xi, xi1, 256));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLogSE3MatchesTransform)
+{
+  transform3d<double> trans(rotation3d<double>(rotation3dz<double>(PI/3)),
+                            translation3d<double>(1, 2, 3));
+  BOOST_CHECK(sameTransform(exp_se3(log_se3(trans)), trans, 16));
+}
+
+BOOST_AUTO_TEST_CASE(testBatchExpLogSE3)
+{
+  std::vector<twist> twists;
+  for (int i = 0; i < 10; ++i)
+  {
+    twists.push_back(makeTwist(0.1*i, 0.05*i, -0.02*i, i, 2*i, 3*i));
+  }
+  std::vector<transform3d<double> > transforms(twists.size());
+  exp_se3(twists.begin(), twists.end(), transforms.begin());
+  std::vector<twist> twists1(twists.size());
+  log_se3(transforms.begin(), transforms.end(), twists1.begin());
+  for (unsigned int i = 0; i < twists.size(); ++i)
+  {
+    BOOST_CHECK(sameTransform(transforms[i], exp_se3(twists[i]), 0));
+    BOOST_CHECK(minimath::equal(twists[i], twists1[i], 256));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -389,4 +389,50 @@ BOOST_AUTO_TEST_CASE(testInvert)
   }
 }
 
+BOOST_AUTO_TEST_CASE(testInverseConditionIdentity)
+{
+  M3x3 m = minimath::identity_matrix();
+  bool success = false;
+  double rcond = 0;
+  M3x3 mInv = m.inverse(success, rcond);
+  BOOST_CHECK(success);
+  BOOST_CHECK(isIdentity(mInv));
+  BOOST_CHECK(valueEquality(rcond, 1.));
+}
+
+BOOST_AUTO_TEST_CASE(testInverseConditionScaled)
+{
+  M2x2 m = minimath::identity_matrix();
+  m(1,1) = 1e-3;
+  bool success = false;
+  double rcond = 0;
+  m.invert(success, rcond);
+  BOOST_CHECK(success);
+  BOOST_CHECK(std::abs(rcond - 1e-3) < 1e-15);
+  BOOST_CHECK(valueEquality(m(1,1), 1e3));
+}
+
+BOOST_AUTO_TEST_CASE(testInverseConditionIllConditioned)
+{
+  M3x3 m;
+  m(0,0) = 1; m(0,1) = 2; m(0,2) = 3;
+  m(1,0) = 4; m(1,1) = 5; m(1,2) = 6;
+  m(2,0) = 7; m(2,1) = 8; m(2,2) = 9.000001;
+  bool success = false;
+  double rcond = 1;
+  m.inverse(success, rcond);
+  BOOST_CHECK(success);
+  BOOST_CHECK(rcond < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(testInverseConditionSingular)
+{
+  M3x3 m(1.);
+  bool success = true;
+  double rcond = 1;
+  m.invert(success, rcond);
+  BOOST_CHECK(!success);
+  BOOST_CHECK(valueEquality(rcond, 0.));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
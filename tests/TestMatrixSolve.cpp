@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestMatrixSolve
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include "minimath/matrix.hpp"
+#include "minimath/matrix_ops.hpp"
+#include "minimath/matrix_solve.hpp"
+
+namespace
+{
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+template <typename M>
+void fillRandom(M& m)
+{
+  for (unsigned int i = 0; i < m.size(); ++i) {
+    m[i] = std::rand()%10 - 5;
+  }
+}
+
+} // anonymous namespace
+
+typedef minimath::matrix<double, 3> M3x3;
+typedef minimath::matrix<double, 4> M4x4;
+typedef minimath::matrix<double, 6> M6x6;
+typedef minimath::matrix<double, 3,2> M3x2;
+typedef minimath::matrix<double, 2,3> M2x3;
+typedef minimath::matrix<double, 4,3> M4x3;
+typedef minimath::matrix<double, 6,1> M6x1;
+
+BOOST_FIXTURE_TEST_SUITE(TestMatrixSolve, setup)
+
+BOOST_AUTO_TEST_CASE(testSolveLowerTriangular)
+{
+  M3x3 L;
+  L(0,0) = 2;
+  L(1,0) = 1; L(1,1) = 4;
+  L(2,0) = 3; L(2,1) = 5; L(2,2) = 6;
+  L(0,2) = 100; // ignored
+  M3x2 B;
+  fillRandom(B);
+  bool success = false;
+  M3x2 X = minimath::solve_lower_triangular(L, B, success);
+  BOOST_CHECK(success);
+  L(0,2) = 0;
+  BOOST_CHECK(minimath::equal(L*X, B, 16));
+}
+
+BOOST_AUTO_TEST_CASE(testSolveUpperTriangular)
+{
+  M3x3 U;
+  U(0,0) = 2; U(0,1) = 1; U(0,2) = 3;
+  U(1,1) = 4; U(1,2) = 5;
+  U(2,2) = 6;
+  U(2,0) = 100; // ignored
+  M3x2 B;
+  fillRandom(B);
+  bool success = false;
+  M3x2 X = minimath::solve_upper_triangular(U, B, success);
+  BOOST_CHECK(success);
+  U(2,0) = 0;
+  BOOST_CHECK(minimath::equal(U*X, B, 16));
+}
+
+BOOST_AUTO_TEST_CASE(testSolveTriangularSingular)
+{
+  M3x3 U = minimath::identity_matrix();
+  U(1,1) = 0;
+  bool success = true;
+  minimath::solve_upper_triangular(U, M3x2(1.), success);
+  BOOST_CHECK(!success);
+}
+
+BOOST_AUTO_TEST_CASE(testSolve)
+{
+  for (unsigned int attempt = 0; attempt < 5; ++attempt)
+  {
+    M6x6 A;
+    fillRandom(A);
+    A += M6x6(minimath::identity_matrix()) * 20.;
+    M6x1 b;
+    fillRandom(b);
+    bool success = false;
+    M6x1 x = minimath::solve(A, b, success);
+    BOOST_CHECK(success);
+    BOOST_CHECK(minimath::equal(A*x, b, 64));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveNeedsPivoting)
+{
+  M3x3 A;
+  A(0,1) = 1;
+  A(1,0) = 1;
+  A(2,2) = 1;
+  M3x3 I = minimath::identity_matrix();
+  bool success = false;
+  M3x3 X = minimath::solve(A, I, success);
+  BOOST_CHECK(success);
+  BOOST_CHECK(minimath::equal(X, A));
+}
+
+BOOST_AUTO_TEST_CASE(testSolveSingular)
+{
+  M3x3 A(1.);
+  bool success = true;
+  M3x3 X = minimath::solve(A, M3x3(minimath::identity_matrix()), success);
+  BOOST_CHECK(!success);
+  BOOST_CHECK(X == M3x3(minimath::zero_matrix()));
+}
+
+BOOST_AUTO_TEST_CASE(testSolveSPD)
+{
+  for (unsigned int attempt = 0; attempt < 5; ++attempt)
+  {
+    M4x4 M;
+    fillRandom(M);
+    M4x4 A = M.transpose()*M + M4x4(minimath::identity_matrix());
+    M4x3 B;
+    fillRandom(B);
+    bool success = false;
+    M4x3 X = minimath::solve_spd(A, B, success);
+    BOOST_CHECK(success);
+    BOOST_CHECK(minimath::equal(A*X, B, 256));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveSPDNotPositiveDefinite)
+{
+  M3x3 A = minimath::identity_matrix();
+  A(2,2) = -1;
+  bool success = true;
+  minimath::solve_spd(A, M3x3(minimath::identity_matrix()), success);
+  BOOST_CHECK(!success);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveRight)
+{
+  for (unsigned int attempt = 0; attempt < 5; ++attempt)
+  {
+    M3x3 A;
+    fillRandom(A);
+    A += M3x3(minimath::identity_matrix()) * 20.;
+    M2x3 B;
+    fillRandom(B);
+    bool success = false;
+    M2x3 X = minimath::solve_right(A, B, success);
+    BOOST_CHECK(success);
+    BOOST_CHECK(minimath::equal(X*A, B, 64));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveMixed)
+{
+  for (unsigned int attempt = 0; attempt < 5; ++attempt)
+  {
+    M6x6 A;
+    fillRandom(A);
+    A += M6x6(minimath::identity_matrix()) * 20.;
+    for (unsigned int i = 0; i < A.size(); ++i) A[i] += 1e-3/(i+1);
+    M6x1 b;
+    fillRandom(b);
+    bool success = false;
+    M6x1 x = minimath::solve(A, b, success);
+    BOOST_CHECK(success);
+    M6x1 xMixed = minimath::solve_mixed<float>(A, b, success, 3);
+    BOOST_CHECK(success);
+    // refinement recovers double accuracy, well beyond float epsilon
+    BOOST_CHECK(minimath::equal(x, xMixed, 64));
+    M6x1 xFloat = minimath::solve_mixed<float>(A, b, success, 0);
+    BOOST_CHECK(!minimath::equal(x, xFloat, 64));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveSPDMixed)
+{
+  M4x4 M;
+  fillRandom(M);
+  M4x4 A = M.transpose()*M + M4x4(minimath::identity_matrix())*0.1;
+  M4x3 B;
+  fillRandom(B);
+  bool success = false;
+  M4x3 X = minimath::solve_spd_mixed<float>(A, B, success, 3);
+  BOOST_CHECK(success);
+  BOOST_CHECK(minimath::equal(A*X, B, 1024));
+}
+
+BOOST_AUTO_TEST_CASE(testMixedPrecisionLeftInverse)
+{
+  M4x3 m;
+  fillRandom(m);
+  m(0,0) += 10; m(1,1) += 10; m(2,2) += 10;
+  bool success = false;
+  minimath::matrix<double,3,4> mInv =
+    minimath::left_inverse(m, success, minimath::mixed_precision);
+  BOOST_CHECK(success);
+  BOOST_CHECK(minimath::equal(mInv*m, M3x3(minimath::identity_matrix()), 64));
+}
+
+BOOST_AUTO_TEST_CASE(testMixedPrecisionTransformation)
+{
+  M3x3 orig;
+  fillRandom(orig);
+  orig += M3x3(minimath::identity_matrix())*10.;
+  M3x3 rot;
+  rot(0,1) = -1; rot(1,0) = 1; rot(2,2) = 1;
+  bool success = false;
+  M3x3 rot2 = minimath::transformation(orig, M3x3(rot*orig), success,
+                                       minimath::mixed_precision);
+  BOOST_CHECK(success);
+  BOOST_CHECK(minimath::equal(rot, rot2, 16));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
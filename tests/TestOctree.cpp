@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestOctree
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "minimath/octree.hpp"
+#include "minimath/point_cloud.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+// random points above the z = 0 plane, in steps of 1/64
+template <typename T>
+std::vector<point3d<T> > groundPoints(unsigned int n)
+{
+  return randomPoints(n, point3d<T>(-15.625, -15.625, 0), point3d<T>(15.625, 15.625, 15.625), 2000);
+}
+
+// every point is in exactly one node of the cut, and inside its cell
+template <typename T>
+void checkCut(const linear_octree<T>& tree, const std::vector<std::size_t>& cut)
+{
+  std::vector<unsigned int> covered(tree.size(), 0);
+  for (std::size_t c = 0; c < cut.size(); ++c)
+  {
+    const octree_node<T>& n = tree.node(cut[c]);
+    const point3d<T> centre = tree.cell_center(cut[c]);
+    const T half = tree.edge(cut[c])/2;
+    for (std::size_t i = n.first; i < n.first + n.count; ++i)
+    {
+      ++covered[i];
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        BOOST_CHECK(tree.point(i)[d] >= centre[d] - half*1.0001);
+        BOOST_CHECK(tree.point(i)[d] <= centre[d] + half*1.0001);
+      }
+    }
+  }
+  BOOST_CHECK(std::count(covered.begin(), covered.end(), 1u) == static_cast<long>(tree.size()));
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestOctree, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testEmptyAndSmall)
+{
+  const linear_octree<double> none;
+  BOOST_CHECK(none.empty());
+  std::vector<std::size_t> cut;
+  none.lod(1., cut);
+  BOOST_CHECK(cut.empty());
+
+  const std::vector<point3d<double> > pts = groundPoints<double>(10);
+  const linear_octree<double> small(pts.begin(), pts.end());
+  BOOST_CHECK_EQUAL(small.nodes(), 1u);
+  BOOST_CHECK_EQUAL(small.node(0).count, 10u);
+  point3d<double> c;
+  for (unsigned int i = 0; i < pts.size(); ++i) c += pts[i];
+  c /= 10.;
+  BOOST_CHECK(equal(small.node(0).centroid, c, 4));
+}
+
+BOOST_AUTO_TEST_CASE(testStructure)
+{
+  const std::vector<point3d<float> > pts = groundPoints<float>(20000);
+  const point_cloud<float> cloud(pts.begin(), pts.end());
+  const linear_octree<float> tree(cloud.begin(), cloud.end(), 16);
+  BOOST_CHECK_EQUAL(tree.size(), pts.size());
+  BOOST_CHECK(tree.nodes() < pts.size());
+  BOOST_CHECK(tree.levels() > 2u);
+
+  // points are a permutation of the input
+  for (std::size_t i = 0; i < tree.size(); ++i)
+  {
+    BOOST_CHECK(tree.point(i) == pts[tree.index(i)]);
+  }
+  // children partition their parent, with consistent counts and centroids
+  for (std::size_t i = 0; i < tree.nodes(); ++i)
+  {
+    const octree_node<float>& n = tree.node(i);
+    if (n.children == 0)
+    {
+      BOOST_CHECK(n.count <= 16u || n.level == linear_octree<float>::max_depth);
+      continue;
+    }
+    BOOST_CHECK(n.count > 16u);
+    std::size_t next = n.first;
+    point3d<double> sum;
+    for (std::size_t c = n.child; c < n.child + n.children; ++c)
+    {
+      BOOST_CHECK_EQUAL(tree.node(c).first, next);
+      BOOST_CHECK_EQUAL(tree.node(c).level, n.level + 1);
+      next += tree.node(c).count;
+      const point3d<float>& cc = tree.node(c).centroid;
+      sum += point3d<double>(cc.x(), cc.y(), cc.z())*double(tree.node(c).count);
+    }
+    BOOST_CHECK_EQUAL(next, n.first + n.count);
+    sum /= double(n.count);
+    BOOST_CHECK_SMALL(sum.x() - n.centroid.x(), 1.e-3);
+  }
+  // levels are contiguous
+  for (unsigned int l = 0; l < tree.levels(); ++l)
+  {
+    for (std::size_t i = tree.level_begin(l); i < tree.level_begin(l + 1); ++i)
+    {
+      BOOST_CHECK_EQUAL(tree.node(i).level, l);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLOD)
+{
+  const std::vector<point3d<double> > pts = groundPoints<double>(10000);
+  const linear_octree<double> tree(pts.begin(), pts.end(), 8);
+
+  std::vector<std::size_t> coarse, fine;
+  tree.lod(tree.edge()/2, coarse);
+  tree.lod(tree.edge()/16, fine);
+  checkCut(tree, coarse);
+  checkCut(tree, fine);
+  BOOST_CHECK(coarse.size() <= 8u);
+  BOOST_CHECK(coarse.size() < fine.size());
+  for (std::size_t i = 0; i < fine.size(); ++i)
+  {
+    BOOST_CHECK(tree.node(fine[i]).children == 0 || tree.edge(fine[i]) <= tree.edge()/16);
+  }
+
+  // nodes near the eye are finer than far ones
+  const point3d<double> eye(-15., -15., 0.);
+  std::vector<std::size_t> view;
+  tree.lod(eye, 0.1, view);
+  checkCut(tree, view);
+  double nearEdge = tree.edge(), farEdge = 0.;
+  for (std::size_t i = 0; i < view.size(); ++i)
+  {
+    const double d = std::sqrt(dist2(tree.cell_center(view[i]), eye));
+    if (d < 5.) nearEdge = std::min(nearEdge, tree.edge(view[i]));
+    if (d > 25.) farEdge = std::max(farEdge, tree.edge(view[i]));
+  }
+  BOOST_CHECK(nearEdge < farEdge);
+}
+
+BOOST_AUTO_TEST_CASE(testDuplicates)
+{
+  // more coincident points than fit in a leaf stop at the maximum depth
+  std::vector<point3d<double> > pts(50, point3d<double>(1., 1., 1.));
+  pts.push_back(point3d<double>(0., 0., 0.));
+  const linear_octree<double> tree(pts.begin(), pts.end(), 4);
+  BOOST_CHECK_EQUAL(tree.levels(), linear_octree<double>::max_depth + 1);
+  BOOST_CHECK(tree.nodes() < 50u);
+}
+
+BOOST_AUTO_TEST_CASE(testLeafLastInLevel)
+{
+  // a leaf after the last split node of a level gets no children
+  std::vector<point3d<double> > pts;
+  for (unsigned int i = 0; i < 50; ++i) pts.push_back(point3d<double>(0.001*i, 0., 0.));
+  pts.push_back(point3d<double>(1., 1., 1.));
+  const linear_octree<double> tree(pts.begin(), pts.end(), 4);
+  BOOST_REQUIRE_EQUAL(tree.node(0).children, 2u);
+  const octree_node<double>& last = tree.node(tree.node(0).child + 1);
+  BOOST_CHECK_EQUAL(last.count, 1u);
+  BOOST_CHECK_EQUAL(last.children, 0u);
+  std::size_t leafPoints = 0;
+  for (std::size_t i = 0; i < tree.nodes(); ++i)
+  {
+    if (tree.node(i).children == 0) leafPoints += tree.node(i).count;
+  }
+  BOOST_CHECK_EQUAL(leafPoints, pts.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestPoint3D4
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+#include "minimath/point3d4.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/translation3d.hpp"
+#include "minimath/transform3d.hpp"
+#include "minimath/aligned_allocator.hpp"
+
+using namespace minimath;
+
+namespace
+{
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+template <typename T>
+T randomScalar()
+{
+  return static_cast<T>(std::rand()%2000 - 1000)/static_cast<T>(16);
+}
+
+template <typename T>
+matrix<T,3,4> randomMatrix()
+{
+  matrix<T,3,4> m;
+  for (unsigned int i = 0; i < m.size(); ++i) m[i] = randomScalar<T>();
+  return m;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestPoint3D4, setup)
+
+BOOST_AUTO_TEST_CASE(testLayout)
+{
+  BOOST_CHECK_EQUAL(sizeof(point4f), 16u);
+  BOOST_CHECK_EQUAL(sizeof(point4d), 32u);
+  BOOST_CHECK_EQUAL(__alignof__(point4f), 16u);
+  BOOST_CHECK_EQUAL(__alignof__(point4d), 32u);
+  BOOST_CHECK(is_point3d<point4f>::value);
+  std::vector<point4d, aligned_allocator<point4d> > v(5);
+  for (unsigned int i = 0; i < v.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(&v[i]) % 32, 0u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBasics)
+{
+  point4f p(1.f, 2.f, 3.f, 7.f);
+  p += point3d<float>(1.f, 1.f, 1.f);
+  BOOST_CHECK(p == point3d<float>(2.f, 3.f, 4.f));
+  BOOST_CHECK_EQUAL(p.w(), 7.f);
+  BOOST_CHECK_EQUAL(mag2(p), 29.f);
+  BOOST_CHECK_EQUAL(dot(p, point4f(1.f, 0.f, 1.f, 100.f)), 6.f);
+  BOOST_CHECK(cross(point4f(1.f, 0.f, 0.f), point4f(0.f, 1.f, 0.f)) == point4f(0.f, 0.f, 1.f));
+  point4f z;
+  BOOST_CHECK_EQUAL(z.normalize(), 0.f);
+  BOOST_CHECK(z == point4f());
+  point4d q(3., 0., 4., 1.);
+  BOOST_CHECK_EQUAL(q.normalize(), 5.);
+  BOOST_CHECK(q == point4d(0.6, 0., 0.8));
+}
+
+BOOST_AUTO_TEST_CASE(testMatrixFloat)
+{
+  for (unsigned int attempt = 0; attempt < 20; ++attempt)
+  {
+    const matrix<float,3,4> m = randomMatrix<float>();
+    const point3d<float> p(randomScalar<float>(), randomScalar<float>(), randomScalar<float>());
+    const point4f p4(p.x(), p.y(), p.z(), 5.f);
+    const point4f r = m*p4;
+    BOOST_CHECK(equal(r, m*p, 4));
+    BOOST_CHECK_EQUAL(r.w(), 5.f);
+
+    matrix<float,3> rot;
+    for (unsigned int i = 0; i < 3; ++i)
+      for (unsigned int j = 0; j < 3; ++j) rot(i,j) = m(i,j);
+    const point4f r3 = rot*p4;
+    BOOST_CHECK(equal(r3, rot*p, 4));
+    BOOST_CHECK_EQUAL(r3.w(), 5.f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testMatrixDouble)
+{
+  const matrix<double,3,4> m = randomMatrix<double>();
+  const point3d<double> p(1.5, -2.25, 0.125);
+  const point4d r = m*point4d(p);
+  BOOST_CHECK(equal(r, m*p, 1));
+  BOOST_CHECK_EQUAL(r.w(), 0.);
+}
+
+BOOST_AUTO_TEST_CASE(testGeometryTypes)
+{
+  const rotation3d<float> rot(rotation3dz<float>(0.5f));
+  const translation3d<float> trans(1.f, -2.f, 3.f);
+  const transform3d<float> t(rot, trans);
+  const point3d<float> p(0.5f, 1.5f, -2.f);
+  const point4f p4(p.x(), p.y(), p.z(), 9.f);
+
+  const point4f pr = rot*p4;
+  BOOST_CHECK(equal(pr, rot*p, 2));
+  BOOST_CHECK_EQUAL(pr.w(), 9.f);
+  const point4f pt = trans*p4;
+  BOOST_CHECK(equal(pt, trans*p, 0));
+  BOOST_CHECK_EQUAL(pt.w(), 9.f);
+  const point4f pT = t*p4;
+  BOOST_CHECK(equal(pT, t*p, 4));
+  BOOST_CHECK_EQUAL(pT.w(), 9.f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestPoint3DBatchOps
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+#include "minimath/point3d_batch_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "minimath/point_view.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+// random points in [-12.5, 12.5), in steps of 1/8
+template <typename T>
+std::vector<point3d<T> > smallPoints(unsigned int n)
+{
+  return randomPoints(n, point3d<T>(-12.5, -12.5, -12.5), point3d<T>(12.5, 12.5, 12.5), 200);
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestPoint3DBatchOps, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testFloatArrays)
+{
+  // all lengths up to a few SIMD blocks, to exercise the scalar tails
+  for (unsigned int n = 0; n < 14; ++n)
+  {
+    std::vector<point3d<float> > a = smallPoints<float>(n + 1);
+    std::vector<point3d<float> > b = smallPoints<float>(n + 1);
+    const point3d<float> q(0.5f, -1.f, 2.f);
+    std::vector<float> out(n + 1, -1.f);
+
+    mag2(&a[0], n, &out[0]);
+    for (unsigned int i = 0; i < n; ++i) BOOST_CHECK_EQUAL(out[i], mag2(a[i]));
+    BOOST_CHECK_EQUAL(out[n], -1.f);
+
+    dot(&a[0], &b[0], n, &out[0]);
+    for (unsigned int i = 0; i < n; ++i) BOOST_CHECK_EQUAL(out[i], dot(a[i], b[i]));
+
+    dist2(&a[0], &b[0], n, &out[0]);
+    for (unsigned int i = 0; i < n; ++i) BOOST_CHECK_EQUAL(out[i], dist2(a[i], b[i]));
+
+    dist2(&a[0], n, q, &out[0]);
+    for (unsigned int i = 0; i < n; ++i) BOOST_CHECK_EQUAL(out[i], dist2(a[i], q));
+    BOOST_CHECK_EQUAL(out[n], -1.f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testDoubleArrays)
+{
+  std::vector<point3d<double> > a = smallPoints<double>(9);
+  const std::vector<point3d<double> > b = smallPoints<double>(9);
+  std::vector<double> out(9);
+  dot(&a[0], &b[0], a.size(), &out[0]);
+  for (unsigned int i = 0; i < a.size(); ++i) BOOST_CHECK_EQUAL(out[i], dot(a[i], b[i]));
+
+  std::vector<point3d<double> > c(9);
+  cross(&a[0], &b[0], a.size(), &c[0]);
+  for (unsigned int i = 0; i < a.size(); ++i) BOOST_CHECK(c[i] == cross(a[i], b[i]));
+
+  const std::vector<point3d<double> > orig = a;
+  a[3] = point3d<double>();
+  normalize(&a[0], a.size(), &out[0]);
+  for (unsigned int i = 0; i < a.size(); ++i)
+  {
+    if (i == 3)
+    {
+      BOOST_CHECK_EQUAL(out[i], 0.);
+      BOOST_CHECK(a[i] == point3d<double>());
+    }
+    else
+    {
+      BOOST_CHECK(equal(out[i], std::sqrt(mag2(orig[i])), 1));
+      BOOST_CHECK(equal(a[i], normalize(orig[i]), 1));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testRanges)
+{
+  const std::vector<point3d<double> > pa = smallPoints<double>(17);
+  const std::vector<point3d<double> > pb = smallPoints<double>(17);
+  const point_cloud<double> a(pa.begin(), pa.end());
+  std::vector<double> xyz;
+  for (unsigned int i = 0; i < pb.size(); ++i)
+  {
+    xyz.push_back(pb[i].x());
+    xyz.push_back(pb[i].y());
+    xyz.push_back(pb[i].z());
+  }
+  const point_span<const double> b(&xyz[0], pb.size());
+  std::vector<double> out(pa.size());
+
+  BOOST_CHECK(mag2(a.begin(), a.end(), out.begin()) == out.end());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], mag2(pa[i]));
+
+  dot(a.begin(), a.end(), b.begin(), out.begin());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dot(pa[i], pb[i]));
+
+  dot(a.begin(), a.end(), pb[0], out.begin());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dot(pa[i], pb[0]));
+
+  dist2(b.begin(), b.end(), a.begin(), out.begin());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dist2(pb[i], pa[i]));
+
+  dist2(pa.begin(), pa.end(), pb[1], out.begin());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dist2(pa[i], pb[1]));
+
+  point_cloud<double> c(pa.size());
+  cross(a.begin(), a.end(), b.begin(), c.begin());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK(c[i] == cross(pa[i], pb[i]));
+
+  normalize(c.begin(), c.end(), out.begin());
+  for (unsigned int i = 0; i < pa.size(); ++i)
+  {
+    BOOST_CHECK(equal(c[i], normalize(cross(pa[i], pb[i])), 1));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
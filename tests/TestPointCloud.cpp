@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestPointCloud
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "minimath/point_cloud.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+typedef point_cloud<double> Cloud;
+
+namespace
+{
+
+// random points with integer coordinates in [-50, 50)
+std::vector<pointxyzd> integerPoints(unsigned int n)
+{
+  return randomPoints(n, pointxyzd(-50, -50, -50), pointxyzd(50, 50, 50), 100);
+}
+
+bool isAligned(const void* p)
+{
+  return reinterpret_cast<std::size_t>(p) % default_alignment == 0;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestPointCloud, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testIsPoint3D)
+{
+  BOOST_CHECK(is_point3d<Cloud::reference>::value);
+  BOOST_CHECK(is_point3d<Cloud::const_reference>::value);
+}
+
+BOOST_AUTO_TEST_CASE(testConstructionAndAccess)
+{
+  const std::vector<pointxyzd> points = integerPoints(37);
+  const Cloud cloud(points.begin(), points.end());
+  BOOST_CHECK_EQUAL(cloud.size(), points.size());
+  BOOST_CHECK(isAligned(cloud.x_data()));
+  BOOST_CHECK(isAligned(cloud.y_data()));
+  BOOST_CHECK(isAligned(cloud.z_data()));
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    BOOST_CHECK(cloud[i] == points[i]);
+    BOOST_CHECK(cloud.x_data()[i] == points[i].x());
+  }
+  BOOST_CHECK(std::equal(cloud.begin(), cloud.end(), points.begin()));
+  BOOST_CHECK_EQUAL(cloud.end() - cloud.begin(), 37);
+}
+
+BOOST_AUTO_TEST_CASE(testReferenceAssignment)
+{
+  Cloud cloud(3);
+  cloud[0] = pointxyzd(1., 2., 3.);
+  cloud[1].x(4.).y(5.).z(6.);
+  // assignment between references copies coordinates
+  Cloud::reference r = cloud[2];
+  r = cloud[0];
+  BOOST_CHECK(cloud[2] == pointxyzd(1., 2., 3.));
+  BOOST_CHECK(cloud[1] == pointxyzd(4., 5., 6.));
+  pointxyzd p = cloud[1];
+  BOOST_CHECK(p == pointxyzd(4., 5., 6.));
+}
+
+BOOST_AUTO_TEST_CASE(testGenericFunctions)
+{
+  const std::vector<pointxyzd> points = integerPoints(10);
+  const Cloud cloud(points.begin(), points.end());
+  for (unsigned int i = 0; i + 1 < points.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(mag2(cloud[i]), mag2(points[i]));
+    BOOST_CHECK_EQUAL(dot(cloud[i], cloud[i+1]), dot(points[i], points[i+1]));
+    BOOST_CHECK_EQUAL(dist2(cloud[i], points[i+1]), dist2(points[i], points[i+1]));
+    BOOST_CHECK(cross(points[i], cloud[i+1]) == cross(points[i], points[i+1]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testIteratorAlgorithms)
+{
+  const std::vector<pointxyzd> points = integerPoints(20);
+  Cloud cloud(points.begin(), points.end());
+  std::reverse(cloud.begin(), cloud.end());
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    BOOST_CHECK(cloud[i] == points[points.size() - 1 - i]);
+  }
+  Cloud::const_iterator it = cloud.begin();
+  it += 5;
+  BOOST_CHECK(*it == points[14]);
+  BOOST_CHECK(it[2] == points[12]);
+  BOOST_CHECK(*(it - 5) == points[19]);
+}
+
+BOOST_AUTO_TEST_CASE(testBulkKernels)
+{
+  const std::vector<pointxyzd> pa = integerPoints(101);
+  const std::vector<pointxyzd> pb = integerPoints(101);
+  const Cloud a(pa.begin(), pa.end());
+  const Cloud b(pb.begin(), pb.end());
+  const pointxyzd q(1., -2., 3.);
+  std::vector<double> out(a.size());
+  Cloud c;
+
+  mag2(a, &out[0]);
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], mag2(pa[i]));
+  dot(a, b, &out[0]);
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dot(pa[i], pb[i]));
+  dot(a, q, &out[0]);
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dot(pa[i], q));
+  dist2(a, b, &out[0]);
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dist2(pa[i], pb[i]));
+  dist2(a, q, &out[0]);
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK_EQUAL(out[i], dist2(pa[i], q));
+  cross(a, b, c);
+  BOOST_CHECK_EQUAL(c.size(), a.size());
+  for (unsigned int i = 0; i < pa.size(); ++i) BOOST_CHECK(c[i] == cross(pa[i], pb[i]));
+}
+
+BOOST_AUTO_TEST_CASE(testBulkNormalize)
+{
+  std::vector<pointxyzd> points = integerPoints(50);
+  points[7] = pointxyzd();
+  Cloud cloud(points.begin(), points.end());
+  std::vector<double> lengths(cloud.size());
+  normalize(cloud, &lengths[0]);
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    BOOST_CHECK(equal(lengths[i], std::sqrt(mag2(points[i])), 1));
+    if (i == 7)
+    {
+      BOOST_CHECK(cloud[i] == pointxyzd());
+    }
+    else
+    {
+      BOOST_CHECK(equal(cloud[i], normalize(points[i]), 1));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
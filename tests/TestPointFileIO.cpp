@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestPointFileIO
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/point_file_io.hpp"
+
+using namespace minimath;
+
+namespace
+{
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+template <typename T>
+std::vector<point3d<T> > randomPoints(unsigned int n)
+{
+  std::vector<point3d<T> > v;
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    v.push_back(point3d<T>(static_cast<T>(std::rand() - RAND_MAX/2)/1024,
+                           static_cast<T>(std::rand())/static_cast<T>(RAND_MAX),
+                           static_cast<T>(std::rand() - RAND_MAX/2)*T(1.e-7)));
+  }
+  return v;
+}
+
+void writeFile(const char* path, const std::string& contents)
+{
+  std::ofstream out(path, std::ios::binary);
+  out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+// big endian bytes of a value
+template <typename U>
+std::string bigEndian(U value)
+{
+  char bytes[sizeof(U)];
+  std::memcpy(bytes, &value, sizeof(U));
+  if (detail::host_is_little_endian()) std::reverse(bytes, bytes + sizeof(U));
+  return std::string(bytes, sizeof(U));
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestPointFileIO, setup)
+
+BOOST_AUTO_TEST_CASE(testPLYRoundTrip)
+{
+  const char* path = "TestPointFileIO.ply";
+  const std::vector<point3d<float> > pts = randomPoints<float>(2500);
+  {
+    ply_writer<float> writer(path);
+    BOOST_CHECK_EQUAL(writer.status(), point_file_ok);
+    const point_cloud<float> cloud(pts.begin() + 1000, pts.end());
+    writer.write(pts.begin(), pts.begin() + 1000);
+    writer.write(cloud.begin(), cloud.end());
+    BOOST_CHECK_EQUAL(writer.size(), pts.size());
+    BOOST_CHECK_EQUAL(writer.close(), point_file_ok);
+  }
+
+  // in chunks that do not divide the file
+  ply_reader reader(path);
+  BOOST_REQUIRE_EQUAL(reader.status(), point_file_ok);
+  BOOST_CHECK_EQUAL(reader.size(), pts.size());
+  std::vector<point3d<float> > chunk(700);
+  std::size_t total = 0;
+  while (!reader.at_end())
+  {
+    const std::size_t n = reader.read(&chunk[0], chunk.size());
+    BOOST_REQUIRE(n > 0);
+    for (std::size_t i = 0; i < n; ++i) BOOST_CHECK(chunk[i] == pts[total + i]);
+    total += n;
+  }
+  BOOST_CHECK_EQUAL(total, pts.size());
+  BOOST_CHECK_EQUAL(reader.read(&chunk[0], chunk.size()), 0u);
+
+  // into a cloud of doubles
+  BOOST_REQUIRE_EQUAL(reader.open(path), point_file_ok);
+  point_cloud<double> cloud;
+  BOOST_CHECK_EQUAL(reader.read(cloud, 10000), pts.size());
+  BOOST_CHECK_EQUAL(cloud.size(), pts.size());
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    BOOST_CHECK(cloud[i] == point3d<double>(pts[i].x(), pts[i].y(), pts[i].z()));
+  }
+  reader.close();
+  std::remove(path);
+  BOOST_CHECK_EQUAL(reader.open(path), point_file_open_failed);
+}
+
+BOOST_AUTO_TEST_CASE(testPLYLayouts)
+{
+  // big endian, a fixed size element before the vertices, mixed property
+  // types and extra properties, and faces after the vertices
+  const char* path = "TestPointFileIO_layout.ply";
+  std::string ply = "ply\r\nformat binary_big_endian 1.0\r\ncomment scanner output\r\n"
+                    "element camera 2\nproperty float fov\nproperty uchar id\n"
+                    "element vertex 3\nproperty double x\nproperty uchar red\n"
+                    "property short z\nproperty float   y\n"
+                    "element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+  for (int c = 0; c < 2; ++c) ply += bigEndian(1.5f) + bigEndian(std::tr1::uint8_t(c));
+  for (int v = 0; v < 3; ++v)
+  {
+    ply += bigEndian(0.25*v) + bigEndian(std::tr1::uint8_t(255)) +
+           bigEndian(std::tr1::int16_t(-7*v)) + bigEndian(float(v) + 0.5f);
+  }
+  ply += bigEndian(std::tr1::uint8_t(3)) + bigEndian(0) + bigEndian(1) + bigEndian(2);
+  writeFile(path, ply);
+
+  ply_reader reader(path);
+  BOOST_REQUIRE_EQUAL(reader.status(), point_file_ok);
+  BOOST_REQUIRE_EQUAL(reader.size(), 3u);
+  point3d<double> out[3];
+  BOOST_CHECK_EQUAL(reader.read(out, 3), 3u);
+  for (int v = 0; v < 3; ++v)
+  {
+    BOOST_CHECK(out[v] == point3d<double>(0.25*v, v + 0.5, -7.*v));
+  }
+  reader.close();
+
+  // errors
+  const std::string header = "ply\nformat binary_little_endian 1.0\nelement vertex 2\n";
+  writeFile(path, "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nend_header\n1\n");
+  BOOST_CHECK_EQUAL(reader.open(path), point_file_unsupported);
+  writeFile(path, header + "property float x\nproperty float y\nend_header\n");
+  BOOST_CHECK_EQUAL(reader.open(path), point_file_unsupported);
+  writeFile(path, "element vertex 1\n");
+  BOOST_CHECK_EQUAL(reader.open(path), point_file_bad_header);
+  writeFile(path, header + "property float x\nproperty float y\nproperty float z");
+  BOOST_CHECK_EQUAL(reader.open(path), point_file_bad_header);
+  writeFile(path, header + "property float x\nproperty float y\nproperty float z\nend_header\n" +
+                  std::string(20, '\0'));
+  BOOST_CHECK_EQUAL(reader.open(path), point_file_truncated);
+  BOOST_CHECK(reader.at_end());
+  std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(testXYZRoundTrip)
+{
+  const char* path = "TestPointFileIO.xyz";
+  const std::vector<point3d<double> > pts = randomPoints<double>(3000);
+  {
+    xyz_writer<double> writer(path);
+    BOOST_CHECK_EQUAL(writer.write(pts.begin(), pts.end()), point_file_ok);
+    BOOST_CHECK_EQUAL(writer.close(), point_file_ok);
+  }
+  xyz_reader reader(path);
+  BOOST_REQUIRE_EQUAL(reader.status(), point_file_ok);
+  std::vector<point3d<double> > chunk(1024);
+  std::size_t total = 0;
+  while (!reader.at_end())
+  {
+    const std::size_t n = reader.read(&chunk[0], chunk.size());
+    for (std::size_t i = 0; i < n; ++i) BOOST_CHECK(chunk[i] == pts[total + i]);
+    total += n;
+  }
+  BOOST_CHECK_EQUAL(reader.status(), point_file_ok);
+  BOOST_CHECK_EQUAL(total, pts.size());
+  BOOST_CHECK_EQUAL(reader.position(), pts.size());
+  std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(testXYZFormat)
+{
+  const char* path = "TestPointFileIO_format.xyz";
+  writeFile(path, "# x y z intensity\r\n1 2 3 0.5\r\n\r\n  -4.5,6e1,.25\n"
+                  "\t7 8 9 255 0 0\n10 11 12");
+  xyz_reader reader(path);
+  point_cloud<float> cloud;
+  BOOST_CHECK_EQUAL(reader.read(cloud, 2), 2u);
+  BOOST_REQUIRE_EQUAL(cloud.size(), 2u);
+  BOOST_CHECK(cloud[0] == point3d<float>(1.f, 2.f, 3.f));
+  BOOST_CHECK(cloud[1] == point3d<float>(-4.5f, 60.f, 0.25f));
+  BOOST_CHECK_EQUAL(reader.read(cloud, 10), 2u);
+  BOOST_CHECK(cloud[0] == point3d<float>(7.f, 8.f, 9.f));
+  BOOST_CHECK(cloud[1] == point3d<float>(10.f, 11.f, 12.f));
+  BOOST_CHECK(reader.at_end());
+  BOOST_CHECK_EQUAL(reader.status(), point_file_ok);
+
+  writeFile(path, "1 2 3\n4 5\n6 7 8\n");
+  BOOST_REQUIRE_EQUAL(reader.open(path), point_file_ok);
+  point3d<double> out[4];
+  BOOST_CHECK_EQUAL(reader.read(out, 4), 1u);
+  BOOST_CHECK_EQUAL(reader.status(), point_file_parse_error);
+  BOOST_CHECK_EQUAL(reader.line(), 2u);
+  BOOST_CHECK_EQUAL(reader.read(out, 4), 0u);
+  std::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
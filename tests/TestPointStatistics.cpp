@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestPointStatistics
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+#include "minimath/point_statistics.hpp"
+#include "minimath/point_cloud.hpp"
+#include "minimath/point_view.hpp"
+#include "TestPointUtils.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+// random points far from the origin, with a different spread per axis
+template <typename T>
+std::vector<point3d<T> > offsetPoints(unsigned int n)
+{
+  return randomPoints(n, point3d<T>(100, -5, 0), point3d<T>(225, 57.5, 31.25), 2000);
+}
+
+// straightforward serial computation, in double
+void reference(const std::vector<point3d<float> >& pts, point3d<double>& c, matrix<double,3>& cov)
+{
+  c = point3d<double>();
+  for (unsigned int i = 0; i < pts.size(); ++i) c += point3d<double>(pts[i].x(), pts[i].y(), pts[i].z());
+  c /= double(pts.size());
+  cov = matrix<double,3>();
+  for (unsigned int i = 0; i < pts.size(); ++i)
+  {
+    const double d[3] = { pts[i].x() - c.x(), pts[i].y() - c.y(), pts[i].z() - c.z() };
+    for (unsigned int r = 0; r < 3; ++r)
+      for (unsigned int k = 0; k < 3; ++k) cov(r,k) += d[r]*d[k]/double(pts.size());
+  }
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestPointStatistics, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testEmptyAndSingle)
+{
+  const std::vector<point3d<double> > none;
+  BOOST_CHECK(centroid(none.begin(), none.end()) == point3d<double>());
+  BOOST_CHECK(covariance(none.begin(), none.end()) == (matrix<double,3>()));
+
+  const point3d<double> p(1., 2., 3.);
+  BOOST_CHECK(centroid(&p, &p + 1) == p);
+  BOOST_CHECK(covariance(&p, &p + 1) == (matrix<double,3>()));
+}
+
+BOOST_AUTO_TEST_CASE(testSmall)
+{
+  std::vector<point3d<double> > pts;
+  pts.push_back(point3d<double>(1., 0., 0.));
+  pts.push_back(point3d<double>(-1., 0., 0.));
+  pts.push_back(point3d<double>(0., 2., 0.));
+  pts.push_back(point3d<double>(0., -2., 0.));
+  BOOST_CHECK(centroid(pts.begin(), pts.end()) == point3d<double>());
+  const matrix<double,3> cov = covariance(pts.begin(), pts.end());
+  BOOST_CHECK_EQUAL(cov(0,0), 0.5);
+  BOOST_CHECK_EQUAL(cov(1,1), 2.);
+  BOOST_CHECK_EQUAL(cov(2,2), 0.);
+  BOOST_CHECK_EQUAL(cov(0,1), 0.);
+  const matrix<double,3> s = scatter(pts.begin(), pts.end(), point3d<double>(1., 0., 0.));
+  BOOST_CHECK_EQUAL(s(0,0), 6.);
+  BOOST_CHECK_EQUAL(s(0,1), 0.);
+}
+
+BOOST_AUTO_TEST_CASE(testAgainstSerial)
+{
+  const unsigned int sizes[] = { 7, 512, 513, 5000, 20011 };
+  for (unsigned int i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i)
+  {
+    const std::vector<point3d<float> > pts = offsetPoints<float>(sizes[i]);
+    point3d<double> c;
+    matrix<double,3> cov;
+    reference(pts, c, cov);
+    const point3d<float> cf = centroid(pts.begin(), pts.end());
+    const matrix<float,3> covf = covariance(pts.begin(), pts.end());
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      BOOST_CHECK_CLOSE(double(cf[k]), c[k], 1.e-4);
+    }
+    for (unsigned int k = 0; k < 9; ++k)
+    {
+      BOOST_CHECK_SMALL(double(covf[k]) - cov[k], 1.e-3);
+    }
+    BOOST_CHECK(covf == covf.transpose());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testRangeTypes)
+{
+  const std::vector<point3d<double> > pts = offsetPoints<double>(1500);
+  const point_cloud<double> cloud(pts.begin(), pts.end());
+  std::vector<double> xyz;
+  for (unsigned int i = 0; i < pts.size(); ++i)
+  {
+    xyz.push_back(pts[i].x());
+    xyz.push_back(pts[i].y());
+    xyz.push_back(pts[i].z());
+  }
+  const point_span<const double> span(&xyz[0], pts.size());
+
+  const point3d<double> c = centroid(pts.begin(), pts.end());
+  BOOST_CHECK(centroid(cloud.begin(), cloud.end()) == c);
+  BOOST_CHECK(centroid(span.begin(), span.end()) == c);
+  const matrix<double,3> cov = covariance(&pts[0], &pts[0] + pts.size());
+  BOOST_CHECK(covariance(cloud.begin(), cloud.end()) == cov);
+  BOOST_CHECK(covariance(span.begin(), span.end(), c) == cov);
+}
+
+#ifdef _OPENMP
+BOOST_AUTO_TEST_CASE(testThreadCountIndependence)
+{
+  const std::vector<point3d<float> > pts = offsetPoints<float>(100003);
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  const point3d<float> c1 = centroid(pts.begin(), pts.end());
+  const matrix<float,3> cov1 = covariance(pts.begin(), pts.end());
+  for (int t = 2; t <= 8; ++t)
+  {
+    omp_set_num_threads(t);
+    const point3d<float> c = centroid(pts.begin(), pts.end());
+    const matrix<float,3> cov = covariance(pts.begin(), pts.end());
+    for (unsigned int k = 0; k < 3; ++k) BOOST_CHECK_EQUAL(c[k], c1[k]);
+    for (unsigned int k = 0; k < 9; ++k) BOOST_CHECK_EQUAL(cov[k], cov1[k]);
+  }
+  omp_set_num_threads(maxThreads);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
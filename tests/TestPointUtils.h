@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#ifndef TESTS_TESTPOINTUTILS_H_
+#define TESTS_TESTPOINTUTILS_H_
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "minimath/point3d.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/kd_tree.hpp"
+
+namespace TestUtils
+{
+
+using namespace minimath;
+
+// fixture seeding std::rand, so that every test case sees the same points
+struct seeded_rand
+{
+  seeded_rand() { std::srand(42); }
+};
+
+// generate a random point on a grid of steps positions per axis in [lo, hi)
+template <typename T>
+point3d<T> randomPoint(const point3d<T>& lo, const point3d<T>& hi, unsigned int steps)
+{
+  const T x = lo.x() + (hi.x() - lo.x())*static_cast<T>(std::rand()%steps)/static_cast<T>(steps);
+  const T y = lo.y() + (hi.y() - lo.y())*static_cast<T>(std::rand()%steps)/static_cast<T>(steps);
+  const T z = lo.z() + (hi.z() - lo.z())*static_cast<T>(std::rand()%steps)/static_cast<T>(steps);
+  return point3d<T>(x, y, z);
+}
+
+// generate n random points on a grid of steps positions per axis in [lo, hi)
+template <typename T>
+std::vector<point3d<T> > randomPoints(unsigned int n,
+                                      const point3d<T>& lo,
+                                      const point3d<T>& hi,
+                                      unsigned int steps = 2000)
+{
+  std::vector<point3d<T> > v;
+  for (unsigned int i = 0; i < n; ++i) v.push_back(randomPoint(lo, hi, steps));
+  return v;
+}
+
+// generate a random point in the cube [-15.625, 15.625), in steps of 1/64
+template <typename T>
+point3d<T> randomPoint()
+{
+  const T h = static_cast<T>(1000)/64;
+  return randomPoint(point3d<T>(-h, -h, -h), point3d<T>(h, h, h), 2000);
+}
+
+// generate n random points in the cube [-15.625, 15.625), in steps of 1/64
+template <typename T>
+std::vector<point3d<T> > randomPoints(unsigned int n)
+{
+  std::vector<point3d<T> > v;
+  for (unsigned int i = 0; i < n; ++i) v.push_back(randomPoint<T>());
+  return v;
+}
+
+// all points sorted by distance to q, by brute force
+template <typename T>
+std::vector<kd_neighbour<T> > bruteForceNearest(const std::vector<point3d<T> >& pts,
+                                                const point3d<T>& q)
+{
+  std::vector<kd_neighbour<T> > all;
+  for (std::size_t i = 0; i < pts.size(); ++i) all.push_back(kd_neighbour<T>(i, dist2(pts[i], q)));
+  std::sort(all.begin(), all.end());
+  return all;
+}
+
+// indices of the points within r of q, by brute force
+template <typename T>
+std::vector<std::size_t> bruteForceRadius(const std::vector<point3d<T> >& pts,
+                                          const point3d<T>& q,
+                                          T r)
+{
+  std::vector<std::size_t> found;
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    if (dist2(pts[i], q) <= r*r) found.push_back(i);
+  }
+  return found;
+}
+
+} // namespace TestUtils
+
+#endif
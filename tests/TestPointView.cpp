@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestPointView
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+#include "minimath/point_view.hpp"
+#include "minimath/point3d.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/translation3d.hpp"
+#include "minimath/transform3d.hpp"
+
+using namespace minimath;
+
+namespace
+{
+
+// sensor style records: x y z intensity
+std::vector<float> makeRecords(unsigned int n)
+{
+  std::vector<float> buffer;
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    const float f = static_cast<float>(i);
+    buffer.push_back(f);
+    buffer.push_back(2.f*f);
+    buffer.push_back(-f);
+    buffer.push_back(100.f + f);
+  }
+  return buffer;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(TestPointView)
+
+BOOST_AUTO_TEST_CASE(testInterleaved)
+{
+  std::vector<float> buffer = makeRecords(10);
+  const strided_point_view<float> view = interleaved_points(&buffer[0], 10, 4);
+  BOOST_CHECK_EQUAL(view.size(), 10u);
+  BOOST_CHECK_EQUAL(view.end() - view.begin(), 10);
+  BOOST_CHECK(is_point3d<strided_point_view<float>::reference>::value);
+  BOOST_CHECK(view[3] == point3d<float>(3.f, 6.f, -3.f));
+  view[3] = point3d<float>(0.f, 0.f, 1.f);
+  BOOST_CHECK_EQUAL(buffer[14], 1.f);
+  BOOST_CHECK_EQUAL(buffer[15], 103.f);
+}
+
+BOOST_AUTO_TEST_CASE(testPlanarAndSpan)
+{
+  std::vector<double> x(5, 1.), y(5, 2.), z(5, 3.);
+  const strided_point_view<const double> planar = planar_points<const double>(&x[0], &y[0], &z[0], 5);
+  for (unsigned int i = 0; i < planar.size(); ++i)
+  {
+    BOOST_CHECK(planar[i] == point3d<double>(1., 2., 3.));
+  }
+
+  std::vector<double> xyz;
+  for (unsigned int i = 0; i < 12; ++i) xyz.push_back(i);
+  const point_span<double> span(&xyz[0], 4);
+  BOOST_CHECK(span[2] == point3d<double>(6., 7., 8.));
+  std::reverse(span.begin(), span.end());
+  BOOST_CHECK_EQUAL(xyz[0], 9.);
+  BOOST_CHECK_EQUAL(xyz[11], 2.);
+
+  // read-only view of a mutable one
+  const strided_point_view<const double> cspan = span;
+  BOOST_CHECK(cspan[0] == point3d<double>(9., 10., 11.));
+}
+
+BOOST_AUTO_TEST_CASE(testTransformInPlace)
+{
+  std::vector<float> buffer = makeRecords(25);
+  const std::vector<float> original = buffer;
+  const rotation3d<float> rot(rotation3dx<float>(0.25f));
+  const transform3d<float> t(rot, translation3d<float>(1.f, 2.f, 3.f));
+  transform(t, interleaved_points(&buffer[0], 25, 4));
+  for (unsigned int i = 0; i < 25; ++i)
+  {
+    const point3d<float> p(original[4*i], original[4*i+1], original[4*i+2]);
+    const point3d<float> q(buffer[4*i], buffer[4*i+1], buffer[4*i+2]);
+    BOOST_CHECK(equal(q, t*p, 16));
+    BOOST_CHECK_EQUAL(buffer[4*i+3], original[4*i+3]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testGenericTransformInPlace)
+{
+  std::vector<double> x(7), y(7), z(7);
+  for (unsigned int i = 0; i < 7; ++i)
+  {
+    x[i] = i;
+    y[i] = 1.;
+    z[i] = -1.*i;
+  }
+  const strided_point_view<double> view = planar_points(&x[0], &y[0], &z[0], 7);
+  transform(translation3d<double>(1., 1., 1.), view);
+  BOOST_CHECK(view[4] == point3d<double>(5., 2., -3.));
+  const rotation3d<double> rot(rotation3dz<double>(0.5));
+  transform(rot, view);
+  BOOST_CHECK(equal(view[4], rot*point3d<double>(5., 2., -3.), 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,212 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestQuantisedPointCloud
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <tr1/cstdint>
+#include "minimath/quantised_point_cloud.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/geom3d_ops.hpp"
+
+using namespace minimath;
+
+typedef quantised_point_cloud<std::tr1::int16_t, 64> Quantised16;
+typedef quantised_point_cloud<std::tr1::int32_t> Quantised32;
+
+namespace
+{
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+// a scan: points on a far off surface, with sub-millimetre noise
+std::vector<point3d<double> > scanPoints(unsigned int n)
+{
+  std::vector<point3d<double> > v;
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    const double u = double(i)/10.;
+    v.push_back(point3d<double>(5000. + u + (std::rand()%1000)*1.e-6,
+                                -300. + std::sin(u) + (std::rand()%1000)*1.e-6,
+                                20. + (std::rand()%1000)*1.e-3));
+  }
+  return v;
+}
+
+// largest per axis difference
+template <typename P, typename Q>
+double maxError(const P& a, const Q& b)
+{
+  double e = 0.;
+  e = std::max(e, std::abs(double(a.x()) - double(b.x())));
+  e = std::max(e, std::abs(double(a.y()) - double(b.y())));
+  return std::max(e, std::abs(double(a.z()) - double(b.z())));
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestQuantisedPointCloud, setup)
+
+BOOST_AUTO_TEST_CASE(testEmpty)
+{
+  const std::vector<point3d<double> > none;
+  const Quantised16 q(none.begin(), none.end());
+  BOOST_CHECK(q.empty());
+  BOOST_CHECK_EQUAL(q.block_count(), 0u);
+  point_cloud<float> out;
+  decode(q, out);
+  BOOST_CHECK(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testRoundTrip)
+{
+  const std::vector<point3d<double> > pts = scanPoints(1000);
+  const Quantised16 q16(pts.begin(), pts.end());
+  const Quantised32 q32(pts.begin(), pts.end());
+  BOOST_CHECK_EQUAL(q16.size(), pts.size());
+  BOOST_CHECK_EQUAL(q16.block_count(), 16u);
+  BOOST_CHECK_EQUAL(q16.block_size(15), 1000u - 15*64);
+  BOOST_CHECK_EQUAL(q32.block_count(), 1u);
+  double e16 = 0., e32 = 0.;
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    const double err = maxError(q16[i], pts[i]);
+    BOOST_CHECK(err <= q16.block(i/64).scale/2*1.0001);
+    e16 = std::max(e16, err);
+    e32 = std::max(e32, maxError(q32[i], pts[i]));
+  }
+  BOOST_CHECK(e16 < 1.e-3);
+  BOOST_CHECK(e32 < 1.e-6);
+
+  // a coarser resolution is used as the step
+  const Quantised16 coarse(pts.begin(), pts.end(), 0.01);
+  BOOST_CHECK_EQUAL(coarse.block(0).scale, 0.01);
+  for (std::size_t i = 0; i < pts.size(); ++i) BOOST_CHECK(maxError(coarse[i], pts[i]) <= 0.005*1.0001);
+
+  // coincident points
+  const std::vector<point3d<double> > same(10, point3d<double>(1., 2., 3.));
+  const Quantised16 single(same.begin(), same.end());
+  BOOST_CHECK(single[9] == same[9]);
+}
+
+BOOST_AUTO_TEST_CASE(testStoredData)
+{
+  const std::vector<point3d<double> > pts = scanPoints(300);
+  const Quantised16 q(pts.begin(), pts.end());
+
+  // serialised as the integer arrays followed by the block records
+  const std::size_t n = q.size(), nBlocks = q.block_count();
+  std::vector<char> bytes(3*n*sizeof(std::tr1::int16_t) + nBlocks*sizeof(quantised_block));
+  char* p = &bytes[0];
+  const std::tr1::int16_t* arrays[3] = { q.x_data(), q.y_data(), q.z_data() };
+  for (unsigned int d = 0; d < 3; ++d, p += n*sizeof(std::tr1::int16_t))
+  {
+    std::memcpy(p, arrays[d], n*sizeof(std::tr1::int16_t));
+  }
+  std::memcpy(p, q.block_data(), nBlocks*sizeof(quantised_block));
+
+  std::vector<std::tr1::int16_t> x(n), y(n), z(n);
+  std::vector<quantised_block> blocks(nBlocks);
+  std::memcpy(&x[0], &bytes[0], n*sizeof(std::tr1::int16_t));
+  std::memcpy(&y[0], &bytes[n*sizeof(std::tr1::int16_t)], n*sizeof(std::tr1::int16_t));
+  std::memcpy(&z[0], &bytes[2*n*sizeof(std::tr1::int16_t)], n*sizeof(std::tr1::int16_t));
+  std::memcpy(&blocks[0], &bytes[3*n*sizeof(std::tr1::int16_t)], nBlocks*sizeof(quantised_block));
+
+  bool success = false;
+  const Quantised16 loaded(&x[0], &y[0], &z[0], n, &blocks[0], nBlocks, success);
+  BOOST_REQUIRE(success);
+  BOOST_REQUIRE_EQUAL(loaded.size(), n);
+  BOOST_CHECK_EQUAL(loaded.block_count(), nBlocks);
+  for (std::size_t i = 0; i < n; ++i) BOOST_CHECK(loaded[i] == q[i]);
+  point_cloud<double> decoded;
+  decode(loaded, decoded);
+  for (std::size_t i = 0; i < n; ++i) BOOST_CHECK(maxError(decoded[i], pts[i]) < 1.e-3);
+
+  // inconsistent sizes and bad scales are rejected
+  Quantised16 bad(pts.begin(), pts.end());
+  BOOST_CHECK(!bad.assign(&x[0], &y[0], &z[0], n, &blocks[0], nBlocks - 1));
+  BOOST_CHECK(bad.empty());
+  BOOST_CHECK(!bad.assign(&x[0], &y[0], &z[0], n - 64, &blocks[0], nBlocks));
+  blocks[2].scale = 0.;
+  BOOST_CHECK(!bad.assign(&x[0], &y[0], &z[0], n, &blocks[0], nBlocks));
+  BOOST_CHECK(bad.assign(0, 0, 0, 0, 0, 0));
+  BOOST_CHECK(bad.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testDecode)
+{
+  const std::vector<point3d<double> > pts = scanPoints(203);
+  const Quantised16 q(pts.begin(), pts.end());
+
+  std::vector<point3d<double> > d(pts.size());
+  decode(q, &d[0]);
+  for (std::size_t i = 0; i < pts.size(); ++i) BOOST_CHECK(maxError(d[i], q[i]) < 1.e-9);
+
+  // float, array and structure of arrays, over a range across blocks
+  std::vector<point3d<float> > f(pts.size());
+  point_cloud<float> soa;
+  decode(q, 50, 101, &f[0]);
+  decode(q, soa);
+  BOOST_REQUIRE_EQUAL(soa.size(), pts.size());
+  for (std::size_t i = 0; i < 101; ++i) BOOST_CHECK(maxError(f[i], q[50 + i]) < 1.e-3);
+  for (std::size_t i = 0; i < pts.size(); ++i) BOOST_CHECK(maxError(soa[i], q[i]) < 1.e-3);
+  BOOST_CHECK(f[101] == point3d<float>());
+}
+
+BOOST_AUTO_TEST_CASE(testTransform)
+{
+  const std::vector<point3d<double> > pts = scanPoints(333);
+  const Quantised32 q(pts.begin(), pts.end());
+  const rotation3d<double> rot(rotation3dz<double>(0.3));
+  const transform3d<double> t(rot, translation3d<double>(-5000., 300., 5.));
+
+  std::vector<point3d<double> > out(pts.size());
+  point_cloud<double> soa;
+  transform(t, q, &out[0]);
+  transform(t, q, soa);
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    BOOST_CHECK(maxError(out[i], t*q[i]) < 1.e-9);
+    BOOST_CHECK(maxError(soa[i], t*q[i]) < 1.e-9);
+  }
+
+  // float kernels: offsets are folded in double, so results near the
+  // origin keep float precision although the input is far from it
+  const transform3d<double> back(rot, translation3d<double>());
+  const point3d<double> c = back*point3d<double>(5000., -300., 20.);
+  const point3d<float> cf(float(c.x()), float(c.y()), float(c.z()));
+  const transform3d<float> tf(rotation3d<float>(rotation3dz<float>(0.3f)),
+                              translation3d<float>(-cf.x(), -cf.y(), -cf.z()));
+  std::vector<point3d<float> > outf(pts.size());
+  point_cloud<float> soaf;
+  transform(tf, q, &outf[0]);
+  transform(tf, q, soaf);
+  // the float transform, read back once in double
+  const matrix<float,3,4> mf = to_matrix(tf);
+  matrix<double,3,4> md;
+  for (unsigned int k = 0; k < md.size(); ++k) md[k] = static_cast<double>(mf[k]);
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    point3d<double> expected;
+    for (unsigned int r = 0; r < 3; ++r)
+    {
+      expected[r] = md(r,0)*q[i].x() + md(r,1)*q[i].y() + md(r,2)*q[i].z() + md(r,3);
+    }
+    BOOST_CHECK(maxError(outf[i], expected) < 1.e-4);
+    BOOST_CHECK(maxError(soaf[i], expected) < 1.e-4);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
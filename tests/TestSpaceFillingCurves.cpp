@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestSpaceFillingCurves
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "minimath/space_filling_curves.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+using std::tr1::uint32_t;
+using std::tr1::uint64_t;
+
+namespace
+{
+
+uint32_t randomBits(unsigned int bits)
+{
+  return static_cast<uint32_t>(std::rand()) & ((uint32_t(1) << bits) - 1);
+}
+
+uint32_t absDiff(uint32_t a, uint32_t b) { return a < b ? b - a : a - b; }
+
+// sum of the distances between consecutive points
+template <typename T>
+double pathLength(const std::vector<point3d<T> >& pts)
+{
+  double len = 0.;
+  for (std::size_t i = 1; i < pts.size(); ++i) len += std::sqrt(double(dist2(pts[i - 1], pts[i])));
+  return len;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestSpaceFillingCurves, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testMorton)
+{
+  BOOST_CHECK_EQUAL(morton_encode30(1, 0, 0), 1u);
+  BOOST_CHECK_EQUAL(morton_encode30(0, 1, 0), 2u);
+  BOOST_CHECK_EQUAL(morton_encode30(0, 0, 1), 4u);
+  BOOST_CHECK_EQUAL(morton_encode30(3, 0, 0), 9u);
+  BOOST_CHECK_EQUAL(morton_encode30(0x3ff, 0x3ff, 0x3ff), 0x3fffffffu);
+  BOOST_CHECK(morton_encode63(1, 0, 0) == 1u);
+  BOOST_CHECK(morton_encode63(0, 0, 1) == 4u);
+  BOOST_CHECK(morton_encode63(0x1fffff, 0x1fffff, 0x1fffff) == (uint64_t(1) << 63) - 1);
+  for (unsigned int attempt = 0; attempt < 100; ++attempt)
+  {
+    const uint32_t x = randomBits(21), y = randomBits(21), z = randomBits(21);
+    uint32_t dx, dy, dz;
+    morton_decode63(morton_encode63(x, y, z), dx, dy, dz);
+    BOOST_CHECK_EQUAL(dx, x);
+    BOOST_CHECK_EQUAL(dy, y);
+    BOOST_CHECK_EQUAL(dz, z);
+    morton_decode30(morton_encode30(x & 0x3ff, y & 0x3ff, z & 0x3ff), dx, dy, dz);
+    BOOST_CHECK_EQUAL(dx, x & 0x3ff);
+    BOOST_CHECK_EQUAL(dy, y & 0x3ff);
+    BOOST_CHECK_EQUAL(dz, z & 0x3ff);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testHilbert)
+{
+  BOOST_CHECK_EQUAL(hilbert_encode30(0, 0, 0), 0u);
+  // a bijection on a small grid
+  std::vector<uint32_t> keys;
+  for (uint32_t x = 0; x < 8; ++x)
+    for (uint32_t y = 0; y < 8; ++y)
+      for (uint32_t z = 0; z < 8; ++z) keys.push_back(hilbert_encode30(x << 7, y << 7, z << 7) >> 21);
+  std::sort(keys.begin(), keys.end());
+  for (uint32_t i = 0; i < keys.size(); ++i) BOOST_CHECK_EQUAL(keys[i], i);
+
+  for (unsigned int attempt = 0; attempt < 200; ++attempt)
+  {
+    const uint32_t x = randomBits(21), y = randomBits(21), z = randomBits(21);
+    uint32_t dx, dy, dz;
+    hilbert_decode63(hilbert_encode63(x, y, z), dx, dy, dz);
+    BOOST_CHECK_EQUAL(dx, x);
+    BOOST_CHECK_EQUAL(dy, y);
+    BOOST_CHECK_EQUAL(dz, z);
+
+    // consecutive keys are face neighbours
+    const uint32_t key = randomBits(30) & ~uint32_t(1);
+    uint32_t x0, y0, z0, x1, y1, z1;
+    hilbert_decode30(key, x0, y0, z0);
+    hilbert_decode30(key + 1, x1, y1, z1);
+    BOOST_CHECK_EQUAL(hilbert_encode30(x0, y0, z0), key);
+    BOOST_CHECK_EQUAL(absDiff(x0, x1) + absDiff(y0, y1) + absDiff(z0, z1), 1u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testRadixSort)
+{
+  const std::size_t sizes[] = { 0, 1, 7, 1000, 100000 };
+  for (unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s)
+  {
+    const std::size_t n = sizes[s];
+    std::vector<uint64_t> keys(n);
+    std::vector<uint32_t> small(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      keys[i] = uint64_t(randomBits(30)) << 20 | randomBits(4);
+      small[i] = randomBits(8);
+    }
+    std::vector<std::size_t> perm(n + 1);
+    radix_sort_permutation(n ? &keys[0] : 0, n, &perm[0]);
+    for (std::size_t i = 1; i < n; ++i) BOOST_CHECK(keys[perm[i - 1]] <= keys[perm[i]]);
+
+    // stable, on keys with many ties
+    radix_sort_permutation(n ? &small[0] : 0, n, &perm[0]);
+    for (std::size_t i = 1; i < n; ++i)
+    {
+      BOOST_CHECK(small[perm[i - 1]] < small[perm[i]] ||
+                  (small[perm[i - 1]] == small[perm[i]] && perm[i - 1] < perm[i]));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testKeysOfPoints)
+{
+  const std::vector<point3d<double> > pts = randomPoints<double>(100);
+  const point3d<double> lo(-16., -16., -16.), hi(16., 16., 16.);
+  std::vector<uint32_t> k30(pts.size());
+  std::vector<uint64_t> k63(pts.size());
+  morton_keys(pts.begin(), pts.end(), lo, hi, &k30[0]);
+  morton_keys(pts.begin(), pts.end(), lo, hi, &k63[0]);
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    uint32_t x, y, z;
+    morton_decode30(k30[i], x, y, z);
+    BOOST_CHECK_EQUAL(x, static_cast<uint32_t>((pts[i].x() + 16.)*32.));
+    BOOST_CHECK_EQUAL(z, static_cast<uint32_t>((pts[i].z() + 16.)*32.));
+    morton_decode63(k63[i], x, y, z);
+    BOOST_CHECK_EQUAL(y >> 11, static_cast<uint32_t>((pts[i].y() + 16.)*32.));
+  }
+  hilbert_keys(pts.begin(), pts.end(), lo, hi, &k30[0]);
+  hilbert_keys(pts.begin(), pts.end(), lo, hi, &k63[0]);
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    BOOST_CHECK(k63[i] >> 33 == k30[i]);
+  }
+
+  // clamping to the box
+  const point3d<double> outside[2] = { point3d<double>(-100., 0., 0.), point3d<double>(100., 0., 0.) };
+  morton_keys(outside, outside + 2, lo, hi, &k30[0]);
+  uint32_t x, y, z;
+  morton_decode30(k30[0], x, y, z);
+  BOOST_CHECK_EQUAL(x, 0u);
+  morton_decode30(k30[1], x, y, z);
+  BOOST_CHECK_EQUAL(x, 0x3ffu);
+}
+
+BOOST_AUTO_TEST_CASE(testSortWithAttributes)
+{
+  const std::vector<point3d<float> > original = randomPoints<float>(5000);
+  std::vector<int> attribute(original.size());
+  for (std::size_t i = 0; i < attribute.size(); ++i) attribute[i] = static_cast<int>(i);
+
+  std::vector<point3d<float> > pts = original;
+  std::vector<std::size_t> perm(pts.size());
+  morton_sort(&pts[0], pts.size(), &perm[0]);
+  reorder(&perm[0], attribute.size(), &attribute[0]);
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    BOOST_CHECK(pts[i] == original[perm[i]]);
+    BOOST_CHECK_EQUAL(attribute[i], static_cast<int>(perm[i]));
+  }
+  BOOST_CHECK(pathLength(pts) < pathLength(original)/5);
+
+  std::vector<point3d<float> > hpts = original;
+  hilbert_sort(&hpts[0], hpts.size());
+  BOOST_CHECK(pathLength(hpts) < pathLength(pts));
+
+  point_cloud<float> cloud(original.begin(), original.end());
+  std::vector<std::size_t> cperm(cloud.size());
+  hilbert_sort(cloud, &cperm[0]);
+  for (std::size_t i = 0; i < cloud.size(); ++i) BOOST_CHECK(cloud[i] == hpts[i]);
+  morton_sort(cloud);
+  for (std::size_t i = 0; i < cloud.size(); ++i) BOOST_CHECK(cloud[i] == pts[i]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
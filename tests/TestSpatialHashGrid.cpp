@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestSpatialHashGrid
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "minimath/spatial_hash_grid.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+template <typename T>
+std::vector<std::size_t> indices(const std::vector<kd_neighbour<T> >& neighbours)
+{
+  std::vector<std::size_t> found;
+  for (std::size_t i = 0; i < neighbours.size(); ++i) found.push_back(neighbours[i].index);
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestSpatialHashGrid, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testEmpty)
+{
+  const spatial_hash_grid<double> grid;
+  BOOST_CHECK(grid.empty());
+  std::vector<kd_neighbour<double> > out;
+  BOOST_CHECK_EQUAL(grid.radius(point3d<double>(), 1., out), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testBadInput)
+{
+  std::vector<point3d<double> > pts(3, point3d<double>(1., 2., 3.));
+  spatial_hash_grid<double> grid(pts.begin(), pts.end(), 1.);
+  BOOST_CHECK_EQUAL(grid.size(), 3u);
+  BOOST_CHECK(!grid.build(pts.begin(), pts.end(), 0.));
+  BOOST_CHECK(grid.empty());
+  BOOST_CHECK(!grid.build(pts.begin(), pts.end(), -1.));
+  BOOST_CHECK(grid.empty());
+
+  // cells far beyond the range of long are clamped, not converted
+  pts.push_back(point3d<double>(1.e300, -1.e300, 0.));
+  BOOST_CHECK(grid.build(pts.begin(), pts.end(), 1.e-10));
+  std::vector<kd_neighbour<double> > out;
+  BOOST_CHECK_EQUAL(grid.radius(point3d<double>(1., 2., 3.), 1., out), 3u);
+  BOOST_CHECK_EQUAL(grid.radius(point3d<double>(1.e300, -1.e300, 0.), 1., out), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(testRadius)
+{
+  const std::vector<point3d<float> > pts = randomPoints<float>(5000);
+  const point_cloud<float> cloud(pts.begin(), pts.end());
+  const spatial_hash_grid<float> grid(cloud.begin(), cloud.end(), 1.5f);
+  BOOST_CHECK_EQUAL(grid.size(), pts.size());
+  BOOST_CHECK_EQUAL(grid.buckets(), 8192u);
+  const std::vector<point3d<float> > queries = randomPoints<float>(20);
+  // radius at, below and well above the cell size, and far outside the cloud
+  const float radii[] = { 1.5f, 0.7f, 4.f, 40.f };
+  for (unsigned int r = 0; r < 4; ++r)
+  {
+    for (unsigned int q = 0; q < queries.size(); ++q)
+    {
+      std::vector<kd_neighbour<float> > out;
+      const std::size_t n = grid.radius(queries[q], radii[r], out);
+      BOOST_CHECK_EQUAL(n, out.size());
+      BOOST_CHECK(indices(out) == bruteForceRadius(pts, queries[q], radii[r]));
+      for (std::size_t i = 0; i < out.size(); ++i)
+      {
+        BOOST_CHECK_EQUAL(out[i].dist2, dist2(pts[out[i].index], queries[q]));
+      }
+    }
+  }
+  std::vector<kd_neighbour<float> > out;
+  BOOST_CHECK_EQUAL(grid.radius(point3d<float>(1000.f, 0.f, 0.f), 2.f, out), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testBatch)
+{
+  const std::vector<point3d<double> > pts = randomPoints<double>(3000);
+  const spatial_hash_grid<double> grid(pts.begin(), pts.end(), 2.);
+  const std::vector<point3d<double> > queries = randomPoints<double>(50);
+  std::vector<std::vector<kd_neighbour<double> > > out;
+  grid.radius(queries.begin(), queries.end(), 2., out);
+  BOOST_REQUIRE_EQUAL(out.size(), queries.size());
+  for (std::size_t q = 0; q < queries.size(); ++q)
+  {
+    BOOST_CHECK(indices(out[q]) == bruteForceRadius(pts, queries[q], 2.));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
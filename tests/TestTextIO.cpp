@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestTextIO
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "minimath/text_io.hpp"
+
+using namespace minimath;
+
+typedef matrix<double,3,4> M3x4;
+typedef matrix<float,2,2> M2x2f;
+
+namespace
+{
+
+struct setup
+{
+    setup() { std::srand(42); }
+};
+
+double randomDouble()
+{
+  const double mantissa = std::rand()/(RAND_MAX + 1.) - 0.5;
+  return std::ldexp(mantissa, std::rand()%200 - 100);
+}
+
+std::string toString(const char* first, const char* last)
+{
+  return std::string(first, last);
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestTextIO, setup)
+
+BOOST_AUTO_TEST_CASE(testFormatPoint)
+{
+  char buf[128];
+  char* end = to_chars(buf, buf + sizeof(buf), point3d<double>(1., -2.5, 0.));
+  BOOST_REQUIRE(end);
+  BOOST_CHECK_EQUAL(toString(buf, end), "1 -2.5 0");
+  end = to_chars(buf, buf + sizeof(buf), point3d<float>(0.1f, 3.f, -4.f), ',');
+  BOOST_REQUIRE(end);
+  BOOST_CHECK_EQUAL(toString(buf, end), "0.100000001,3,-4");
+}
+
+BOOST_AUTO_TEST_CASE(testFormatMatrix)
+{
+  M2x2f m;
+  m(0,0) = 1.f; m(0,1) = 2.f; m(1,0) = 3.f; m(1,1) = 4.5f;
+  char buf[64];
+  char* end = to_chars(buf, buf + sizeof(buf), m, ';');
+  BOOST_REQUIRE(end);
+  BOOST_CHECK_EQUAL(toString(buf, end), "1;2;3;4.5");
+}
+
+BOOST_AUTO_TEST_CASE(testBufferTooSmall)
+{
+  char buf[8];
+  BOOST_CHECK(to_chars(buf, buf + sizeof(buf), point3d<double>(1., 2., 3.)) != 0);
+  BOOST_CHECK(to_chars(buf, buf + 4, point3d<double>(1., 2., 3.)) == 0);
+  BOOST_CHECK(to_chars(buf, buf + 5, point3d<double>(1., 2., 3.)) != 0);
+  BOOST_CHECK(to_chars(buf, buf + sizeof(buf), point3d<double>(0.1, 2., 3.)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testParsePoint)
+{
+  const std::string text = "  1.5, -2e3;\t4 trailing";
+  point3d<double> p;
+  const char* end = from_chars(text.data(), text.data() + text.size(), p);
+  BOOST_REQUIRE(end);
+  BOOST_CHECK_EQUAL(end - text.data(), 14);
+  BOOST_CHECK(p == point3d<double>(1.5, -2000., 4.));
+}
+
+BOOST_AUTO_TEST_CASE(testParseErrors)
+{
+  point3d<double> p(7., 8., 9.);
+  const std::string tooShort = "1 2";
+  BOOST_CHECK(from_chars(tooShort.data(), tooShort.data() + tooShort.size(), p) == 0);
+  const std::string bad = "1 x 3";
+  BOOST_CHECK(from_chars(bad.data(), bad.data() + bad.size(), p) == 0);
+  // unchanged on error
+  BOOST_CHECK(p == point3d<double>(7., 8., 9.));
+  // a token is consumed whole or not at all
+  const std::string longToken = "1.00000000000000000000000000000000001 2 3";
+  BOOST_CHECK(from_chars(longToken.data(), longToken.data() + longToken.size(), p) == 0);
+  const std::string suffix = "1.5x 2 3";
+  BOOST_CHECK(from_chars(suffix.data(), suffix.data() + suffix.size(), p) == 0);
+  const std::string nan = "nan 2 3";
+  BOOST_CHECK(from_chars(nan.data(), nan.data() + nan.size(), p) != 0);
+  // the parser does not read past last
+  const std::string cut = "1 2 345";
+  BOOST_REQUIRE(from_chars(cut.data(), cut.data() + 5, p));
+  BOOST_CHECK(p == point3d<double>(1., 2., 3.));
+}
+
+BOOST_AUTO_TEST_CASE(testDoubleRoundTrip)
+{
+  char buf[1024];
+  for (unsigned int attempt = 0; attempt < 200; ++attempt)
+  {
+    M3x4 m;
+    for (unsigned int i = 0; i < m.size(); ++i) m[i] = randomDouble();
+    char* end = to_chars(buf, buf + sizeof(buf), m, ',');
+    BOOST_REQUIRE(end);
+    M3x4 m2;
+    BOOST_CHECK(from_chars(buf, end, m2) == end);
+    BOOST_CHECK(m == m2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testFloatRoundTrip)
+{
+  char buf[64];
+  for (unsigned int attempt = 0; attempt < 10000; ++attempt)
+  {
+    const float f = static_cast<float>(randomDouble());
+    const point3d<float> p(f, -f*3.f, 1.f/f);
+    char* end = to_chars(buf, buf + sizeof(buf), p);
+    BOOST_REQUIRE(end);
+    point3d<float> p2;
+    BOOST_CHECK(from_chars(buf, end, p2) == end);
+    if (!(p == p2))
+    {
+      BOOST_ERROR("float round trip failed for " << toString(buf, end));
+      break;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testShortDecimals)
+{
+  // values as written by scanners, parsed the same as by strtod
+  const char* formats[] = { "%.3f", "%.6f", "%.9f", "%.6e", "%.15g", "%.0f" };
+  char buf[64];
+  for (unsigned int attempt = 0; attempt < 6000; ++attempt)
+  {
+    const double v = (std::rand()/(RAND_MAX + 1.) - 0.5)*std::pow(10., std::rand()%12 - 4);
+    const int n = std::sprintf(buf, formats[attempt%6], v);
+    double parsed = 0.;
+    BOOST_CHECK(detail::parse_scalar(buf, buf + n, parsed) == buf + n);
+    if (parsed != std::strtod(buf, 0))
+    {
+      BOOST_ERROR("short decimal parsed differently from strtod: " << buf);
+      break;
+    }
+  }
+  const std::string text = "-0 +12 .5 7. 1e22 123456789012345678901 1e-300";
+  double values[7];
+  BOOST_REQUIRE(detail::parse_scalars(text.data(), text.data() + text.size(), values, 7u));
+  BOOST_CHECK(values[0] == 0. && 1./values[0] < 0.);
+  BOOST_CHECK_EQUAL(values[1], 12.);
+  BOOST_CHECK_EQUAL(values[2], 0.5);
+  BOOST_CHECK_EQUAL(values[3], 7.);
+  BOOST_CHECK_EQUAL(values[4], 1e22);
+  BOOST_CHECK_EQUAL(values[5], 123456789012345678901.);
+  BOOST_CHECK_EQUAL(values[6], 1e-300);
+}
+
+BOOST_AUTO_TEST_CASE(testTransformRoundTrip)
+{
+  M3x4 m;
+  for (unsigned int i = 0; i < m.size(); ++i) m[i] = randomDouble();
+  const transform3d<double> t(m);
+  char buf[512];
+  char* end = to_chars(buf, buf + sizeof(buf), t);
+  BOOST_REQUIRE(end);
+  transform3d<double> t2;
+  BOOST_CHECK(from_chars(buf, end, t2) == end);
+  const point3d<double> p(1.25, -3., 0.5);
+  BOOST_CHECK(t*p == t2*p);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
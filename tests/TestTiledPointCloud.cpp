@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestTiledPointCloud
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+#include "minimath/tiled_point_cloud.hpp"
+#include "minimath/rotation3d.hpp"
+#include "minimath/transform3d.hpp"
+#include "minimath/geom3d_ops.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+typedef tiled_point_cloud<float, 8> Tiles8;
+typedef tiled_point_cloud<double, 16, 2> Tiles16;
+
+namespace
+{
+
+// random points with integer coordinates in [-50, 50)
+template <typename T>
+std::vector<point3d<T> > integerPoints(unsigned int n)
+{
+  return randomPoints(n, point3d<T>(-50, -50, -50), point3d<T>(50, 50, 50), 100);
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestTiledPointCloud, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testLayout)
+{
+  BOOST_CHECK_EQUAL(sizeof(Tiles8::tile_type), 3*8*sizeof(float));
+  BOOST_CHECK_EQUAL(sizeof(Tiles16::tile_type), 5*16*sizeof(double));
+  const std::vector<point3d<float> > points = integerPoints<float>(21);
+  const Tiles8 tiles(points.begin(), points.end());
+  BOOST_CHECK_EQUAL(tiles.size(), 21u);
+  BOOST_CHECK_EQUAL(tiles.tile_count(), 3u);
+  BOOST_CHECK_EQUAL(tiles.lanes(0), 8u);
+  BOOST_CHECK_EQUAL(tiles.lanes(2), 5u);
+  BOOST_CHECK_EQUAL(tiles.tiles()[1].y[3], points[11].y());
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(tiles.tiles()) % default_alignment, 0u);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(tiles.tiles()[1].x) % 32, 0u);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(tiles.tiles()[2].z) % 32, 0u);
+  for (unsigned int i = 0; i < points.size(); ++i) BOOST_CHECK(tiles[i] == points[i]);
+}
+
+BOOST_AUTO_TEST_CASE(testAttributes)
+{
+  const std::vector<point3d<double> > points = integerPoints<double>(20);
+  Tiles16 tiles(points.begin(), points.end());
+  for (unsigned int i = 0; i < tiles.size(); ++i)
+  {
+    tiles.attribute(i, 0) = i;
+    tiles.attribute(i, 1) = -1.*i;
+  }
+  BOOST_CHECK_EQUAL(tiles.tiles()[1].attr[1][2], -18.);
+  BOOST_CHECK_EQUAL(tiles.attribute(17, 0), 17.);
+  BOOST_CHECK(tiles[17] == points[17]);
+}
+
+BOOST_AUTO_TEST_CASE(testResize)
+{
+  const std::vector<point3d<float> > points = integerPoints<float>(12);
+  Tiles8 tiles(points.begin(), points.end());
+  tiles.resize(10);
+  BOOST_CHECK_EQUAL(tiles.tile_count(), 2u);
+  tiles.resize(12);
+  BOOST_CHECK(tiles[11] == point3d<float>());
+  BOOST_CHECK(tiles[9] == points[9]);
+}
+
+BOOST_AUTO_TEST_CASE(testTransform)
+{
+  const std::vector<point3d<double> > points = integerPoints<double>(37);
+  Tiles16 tiles(points.begin(), points.end());
+  const rotation3d<double> rot(rotation3dz<double>(0.3));
+  const transform3d<double> t(rot, translation3d<double>(1., -2., 5.));
+  transform(t, tiles);
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    BOOST_CHECK(equal(tiles[i], t*points[i], 8));
+  }
+  // padding lanes stay zero
+  BOOST_CHECK(tiles[40] == point3d<double>());
+}
+
+BOOST_AUTO_TEST_CASE(testDist2)
+{
+  const std::vector<point3d<float> > points = integerPoints<float>(29);
+  const Tiles8 tiles(points.begin(), points.end());
+  const point3d<float> q(1.f, 2.f, 3.f);
+  std::vector<float> out(tiles.size());
+  dist2(tiles, q, &out[0]);
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(out[i], dist2(points[i], q));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testReductions)
+{
+  const std::vector<point3d<double> > points = integerPoints<double>(45);
+  const Tiles8 empty;
+  point3d<float> lo, hi;
+  BOOST_CHECK(!bounding_box(empty, lo, hi));
+
+  tiled_point_cloud<double, 8> tiles(points.begin(), points.end());
+  point3d<double> s;
+  point3d<double> pmin = points[0], pmax = points[0];
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    s += points[i];
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      if (points[i][k] < pmin[k]) pmin[k] = points[i][k];
+      if (points[i][k] > pmax[k]) pmax[k] = points[i][k];
+    }
+  }
+  BOOST_CHECK(sum(tiles) == s);
+  BOOST_CHECK(equal(centroid(tiles), s/45., 4));
+  point3d<double> bmin, bmax;
+  BOOST_CHECK(bounding_box(tiles, bmin, bmax));
+  BOOST_CHECK(bmin == pmin);
+  BOOST_CHECK(bmax == pmax);
+}
+
+BOOST_AUTO_TEST_CASE(testCopyPoints)
+{
+  const std::vector<point3d<float> > points = integerPoints<float>(19);
+  const Tiles8 tiles(points.begin(), points.end());
+  std::vector<point3d<float> > out(points.size());
+  BOOST_CHECK(copy_points(tiles, out.begin()) == out.end());
+  BOOST_CHECK(std::equal(out.begin(), out.end(), points.begin()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
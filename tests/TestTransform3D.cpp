@@ -412,4 +412,14 @@ BOOST_AUTO_TEST_CASE(testInvert)
   BOOST_CHECK(TestUtils::testInvertTransform3D<rotation3dz<double> >());
 }
 
+BOOST_AUTO_TEST_CASE(testToMatrix)
+{
+  const rotation3d<double> rot(rotation3dz<double>(PI/3));
+  const transform3d<double> transf(rot, translation3d<double>(111., 222., 333.));
+  const matrix<double,3,4> m = to_matrix(transf);
+  BOOST_CHECK(transform3d<double>(m)*p010 == transf*p010);
+  BOOST_CHECK_EQUAL(m(1,0), rot(1,0));
+  BOOST_CHECK_EQUAL(m(2,3), 333.);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2012 Juan Palacios juan.palacios.puyana@gmail.com
+// This file is part of minimathlibs.
+// Subject to the BSD 2-Clause License
+// - see < http://opensource.org/licenses/BSD-2-Clause>
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TestVoxelGridFilter
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <vector>
+#include "minimath/voxel_grid_filter.hpp"
+#include "minimath/point3d_ops.hpp"
+#include "minimath/point_cloud.hpp"
+#include "TestPointUtils.h"
+
+using namespace minimath;
+using namespace TestUtils;
+
+namespace
+{
+
+// random points above the z = 0 plane, in steps of 1/64
+template <typename T>
+std::vector<point3d<T> > groundPoints(unsigned int n)
+{
+  return randomPoints(n, point3d<T>(-15.625, -15.625, 0), point3d<T>(15.625, 15.625, 15.625), 2000);
+}
+
+struct voxel_stats
+{
+  voxel_stats() : first(0), count(0) {}
+  point3d<double> sum;
+  std::size_t first;
+  std::size_t count;
+};
+
+typedef std::map<std::vector<long>, voxel_stats> voxel_map;
+
+// the std::map filter this replaces
+template <typename T>
+voxel_map mapFilter(const std::vector<point3d<T> >& pts, T leaf)
+{
+  point3d<T> lo = pts[0];
+  for (std::size_t i = 1; i < pts.size(); ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d) lo[d] = std::min(lo[d], pts[i][d]);
+  }
+  voxel_map voxels;
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    std::vector<long> cell(3);
+    for (unsigned int d = 0; d < 3; ++d) cell[d] = static_cast<long>((pts[i][d] - lo[d])/leaf);
+    voxel_stats& v = voxels[cell];
+    if (v.count++ == 0) v.first = i;
+    v.sum += point3d<double>(pts[i].x(), pts[i].y(), pts[i].z());
+  }
+  return voxels;
+}
+
+std::map<std::size_t, voxel_stats> firstPoints(const voxel_map& voxels)
+{
+  std::map<std::size_t, voxel_stats> byFirst;
+  for (voxel_map::const_iterator v = voxels.begin(); v != voxels.end(); ++v) byFirst[v->second.first] = v->second;
+  return byFirst;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE(TestVoxelGridFilter, seeded_rand)
+
+BOOST_AUTO_TEST_CASE(testEmpty)
+{
+  const std::vector<point3d<double> > none;
+  std::vector<point3d<double> > out;
+  BOOST_CHECK_EQUAL(voxel_grid_centroids(none.begin(), none.end(), 1., std::back_inserter(out)), 0u);
+  BOOST_CHECK(out.empty());
+
+  // coincident points make a single voxel
+  const std::vector<point3d<double> > same(10, point3d<double>(1., 2., 3.));
+  BOOST_CHECK_EQUAL(voxel_grid_centroids(same.begin(), same.end(), 1., std::back_inserter(out)), 1u);
+  BOOST_CHECK(out[0] == same[0]);
+}
+
+BOOST_AUTO_TEST_CASE(testInvalidGrid)
+{
+  std::vector<point3d<double> > pts = groundPoints<double>(100);
+  std::vector<point3d<double> > out;
+  BOOST_CHECK_EQUAL(voxel_grid_check(pts.begin(), pts.end(), 1.), voxel_grid_ok);
+  BOOST_CHECK_EQUAL(voxel_grid_check(pts.begin(), pts.end(), 0.), voxel_grid_bad_leaf);
+  BOOST_CHECK_EQUAL(voxel_grid_check(pts.begin(), pts.end(), -1.), voxel_grid_bad_leaf);
+  BOOST_CHECK_EQUAL(voxel_grid_centroids(pts.begin(), pts.end(), 0., std::back_inserter(out)), 0u);
+
+  // 2^21 voxels of 1 along y do not fit, one less does
+  pts.resize(2);
+  pts[0] = point3d<double>(0., 0., 0.);
+  pts[1] = point3d<double>(0., 2097152., 0.);
+  BOOST_CHECK_EQUAL(voxel_grid_check(pts.begin(), pts.end(), 1.), voxel_grid_too_large);
+  BOOST_CHECK_EQUAL(voxel_grid_first(pts.begin(), pts.end(), 1., std::back_inserter(out)), 0u);
+  BOOST_CHECK(out.empty());
+  pts[1] = point3d<double>(0., 2097151.5, 0.);
+  BOOST_CHECK_EQUAL(voxel_grid_check(pts.begin(), pts.end(), 1.), voxel_grid_ok);
+  BOOST_CHECK_EQUAL(voxel_grid_first(pts.begin(), pts.end(), 1., std::back_inserter(out)), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(testAgainstMap)
+{
+  const std::vector<point3d<double> > pts = groundPoints<double>(20000);
+  const voxel_map voxels = mapFilter(pts, 1.);
+
+  // small blocks force several batches
+  const std::size_t blocks[] = { std::size_t(1) << 22, 1000, 1 };
+  for (unsigned int b = 0; b < 3; ++b)
+  {
+    std::vector<point3d<double> > centroids, firsts;
+    std::vector<std::size_t> indices;
+    BOOST_CHECK_EQUAL(voxel_grid_centroids(pts.begin(), pts.end(), 1., std::back_inserter(centroids), blocks[b]),
+                      voxels.size());
+    BOOST_CHECK_EQUAL(voxel_grid_first(pts.begin(), pts.end(), 1., std::back_inserter(firsts), blocks[b]),
+                      voxels.size());
+    voxel_grid_first_indices(pts.begin(), pts.end(), 1., std::back_inserter(indices), blocks[b]);
+    BOOST_REQUIRE_EQUAL(centroids.size(), voxels.size());
+    BOOST_REQUIRE_EQUAL(indices.size(), voxels.size());
+
+    // one representative per voxel, through the first point of the voxel
+    const std::map<std::size_t, voxel_stats> byFirst = firstPoints(voxels);
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+      BOOST_CHECK(firsts[i] == pts[indices[i]]);
+      const std::map<std::size_t, voxel_stats>::const_iterator v = byFirst.find(indices[i]);
+      BOOST_REQUIRE(v != byFirst.end());
+      point3d<double> c = v->second.sum;
+      c /= static_cast<double>(v->second.count);
+      BOOST_CHECK(std::sqrt(dist2(c, centroids[i])) < 1.e-9);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testCloudAndPrecision)
+{
+  // a far off cloud: centroids are summed relative to the voxel
+  std::vector<point3d<float> > pts = groundPoints<float>(5000);
+  for (std::size_t i = 0; i < pts.size(); ++i) pts[i] += point3d<float>(1.e5f, -1.e5f, 0.f);
+  const point_cloud<float> cloud(pts.begin(), pts.end());
+  const voxel_map voxels = mapFilter(pts, 2.f);
+
+  std::vector<point3d<float> > fromVector, fromCloud;
+  const std::size_t n = voxel_grid_centroids(pts.begin(), pts.end(), 2.f, std::back_inserter(fromVector));
+  voxel_grid_centroids(cloud.begin(), cloud.end(), 2.f, std::back_inserter(fromCloud), 500);
+  BOOST_CHECK_EQUAL(n, voxels.size());
+  BOOST_REQUIRE_EQUAL(fromCloud.size(), fromVector.size());
+  for (std::size_t i = 0; i < n; ++i) BOOST_CHECK(fromCloud[i] == fromVector[i]);
+
+  std::vector<std::size_t> indices;
+  voxel_grid_first_indices(pts.begin(), pts.end(), 2.f, std::back_inserter(indices));
+  const std::map<std::size_t, voxel_stats> byFirst = firstPoints(voxels);
+  double worst = 0.;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const voxel_stats& v = byFirst.find(indices[i])->second;
+    point3d<double> c = v.sum;
+    c /= static_cast<double>(v.count);
+    const point3d<float>& f = fromVector[i];
+    worst = std::max(worst, std::sqrt(dist2(c, point3d<double>(f.x(), f.y(), f.z()))));
+  }
+  BOOST_CHECK(worst < 0.02);
+}
+
+BOOST_AUTO_TEST_SUITE_END()